@@ -10,6 +10,7 @@ INCLUDES AND VARIABLE DEFINITIONS
 #include "AEEModGen.h"          // Module interface definitions
 #include "AEEAppGen.h"          // Applet interface definitions
 #include "AEEShell.h"           // Shell interface definitions
+#include "AEEStdLib.h"          // MEMSET etc.
 
 #include "AEEFile.h"			// File interface definitions
 #include "AEEMenu.h"		// Menu Services
@@ -18,6 +19,42 @@ INCLUDES AND VARIABLE DEFINITIONS
 #include "Hamlet.bid"
 #include "Hamlet.brh"
 
+#include "HamletRes.h"
+#include "HamletText.h"
+#include "HamletCache.h"
+#include "HamletCompositor.h"
+#include "HamletMenu.h"
+#include "HamletTiming.h"
+#include "HamletState.h"
+
+/*-------------------------------------------------------------------
+Screen layout. Every position is given on the LAYOUT_CX x LAYOUT_CY
+handset the story was drawn for. Hamlet_InitLayout scales them, the
+props in gStory included, by the one factor that fits that screen
+into the real one, so the pictures keep their shape. A wider screen
+gets the layout centred; the text box and menu take whatever is left
+below the scene.
+-------------------------------------------------------------------*/
+#define LAYOUT_CX	128
+#define LAYOUT_CY	146
+
+enum
+{
+	SPOT_BACK,
+	SPOT_WALL,
+	SPOT_HAMLET,
+	SPOT_GERTRUDE,
+	SPOT_TEXTBOX,
+	SPOT_MENU,
+	SPOT_INSTRUCTION0,	//one line each, INSTRUCTION0 to INSTRUCTION4
+	SPOTS = SPOT_INSTRUCTION0 + 5,
+};
+
+typedef struct _HamletSpot {
+	int16	x;
+	int16	y;
+} HamletSpot;
+
 /*-------------------------------------------------------------------
 Applet structure. All variables in here are reference via "pHam->"
 -------------------------------------------------------------------*/
@@ -39,17 +76,39 @@ typedef struct _Hamlet {
 	IImage* pImageDead;
 	IImage* pImageBastard;
 	IImage* pImageSword;
+	HamletResIndex res;				// hamlet.pak, mapped once and indexed by resource ID
+	HamletTextTable text;			// every string on screen, ready to draw
+	HamletGlyphCache glyphs;		// the fonts as glyph atlases and the text laid out in them, for the text box and instructions
+	HamletImageCache imageCache;	// every IMG_* is decoded once, the pointers above are references into it
+	HamletCompositor compositor;	// scene layers, only changed areas get repainted
+	HamletTiming timing;			// frame deadlines from the start of each chain, and how late they fired
 
 	//scene control
 	int nLevel;
 	int nBranch;
 	int nAnimTemp;
+	int nFrame;		// index into gStory of the frame on screen
+	int nPrefetch;	// branch the menu highlights, its pictures are decoded first
+	int nLoaded;	// gPreloadImages decoded so far
+	boolean bLoaded;	// all of them, and the set pieces and characters taken out of the cache
+	boolean bReplay;	// level 7 goes back to REPLAY_LEVEL instead of ending the story
+	uint16 wBack;	// IMG_* of the set pieces picked with the 1-6 keys
+	uint16 wWall;
+	uint16 wPendingBack;	// picked since the last scenery tick, 0 for no change
+	uint16 wPendingWall;
+	uint16 wText;	// string in the text box, 0 while there is none
+	HamletSnapshot snap;	// taken on EVT_APP_SUSPEND, used up by EVT_APP_RESUME
+	boolean bSaved;	// HAMLET_STATE_FILE holds snap
+	boolean bSuspended;	// EVT_APP_SUSPEND came after the last EVT_APP_RESUME, snap is what to put back
+
+	//layout
+	int nScaleNum;		// screen over LAYOUT_CX x LAYOUT_CY, 1/1 on that handset
+	int nScaleDen;
+	int xLayout;		// left edge of the scaled layout
+	HamletSpot spots[SPOTS];	// gLayout on this screen
 
 	//menu
-	IMenuCtl	* pIMenu;
-	IStatic		* pIStatic;
-	
-	AECHAR szTextBuf[256];
+	HamletMenu	menu;	// the kill choice, rows rendered once
 } Hamlet;
 
 /*-------------------------------------------------------------------
@@ -61,24 +120,42 @@ static  boolean Hamlet_HandleEvent(Hamlet* pHam,
 boolean Hamlet_InitAppData(Hamlet* pHam);
 void    Hamlet_FreeAppData(Hamlet* pHam);
 
+void Hamlet_InitLayout(Hamlet* pHam);
+int Hamlet_LayoutX(Hamlet* pHam, int x);	//from the LAYOUT_CX x LAYOUT_CY handset to this screen
+int Hamlet_LayoutY(Hamlet* pHam, int y);
+int Hamlet_LayoutSize(Hamlet* pHam, int n);	//a width or height, rather than a position
+
 void Hamlet_Timer(Hamlet* pHam);
-void Hamlet_ShowLogo(Hamlet* pHam);
+void Hamlet_NextFrame(Hamlet* pHam);
+void Hamlet_ShowFrame(Hamlet* pHam);
+void Hamlet_ShowLogo(Hamlet* pHam, uint16 wImage, int x, int y);
 void Hamlet_ShowInstructions(Hamlet* pHam);
-void Hamlet_BuildLevel3(Hamlet* pHam);
-void Hamlet_BuildLevel4(Hamlet* pHam);
-void Hamlet_BuildLevel5(Hamlet* pHam);
-void Hamlet_BuildLevel5Frame2(Hamlet* pHam);
-void Hamlet_BuildLevel5Frame3(Hamlet* pHam);
-void Hamlet_BuildLevel6(Hamlet* pHam);
-void Hamlet_BuildLevel6Frame2(Hamlet* pHam);
-void Hamlet_BuildLevel6Frame3(Hamlet* pHam);
-void Hamlet_BuildLevel7(Hamlet* pHam);
-
-void Hamlet_BuildStatic(Hamlet* pHam);
-void EndlinizeString(AECHAR*);	//replace ^ with \n
+void Hamlet_ShowScene(Hamlet* pHam, int nLayer, uint16 wHide, uint16 wImage, int x, int y, boolean bCover);
+void Hamlet_StageScene(Hamlet* pHam, int nLayer, uint16 wHide, uint16 wImage, int x, int y, boolean bCover);
+IImage** Hamlet_PropSlot(Hamlet* pHam, int nLayer);
+int Hamlet_Branch(Hamlet* pHam);	//pHam->nBranch as an index into a frame's prop[] and wText[]
+void Hamlet_PrefetchBranch(Hamlet* pHam);
+void Hamlet_PrefetchMenu(Hamlet* pHam, int nBranch);	//while the menu waits, nBranch being the one highlighted
+void Hamlet_PrefetchTick(Hamlet* pHam);
+void Hamlet_StartLoading(Hamlet* pHam);	//the preloads go on in the background, one per LOAD_TICK
+void Hamlet_LoadTick(Hamlet* pHam);
+void Hamlet_FinishLoading(Hamlet* pHam);	//whatever is left of them, now
+
+void Hamlet_Suspend(Hamlet* pHam);
+void Hamlet_Resume(Hamlet* pHam, HamletSnapshot* pSnap, boolean bRestart);
+boolean Hamlet_CheckSnapshot(const HamletSnapshot* pSnap);	//FALSE for one this story could not have saved
+int Hamlet_LevelAfter(int nFrame);	//pHam->nLevel while gStory[nFrame] is up
+boolean Hamlet_IsOneOf(uint16 wID, const uint16* pwIDs, int nCount);
+void Hamlet_RestoreScene(Hamlet* pHam);
+void Hamlet_RedrawFrame(Hamlet* pHam);
+
+void Hamlet_BuildStatic(Hamlet* pHam, uint16 wTextID);
 void Hamlet_BuildMenu(Hamlet* pHam);
-void Hamlet_DrawScenery(Hamlet* pHam);	//draws the background and the wall
-void Hamlet_DrawCharacters(Hamlet* pHam);	//draws Hamlet and Gertrude
+void Hamlet_SetScenery(Hamlet* pHam, uint16 wBack, uint16 wWall);	//0 keeps the one there is
+void Hamlet_SceneryTick(Hamlet* pHam);
+void Hamlet_TakePendingScenery(Hamlet* pHam);
+void Hamlet_DrawScenery(Hamlet* pHam);	//places the background and the wall
+void Hamlet_DrawCharacters(Hamlet* pHam);	//places Hamlet and Gertrude
 
 enum 
 {
@@ -87,12 +164,178 @@ enum
 	MENUID_SPLINTER,
 };
 
+//wParam TRUE makes the story loop, for soak runs that watch memory over many passes
+#define EVT_HAMLET_REPLAY	(EVT_USER + 1)
+#define REPLAY_LEVEL		3	//the scene before the menu
+
+//compositor layers, bottom to top
+enum
+{
+	LAYER_BACK,
+	LAYER_WALL,
+	LAYER_HAMLET,
+	LAYER_GERTRUDE,
+	LAYER_SPRITES,		//everything below here only changes with the 1-6 keys
+	LAYER_SWORD = LAYER_SPRITES,
+	LAYER_DEAD,
+	LAYER_BASTARD,
+};
+
+#define LAYER_MASK(n)	(1 << (n))
+#define PROP_LAYERS		(LAYER_MASK(LAYER_SWORD) | LAYER_MASK(LAYER_DEAD) | LAYER_MASK(LAYER_BASTARD))
+
+#define SCENE_HEIGHT 85		//the scene sits above the text box and menu, in layout coordinates
+
 #define LEVEL1_DELAY 2000
 #define LEVEL2_DELAY 3000
 #define LEVEL3_DELAY 10000
+#define LEVEL5_FRAME_DELAY 500
 #define LEVEL5_DELAY 2000
+#define LEVEL6_FRAME2_DELAY 200
+#define LEVEL6_FRAME3_DELAY 300
 #define LEVEL6_DELAY 4000
 #define LEVEL7_DELAY 5000
+#define SCENERY_TICK 50		//1-6 key presses are put on screen at most this often
+
+//while the menu is up one picture of the branches it offers is decoded per tick, the highlighted
+//branch's first; the other branches only while that leaves the reserve free for the rest of the story
+#define PREFETCH_TICK 50
+#define PREFETCH_RAM_RESERVE (256 * 1024)
+
+//only the logo is decoded before the first frame; the scene's pictures follow a tick apart while
+//the logo and the instructions hold the screen, 13 x 100 ms being well inside LEVEL1_DELAY
+#define LOAD_TICK 100
+
+/*-------------------------------------------------------------------
+The story, one entry per frame. Hamlet_Timer starts a level at its
+first frame and each frame's delay chains into the next one, so a
+new scene is a new row here rather than a new function.
+-------------------------------------------------------------------*/
+enum
+{
+	FRAME_LOGO,				//splash picture straight to the screen
+	FRAME_INSTRUCTIONS,		//which keys change the set pieces
+	FRAME_SCENE,			//set pieces, characters and this frame's prop
+	FRAME_MENU,				//the scene plus the kill-choice menu, waits for EVT_COMMAND
+};
+
+#define PROP_COVER	0x0001	//opaque picture that replaces the whole scene
+
+typedef struct _HamletProp {
+	uint16	wImage;		//IMG_*, 0 for none
+	int16	x;
+	int16	y;
+	uint16	wFlags;		//PROP_*
+} HamletProp;
+
+typedef struct _HamletFrame {
+	uint8		nLevel;		//pHam->nLevel while this frame is up
+	uint8		nKind;		//FRAME_*
+	uint8		bClear;		//start from a blank screen
+	uint8		nLayer;		//compositor layer the prop goes on
+	uint16		wHide;		//LAYER_MASK()s of props taken off the scene first
+	uint16		wDelay;		//ms until the next frame, 0 waits for the menu
+	HamletProp	prop[3];	//indexed by nBranch
+	uint16		wText[3];	//text box string per branch, 0 leaves the box alone
+} HamletFrame;
+
+#define PROP_NONE			{ {0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0} }
+#define PROP_ALL(i, x, y)	{ {i, x, y, 0}, {i, x, y, 0}, {i, x, y, 0} }
+#define TEXT_NONE			{ 0, 0, 0 }
+#define TEXT_ALL(t)			{ t, t, t }
+
+static const HamletFrame gStory[] =
+{
+	{ 1, FRAME_LOGO,			TRUE,	0,				0,							LEVEL1_DELAY,
+		PROP_ALL(IMG_LOGO, 1, 50),
+		TEXT_NONE },
+	{ 2, FRAME_INSTRUCTIONS,	TRUE,	0,				0,							LEVEL2_DELAY,
+		PROP_NONE,
+		TEXT_NONE },
+	{ 3, FRAME_SCENE,			TRUE,	0,				PROP_LAYERS,				LEVEL3_DELAY,
+		PROP_NONE,
+		TEXT_ALL(TEXT_LEVEL3) },
+	{ 4, FRAME_MENU,			TRUE,	0,				0,							0,
+		PROP_NONE,
+		TEXT_NONE },
+
+	//Hamlet stabs
+	{ 5, FRAME_SCENE,			TRUE,	LAYER_SWORD,	0,							LEVEL5_FRAME_DELAY,
+		PROP_ALL(IMG_SWORD1, 5, 52),
+		TEXT_ALL(TEXT_LEVEL5) },
+	{ 5, FRAME_SCENE,			FALSE,	LAYER_SWORD,	0,							LEVEL5_FRAME_DELAY,
+		PROP_ALL(IMG_SWORD2, 5, 52),
+		TEXT_NONE },
+	{ 5, FRAME_SCENE,			FALSE,	LAYER_SWORD,	0,							LEVEL5_DELAY,
+		PROP_ALL(IMG_SWORD3, 5, 52),
+		TEXT_NONE },
+
+	//the rat is revealed
+	{ 6, FRAME_SCENE,			TRUE,	LAYER_DEAD,		0,							LEVEL6_FRAME2_DELAY,
+		{ {IMG_POLONIUS1, 0, 37, 0}, {IMG_KENNY1, 0, 37, 0}, {IMG_SPLINTER1, 0, 37, 0} },
+		{ TEXT_LEVEL6_POLONIUS, TEXT_LEVEL6_KENNY, TEXT_LEVEL6_SPLINTER } },
+	{ 6, FRAME_SCENE,			FALSE,	LAYER_DEAD,		0,							LEVEL6_FRAME3_DELAY,
+		{ {IMG_POLONIUS2, 0, 37, 0}, {IMG_KENNY2, 0, 37, 0}, {IMG_SPLINTER2, 0, 37, 0} },
+		TEXT_NONE },
+	{ 6, FRAME_SCENE,			FALSE,	LAYER_DEAD,		0,							LEVEL6_DELAY,
+		{ {IMG_POLONIUS3, 0, 37, 0}, {IMG_KENNY3, 0, 37, 0}, {IMG_SPLINTER3, 0, 37, 0} },
+		TEXT_NONE },
+
+	//conclusion
+	{ 7, FRAME_SCENE,			TRUE,	LAYER_BASTARD,	LAYER_MASK(LAYER_SWORD),	LEVEL7_DELAY,
+		{ {IMG_TEARDROPS, 69, 38, 0}, {IMG_STANKYLE, 0, 0, PROP_COVER}, {IMG_TURTLES, 0, 0, PROP_COVER} },
+		{ TEXT_LEVEL7_POLONIUS, TEXT_LEVEL7_KENNY, TEXT_LEVEL7_SPLINTER } },
+};
+
+#define STORY_FRAMES	((int)(sizeof(gStory)/sizeof(gStory[0])))
+
+//where the fixed parts of the screen go, indexed by SPOT_*
+static const HamletSpot gLayout[SPOTS] =
+{
+	{ 85, 25 },		//background, seen through the wall
+	{ 0, 0 },		//wall
+	{ 21, 42 },		//Hamlet
+	{ 53, 27 },		//Gertrude
+	{ 3, SCENE_HEIGHT },	//text box
+	{ 0, SCENE_HEIGHT },	//menu
+	{ 20, 30 },		//instructions, the first line in bold
+	{ 20, 50 },
+	{ 20, 65 },
+	{ 20, 85 },
+	{ 20, 100 },
+};
+
+//set pieces, characters and sword frames used by levels 3-7, decoded behind the logo by Hamlet_LoadTick
+static const uint16 gPreloadImages[] =
+{
+	IMG_BACK0, IMG_BACK1, IMG_BACK2, IMG_BACK3,
+	IMG_WALL0, IMG_WALL1, IMG_WALL2, IMG_WALL3,
+	IMG_HAMLET, IMG_GERTRUDE,
+	IMG_SWORD1, IMG_SWORD2, IMG_SWORD3,
+};
+
+//the set pieces the 1-6 keys choose from, the default first
+static const uint16 gBacks[] = { IMG_BACK0, IMG_BACK1, IMG_BACK2, IMG_BACK3 };
+static const uint16 gWalls[] = { IMG_WALL0, IMG_WALL1, IMG_WALL2, IMG_WALL3 };
+
+//every string the applet shows, put in the text table by Hamlet_InitAppData
+static const uint16 gTextIDs[] =
+{
+	STAT_TITLE,
+	TEXT_LEVEL3, TEXT_LEVEL5,
+	TEXT_LEVEL6_POLONIUS, TEXT_LEVEL6_KENNY, TEXT_LEVEL6_SPLINTER,
+	TEXT_LEVEL7_POLONIUS, TEXT_LEVEL7_KENNY, TEXT_LEVEL7_SPLINTER,
+	INSTRUCTION0, INSTRUCTION1, INSTRUCTION2, INSTRUCTION3, INSTRUCTION4,
+	STR_MENUTITLE, STR_POLONIUS, STR_KENNY, STR_SPLINTER,
+};
+
+//the kill-choice menu, top to bottom
+static const HamletMenuItem gMenuItems[] =
+{
+	{ MENUID_POLONIUS,	STR_POLONIUS },
+	{ MENUID_KENNY,		STR_KENNY },
+	{ MENUID_SPLINTER,	STR_SPLINTER },
+};
 
 /*===============================================================================
 FUNCTION DEFINITIONS
@@ -211,14 +454,22 @@ SIDE EFFECTS
 ===========================================================================*/
 static boolean Hamlet_HandleEvent(Hamlet* pHam, AEEEvent eCode, uint16 wParam, uint32 dwParam)
 {  
-	AEEApplet * pMe = &pHam->a;
 	//AECHAR szBuf[] = {'H','e','l','l','o',' ','W','o', 'r', 'l', 'd', '\0'}; //wide-character string
+	uint16 nPicked;
 
     switch (eCode) 
 	{
         // App is told it is starting up
         case EVT_APP_START:
-		    Hamlet_Timer(pHam);
+			//a snapshot left behind means the last run was stopped while suspended
+			if(HamletState_Load(pHam->a.m_pIShell, &pHam->snap) == SUCCESS)
+			{
+				pHam->bSaved = TRUE;
+				Hamlet_Resume(pHam, &pHam->snap, TRUE);
+			}
+			else
+			{	Hamlet_Timer(pHam);	}
+			Hamlet_StartLoading(pHam);	//the first frame is up, the rest can come behind it
 
             return(TRUE);
 
@@ -233,16 +484,20 @@ static boolean Hamlet_HandleEvent(Hamlet* pHam, AEEEvent eCode, uint16 wParam, u
         // App is being suspended 
         case EVT_APP_SUSPEND:
 		    // Add your code here...
-			ISHELL_CancelTimer(pHam->a.m_pIShell,NULL,pHam);
-			if(pHam->nLevel>1)
-			{	pHam->nLevel--;	}
+			Hamlet_Suspend(pHam);
       		return(TRUE);
 
 
         // App is being resumed
         case EVT_APP_RESUME:
 		    // Add your code here...
-			Hamlet_Timer(pHam);
+			//one with no EVT_APP_SUSPEND before it finds the screen and the timers as they were
+			if(pHam->bSuspended)
+			{
+				pHam->bSuspended = FALSE;
+				Hamlet_Resume(pHam, &pHam->snap, FALSE);
+				Hamlet_StartLoading(pHam);	//EVT_APP_SUSPEND cancelled its tick
+			}
       		return(TRUE);
 
 
@@ -256,49 +511,53 @@ static boolean Hamlet_HandleEvent(Hamlet* pHam, AEEEvent eCode, uint16 wParam, u
         // A key was pressed. Look at the wParam above to see which key was pressed. The key
         // codes are in AEEVCodes.h. Example "AVK_1" means that the "1" key was pressed.
         case EVT_KEY:
-			if(pHam->nLevel == 5 && pHam->pIMenu != NULL)
+			if(pHam->nLevel == 5 && pHam->menu.bActive)
 			{
-				IMENUCTL_HandleEvent(pHam->pIMenu, EVT_KEY, wParam, 0);
+				//a pick goes out as EVT_COMMAND, the way IMenuCtl sends it, and the menu stops taking keys
+				if(HamletMenu_HandleKey(&pHam->menu, wParam, &nPicked))
+				{
+					HamletMenu_SetActive(&pHam->menu, FALSE);
+					ISHELL_PostEvent(pHam->a.m_pIShell, pHam->a.clsID, EVT_COMMAND, nPicked, 0);
+				}
+
+				//the highlight moved, the branch under it goes first
+				else if(HamletMenu_GetSel(&pHam->menu) != pHam->nPrefetch)
+				{
+					Hamlet_PrefetchMenu(pHam, HamletMenu_GetSel(&pHam->menu));
+				}
 			}	
 
 			else if(wParam >= AVK_1 && wParam <= AVK_6)
 			{
+				//the first press since the last tick starts the next one
+				if(pHam->wPendingBack == 0 && pHam->wPendingWall == 0)
+				{
+					ISHELL_SetTimer(pHam->a.m_pIShell, SCENERY_TICK, (PFNNOTIFY)Hamlet_SceneryTick, pHam);
+				}
+
+				//only note the choice, a later press before the tick replaces it
 				switch(wParam)
 				{
 					case AVK_1:
-						if(pHam->pImageBack)	{	IIMAGE_Release(pHam->pImageBack);		}
-						pHam->pImageBack = ISHELL_LoadResImage(pMe->m_pIShell, HAMLET_RES_FILE, IMG_BACK1);
+						pHam->wPendingBack = IMG_BACK1;
 						break;
 					case AVK_2:
-						if(pHam->pImageBack)	{	IIMAGE_Release(pHam->pImageBack);		}
-						pHam->pImageBack = ISHELL_LoadResImage(pMe->m_pIShell, HAMLET_RES_FILE, IMG_BACK2);
+						pHam->wPendingBack = IMG_BACK2;
 						break;
 					case AVK_3:
-						if(pHam->pImageBack)	{	IIMAGE_Release(pHam->pImageBack);		}
-						pHam->pImageBack = ISHELL_LoadResImage(pMe->m_pIShell, HAMLET_RES_FILE, IMG_BACK3);
+						pHam->wPendingBack = IMG_BACK3;
 						break;
 					case AVK_4:
-						if(pHam->pImageWall)	{	IIMAGE_Release(pHam->pImageWall);		}
-						pHam->pImageWall = ISHELL_LoadResImage(pMe->m_pIShell, HAMLET_RES_FILE, IMG_WALL1);
+						pHam->wPendingWall = IMG_WALL1;
 						break;
 					case AVK_5:
-						if(pHam->pImageWall)	{	IIMAGE_Release(pHam->pImageWall);		}
-						pHam->pImageWall = ISHELL_LoadResImage(pMe->m_pIShell, HAMLET_RES_FILE, IMG_WALL2);
+						pHam->wPendingWall = IMG_WALL2;
 						break;
 					case AVK_6:
-						if(pHam->pImageWall)	{	IIMAGE_Release(pHam->pImageWall);		}
-						pHam->pImageWall = ISHELL_LoadResImage(pMe->m_pIShell, HAMLET_RES_FILE, IMG_WALL3);
+						pHam->wPendingWall = IMG_WALL3;
 						break;
 
 				}//end switch
-				
-				//update only at correct levels: note nLevel is set to the next level
-				if(pHam->nLevel >= 4 && pHam->nLevel <= 7)
-				{
-					Hamlet_DrawScenery(pHam);
-					Hamlet_DrawCharacters(pHam);
-					IDISPLAY_Update(pHam->a.m_pIDisplay);	//update all drawings
-				}
 			}//end if
 			//else if(pHam->nLevel == 5 && pHam->pIMenu != NULL)
 			//{
@@ -308,10 +567,20 @@ static boolean Hamlet_HandleEvent(Hamlet* pHam, AEEEvent eCode, uint16 wParam, u
 			
 		//something from the menu is selected
 		case EVT_COMMAND:
+			ISHELL_CancelTimer(pHam->a.m_pIShell, (PFNNOTIFY)Hamlet_PrefetchTick, pHam);
 			pHam->nBranch = wParam;
+			if(pHam->nBranch >= MENUID_POLONIUS && pHam->nBranch <= MENUID_SPLINTER)
+			{
+				//everything the rest of this branch shows gets decoded before the stab
+				Hamlet_PrefetchBranch(pHam);
+			}
 			Hamlet_Timer(pHam);
 			break;
 
+		case EVT_HAMLET_REPLAY:
+			pHam->bReplay = (wParam != 0);
+			return TRUE;
+
         // If nothing fits up to this point then we'll just break out
         default:
             break;
@@ -324,6 +593,8 @@ static boolean Hamlet_HandleEvent(Hamlet* pHam, AEEEvent eCode, uint16 wParam, u
 // this function is called when your application is starting up
 boolean Hamlet_InitAppData(Hamlet* pHam)
 {
+	AEERect qrc;
+
     // Get the device information for this handset.
     // Reference all the data by looking at the pHam->DeviceInfo structure
     // Check the API reference guide for all the handy device info you can get
@@ -335,12 +606,30 @@ boolean Hamlet_InitAppData(Hamlet* pHam)
     // them via the standard "pHam->" without the "a."
     pHam->pIDisplay = pHam->a.m_pIDisplay;
     pHam->pIShell   = pHam->a.m_pIShell;
+	Hamlet_InitLayout(pHam);
 
     // Insert your code here for initializing or allocating resources...
 	pHam -> nLevel = 1;
 	pHam -> nBranch = 0;
-	pHam->pImageBack = ISHELL_LoadResImage(pHam->a.m_pIShell, HAMLET_RES_FILE, IMG_BACK0);
-	pHam->pImageWall = ISHELL_LoadResImage(pHam->a.m_pIShell, HAMLET_RES_FILE, IMG_WALL0);
+	HamletTiming_Init(&pHam->timing);
+
+	//without the bundle every lookup goes back to HAMLET_RES_FILE
+	HamletRes_Open(&pHam->res, pHam->a.m_pIShell, HAMLET_RES_FILE, HAMLET_PAK_FILE);
+	HamletText_Init(&pHam->text, &pHam->res, gTextIDs, sizeof(gTextIDs)/sizeof(gTextIDs[0]));
+	HamletText_InitGlyphs(&pHam->glyphs, pHam->a.m_pIDisplay, &pHam->text);
+	HamletMenu_Init(&pHam->menu, pHam->a.m_pIDisplay, &pHam->glyphs);
+
+	//the scene images are decoded after EVT_APP_START has put up the logo, see Hamlet_StartLoading;
+	//on a screen of another size they are scaled as they are decoded, once each
+	HamletCache_Init(&pHam->imageCache, &pHam->res, pHam->a.m_pIDisplay);
+	HamletCache_SetScale(&pHam->imageCache, pHam->nScaleNum, pHam->nScaleDen);
+
+	//the scene is the part of the screen above the text box
+	qrc.x	= 0;
+	qrc.y	= 0;
+	qrc.dx	= pHam->di.cxScreen;
+	qrc.dy	= (int16)Hamlet_LayoutSize(pHam, SCENE_HEIGHT);
+	HamletCompositor_Init(&pHam->compositor, pHam->a.m_pIDisplay, &pHam->imageCache, &qrc, LAYER_SPRITES);
 
     // if there have been no failures up to this point then return success
     return TRUE;
@@ -378,447 +667,695 @@ void Hamlet_FreeAppData(Hamlet* pHam)
 	{	IIMAGE_Release(pHam->pImageSword);		}
 
 	//free GUI stuff
-	if(pHam->pIMenu)
-	{	IMENUCTL_Release(pHam->pIMenu);		}
-	if(pHam->pIStatic)
-	{	ISTATIC_Release(pHam->pIStatic);	}
+	HamletMenu_Free(&pHam->menu);
 
+	HamletCompositor_Free(&pHam->compositor);
+
+	//drop the decoded images last, after the references above are gone
+	HamletCache_Free(&pHam->imageCache);
+	HamletText_FreeGlyphs(&pHam->glyphs);
+	HamletText_Free(&pHam->text);
+	HamletRes_Close(&pHam->res);
 
 }
 
-//calls whatever appropriate when it's that level
+//one scale for both directions, the smaller of the two, so nothing is stretched or falls off the screen
+void Hamlet_InitLayout(Hamlet* pHam)
+{
+	int i;
+
+	if(pHam->di.cxScreen * LAYOUT_CY <= pHam->di.cyScreen * LAYOUT_CX)
+	{
+		pHam->nScaleNum = pHam->di.cxScreen;
+		pHam->nScaleDen = LAYOUT_CX;
+	}
+	else
+	{
+		pHam->nScaleNum = pHam->di.cyScreen;
+		pHam->nScaleDen = LAYOUT_CY;
+	}
+	if(pHam->nScaleNum == pHam->nScaleDen || pHam->nScaleNum <= 0)
+	{
+		pHam->nScaleNum = 1;
+		pHam->nScaleDen = 1;
+	}
+	pHam->xLayout = (pHam->di.cxScreen - Hamlet_LayoutSize(pHam, LAYOUT_CX)) / 2;
+
+	for(i = 0; i < SPOTS; i++)
+	{
+		pHam->spots[i].x = (int16)Hamlet_LayoutX(pHam, gLayout[i].x);
+		pHam->spots[i].y = (int16)Hamlet_LayoutY(pHam, gLayout[i].y);
+	}
+}
+
+int Hamlet_LayoutX(Hamlet* pHam, int x)
+{
+	return pHam->xLayout + Hamlet_LayoutSize(pHam, x);
+}
+
+int Hamlet_LayoutY(Hamlet* pHam, int y)
+{
+	return Hamlet_LayoutSize(pHam, y);
+}
+
+//rounded the way HamletCache rounds the pictures' sizes, so they meet up
+int Hamlet_LayoutSize(Hamlet* pHam, int n)
+{
+	return (n * pHam->nScaleNum + pHam->nScaleDen / 2) / pHam->nScaleDen;
+}
+
+//starts level pHam->nLevel at its first frame; the frames after it are timed from now
 void Hamlet_Timer(Hamlet* pHam)
 {
-	switch(pHam->nLevel)
+	int i;
+
+	for(i = 0; i < STORY_FRAMES; i++)
+	{
+		if(gStory[i].nLevel == pHam->nLevel)
+		{
+			pHam->nFrame = i;
+			HamletTiming_Start(&pHam->timing);
+			Hamlet_ShowFrame(pHam);
+			return;
+		}
+	}
+	//no such level, the story is over
+}
+
+//timer callback from one frame to the next
+void Hamlet_NextFrame(Hamlet* pHam)
+{
+	HamletTiming_Fired(&pHam->timing, pHam->nFrame + 1);
+	if(pHam->nFrame + 1 < STORY_FRAMES)
+	{
+		pHam->nFrame++;
+		Hamlet_ShowFrame(pHam);
+	}
+	else
+	{
+		HamletTiming_Report(&pHam->timing);	//the story, or one pass through it, is over
+
+		//props and text box are dropped by REPLAY_LEVEL itself, the menu is rebuilt from scratch
+		if(pHam->bReplay)
+		{
+			pHam->nLevel = REPLAY_LEVEL;
+			Hamlet_Timer(pHam);
+		}
+	}
+}
+
+//draws gStory[pHam->nFrame] and schedules whatever comes after it
+void Hamlet_ShowFrame(Hamlet* pHam)
+{
+	AEEApplet * pMe = &pHam->a;
+	const HamletFrame* pFrame = &gStory[pHam->nFrame];
+	int nBranch = Hamlet_Branch(pHam);
+	const HamletProp* pProp = &pFrame->prop[nBranch];
+
+	pHam->nLevel = pFrame->nLevel;
+	if(pFrame->nKind == FRAME_SCENE || pFrame->nKind == FRAME_MENU)
+	{	Hamlet_FinishLoading(pHam);		}
+	Hamlet_TakePendingScenery(pHam);	//the frame draws the latest set pieces anyway
+
+	//the menu takes the text box's place
+	if(pFrame->nKind == FRAME_MENU)
+	{
+		pHam->wText = 0;
+	}
+
+	if(pFrame->bClear)
+	{
+		IDISPLAY_ClearScreen(pMe->m_pIDisplay);
+		HamletCompositor_InvalidateAll(&pHam->compositor);	//the whole scene has to come back
+		pHam->wText = 0;	//and the text box went with it
+	}
+
+	switch(pFrame->nKind)
 	{
-		case 1:
-			Hamlet_ShowLogo(pHam);
+		case FRAME_LOGO:
+			Hamlet_ShowLogo(pHam, pProp->wImage, pProp->x, pProp->y);
 			break;
-		case 2:
+		case FRAME_INSTRUCTIONS:
 			Hamlet_ShowInstructions(pHam);
 			break;
-		case 3:
-			Hamlet_BuildLevel3(pHam);
-			break;
-		case 4:
-			Hamlet_BuildLevel4(pHam);
-			break;
-		case 5:
-			Hamlet_BuildLevel5(pHam);
-			break;
-		case 6:
-			Hamlet_BuildLevel6(pHam);
-			break;
-		case 7:
-			Hamlet_BuildLevel7(pHam);
+		case FRAME_SCENE:
+		case FRAME_MENU:
+			Hamlet_ShowScene(pHam, pFrame->nLayer, pFrame->wHide, pProp->wImage, pProp->x, pProp->y, (pProp->wFlags & PROP_COVER) != 0);
 			break;
 	}
+
+	//static text box
+	if(pFrame->wText[nBranch])
+	{
+		Hamlet_BuildStatic(pHam, pFrame->wText[nBranch]);
+	}
+
+	//go to next frame, due wDelay after this one was; nLevel already says which level comes next while this one holds
+	if(pFrame->wDelay)
+	{
+		ISHELL_SetTimer(pMe->m_pIShell, HamletTiming_Schedule(&pHam->timing, pFrame->wDelay), (PFNNOTIFY)Hamlet_NextFrame, pHam);
+	}
+	pHam->nLevel = Hamlet_LevelAfter(pHam->nFrame);
+
+	//the menu's EVT_COMMAND starts the next level
+	if(pFrame->nKind == FRAME_MENU)
+	{
+		Hamlet_BuildMenu(pHam);
+	}
 }
 
 //display the "Hamlet" logo, level 1
-void Hamlet_ShowLogo(Hamlet* pHam)
-{
+void Hamlet_ShowLogo(Hamlet* pHam, uint16 wImage, int x, int y)
+{
 	AEEApplet * pMe = &pHam->a;
-	pHam->nLevel = 1;
+	AEEImageInfo info;
 
-	IDISPLAY_ClearScreen(pMe->m_pIDisplay);
-	pHam->pImageLogo = ISHELL_LoadResImage(pMe->m_pIShell, HAMLET_RES_FILE, IMG_LOGO);
-	IIMAGE_SetParm(pHam->pImageLogo, IPARM_ROP, AEE_RO_TRANSPARENT, 0 );
-	IIMAGE_Draw(pHam->pImageLogo, 1, 50);
+	//only ever shown once, so it skips the cache and is scaled as it is drawn
+	pHam->pImageLogo = HamletRes_LoadImage(&pHam->res, wImage);
+	if(pHam->pImageLogo)
+	{
+		if(pHam->nScaleNum != pHam->nScaleDen)
+		{
+			IIMAGE_GetInfo(pHam->pImageLogo, &info);
+			IIMAGE_SetParm(pHam->pImageLogo, IPARM_SCALE, Hamlet_LayoutSize(pHam, info.cx), Hamlet_LayoutSize(pHam, info.cy));
+		}
+		IIMAGE_SetParm(pHam->pImageLogo, IPARM_ROP, AEE_RO_TRANSPARENT, 0 );
+		IIMAGE_Draw(pHam->pImageLogo, Hamlet_LayoutX(pHam, x), Hamlet_LayoutY(pHam, y));
+		IIMAGE_Release(pHam->pImageLogo);
+		pHam->pImageLogo = NULL;
+	}
 	IDISPLAY_Update(pMe->m_pIDisplay);
-	IIMAGE_Release(pHam->pImageLogo);
-
-	//go to next screen
-	ISHELL_SetTimer(pMe->m_pIShell, LEVEL1_DELAY, (PFNNOTIFY)Hamlet_Timer, pHam);
-	pHam->nLevel = 2;
 }
 
 //show instructions about what to press, level 2
 void Hamlet_ShowInstructions(Hamlet* pHam)
 {
 	AEEApplet * pMe = &pHam->a;
-	AECHAR strBuf[40];
-
-	//clear screen (default color is white)
-	IDISPLAY_ClearScreen(pMe->m_pIDisplay);
-
-	//draw the text
-	ISHELL_LoadResString(pMe->m_pIShell, HAMLET_RES_FILE, INSTRUCTION0, strBuf, 40);
-    IDISPLAY_DrawText(pMe->m_pIDisplay, AEE_FONT_BOLD, strBuf, -1, 20, 30, 0, NULL);
-	ISHELL_LoadResString(pMe->m_pIShell, HAMLET_RES_FILE, INSTRUCTION1, strBuf, 40);
-    IDISPLAY_DrawText(pMe->m_pIDisplay, AEE_FONT_NORMAL, strBuf, -1, 20, 50, 0, NULL);
-	ISHELL_LoadResString(pMe->m_pIShell, HAMLET_RES_FILE, INSTRUCTION2, strBuf, 40);
-    IDISPLAY_DrawText(pMe->m_pIDisplay, AEE_FONT_NORMAL, strBuf, -1, 20, 65, 0, NULL);
-	ISHELL_LoadResString(pMe->m_pIShell, HAMLET_RES_FILE, INSTRUCTION3, strBuf, 40);
-    IDISPLAY_DrawText(pMe->m_pIDisplay, AEE_FONT_NORMAL, strBuf, -1, 20, 85, 0, NULL);
-	ISHELL_LoadResString(pMe->m_pIShell, HAMLET_RES_FILE, INSTRUCTION4, strBuf, 40);
-    IDISPLAY_DrawText(pMe->m_pIDisplay, AEE_FONT_NORMAL, strBuf, -1, 20, 100, 0, NULL);
+	const HamletTextLayout* pLayout;
+	AEERect qrc;
+	int i;
+
+	//each line from its spot to the edge of the screen; the lines move with the layout, the fonts stay as they are
+	for(i = 0; i < 5; i++)
+	{
+		qrc.x	= pHam->spots[SPOT_INSTRUCTION0 + i].x;
+		qrc.y	= pHam->spots[SPOT_INSTRUCTION0 + i].y;
+		qrc.dx	= pHam->di.cxScreen - qrc.x;
+		qrc.dy	= pHam->di.cyScreen - qrc.y;
+		pLayout = HamletText_Layout(&pHam->glyphs, (uint16)(INSTRUCTION0 + i), i == 0 ? AEE_FONT_BOLD : AEE_FONT_NORMAL, &qrc);
+		if(pLayout)
+		{	HamletText_Draw(&pHam->glyphs, pLayout);	}
+	}
 	
 	//update screen
     IDISPLAY_Update(pMe->m_pIDisplay);
-
-	//go to next screen
-	ISHELL_SetTimer(pMe->m_pIShell, LEVEL2_DELAY, (PFNNOTIFY)Hamlet_Timer, pHam);
-	pHam->nLevel = 3;
 }
 
-//the level where Hamlet tells Gertrude about the rat
-void Hamlet_BuildLevel3(Hamlet* pHam)
-{
-	AEEApplet * pMe = &pHam->a;
-
-	//set the background and wall to init value
-	IDISPLAY_ClearScreen(pMe->m_pIDisplay);
+//puts up the set pieces, the characters and this frame's prop, then shows whatever changed
+void Hamlet_ShowScene(Hamlet* pHam, int nLayer, uint16 wHide, uint16 wImage, int x, int y, boolean bCover)
+{
+	Hamlet_StageScene(pHam, nLayer, wHide, wImage, x, y, bCover);
+	HamletCompositor_Flush(&pHam->compositor);	//update what changed
+}
 
-	//set the characters
-	pHam->pImageHamlet = ISHELL_LoadResImage(pMe->m_pIShell, HAMLET_RES_FILE, IMG_HAMLET);
-	IIMAGE_SetParm(pHam->pImageHamlet, IPARM_ROP, AEE_RO_TRANSPARENT, 0 );
-	pHam->pImageGertrude = ISHELL_LoadResImage(pMe->m_pIShell, HAMLET_RES_FILE, IMG_GERTRUDE);
-	IIMAGE_SetParm(pHam->pImageGertrude, IPARM_ROP, AEE_RO_TRANSPARENT, 0);
+//the layer changes of one scene frame, nothing is drawn yet
+void Hamlet_StageScene(Hamlet* pHam, int nLayer, uint16 wHide, uint16 wImage, int x, int y, boolean bCover)
+{
+	IImage** ppSlot;
+	AEERect rcFrame;
+	int i;
 
-	Hamlet_DrawScenery(pHam);		//draw the scenerary (background behind wall)
-	Hamlet_DrawCharacters(pHam);	//draw the characters
-	IDISPLAY_Update(pHam->a.m_pIDisplay);	//update all drawings
+	//props that are no longer part of the scene
+	for(i = LAYER_SPRITES; i <= LAYER_BASTARD; i++)
+	{
+		if(wHide & LAYER_MASK(i))
+		{
+			HamletCompositor_HideLayer(&pHam->compositor, i);
+			ppSlot = Hamlet_PropSlot(pHam, i);
+			if(*ppSlot)	{	IIMAGE_Release(*ppSlot);	*ppSlot = NULL;	}
+		}
+	}
 
-	//static text box
-	Hamlet_BuildStatic(pHam);
+	if(bCover)
+	{
+		//the full-screen picture replaces everything below it
+		for(i = LAYER_BACK; i < nLayer; i++)
+		{
+			HamletCompositor_HideLayer(&pHam->compositor, i);
+		}
+	}
+	else
+	{
+		Hamlet_DrawScenery(pHam);		//draw the scenerary (background behind wall)
+		Hamlet_DrawCharacters(pHam);	//draw the characters
+	}
 
-	//go to next screen
-	ISHELL_SetTimer(pMe->m_pIShell, LEVEL3_DELAY, (PFNNOTIFY)Hamlet_Timer, pHam);
-	pHam->nLevel = 4;
+	if(wImage)
+	{
+		//an animation's frames share one atlas, the slot keeps a reference to it
+		ppSlot = Hamlet_PropSlot(pHam, nLayer);
+		if(*ppSlot)	{	IIMAGE_Release(*ppSlot);	}
+		*ppSlot = HamletCache_GetFrame(&pHam->imageCache, wImage, &rcFrame);
+		HamletCompositor_SetLayerFrame(&pHam->compositor, nLayer, *ppSlot, &rcFrame, Hamlet_LayoutX(pHam, x), Hamlet_LayoutY(pHam, y), !bCover);
+	}
 }
 
-//the level where user gets to choose who Hamlet kills
-void Hamlet_BuildLevel4(Hamlet* pHam)
-{
-	AEEApplet * pMe = &pHam->a;
-
-	if (pHam->pIStatic)
+//the applet's own reference to the image on a prop layer
+IImage** Hamlet_PropSlot(Hamlet* pHam, int nLayer)
+{
+	switch(nLayer)
 	{
-		ISTATIC_Release(pHam->pIStatic);
-		pHam->pIStatic = NULL;
+		case LAYER_SWORD:
+			return &pHam->pImageSword;
+		case LAYER_DEAD:
+			return &pHam->pImageDead;
+		default:
+			return &pHam->pImageBastard;
 	}
+}
 
-	IDISPLAY_ClearScreen(pMe->m_pIDisplay);
-
-	Hamlet_DrawScenery(pHam);		//draw the scenerary (background behind wall)
-	Hamlet_DrawCharacters(pHam);	//draw the characters
-	IDISPLAY_Update(pHam->a.m_pIDisplay);	//update all drawings
+int Hamlet_Branch(Hamlet* pHam)
+{
+	return (pHam->nBranch >= MENUID_POLONIUS && pHam->nBranch <= MENUID_SPLINTER) ? pHam->nBranch : MENUID_POLONIUS;
+}
 
-	//go to next screen after recording selection
-	//go to next screen
-	pHam->nLevel = 5;
+//decodes every prop the rest of the story shows on the chosen branch; the full-screen ones in the background, the rat
+//hanging there for LEVEL6_DELAY leaves the decoder time to finish before the conclusion
+void Hamlet_PrefetchBranch(Hamlet* pHam)
+{
+	const HamletProp* pProp;
+	uint16 wImages[STORY_FRAMES];
+	int nCount = 0;
+	int i;
 
-	//static text box
-	Hamlet_BuildMenu(pHam);
+	for(i = pHam->nFrame + 1; i < STORY_FRAMES; i++)
+	{
+		pProp = &gStory[i].prop[pHam->nBranch];
+		if(pProp->wImage == 0)
+		{	continue;	}
 
+		if(!(pProp->wFlags & PROP_COVER) || !HamletCache_DecodeAsync(&pHam->imageCache, pProp->wImage))
+		{
+			wImages[nCount++] = pProp->wImage;
+		}
+	}
+	HamletCache_Preload(&pHam->imageCache, wImages, nCount);
 }
 
-//the level where Hamlet stabs 
-void Hamlet_BuildLevel5(Hamlet* pHam)
-{
-	AEEApplet * pMe = &pHam->a;
-
-	IDISPLAY_ClearScreen(pMe->m_pIDisplay);
-
-	pHam->pImageSword = ISHELL_LoadResImage(pMe->m_pIShell, HAMLET_RES_FILE, IMG_SWORD1);
+//from now on the menu's branches are decoded a picture per tick, nBranch's first
+void Hamlet_PrefetchMenu(Hamlet* pHam, int nBranch)
+{
+	pHam->nPrefetch = (nBranch >= MENUID_POLONIUS && nBranch <= MENUID_SPLINTER) ? nBranch : MENUID_POLONIUS;
+	ISHELL_SetTimer(pHam->a.m_pIShell, PREFETCH_TICK, (PFNNOTIFY)Hamlet_PrefetchTick, pHam);
+}
 
-	Hamlet_DrawScenery(pHam);		//draw the scenerary (background behind wall)
-	Hamlet_DrawCharacters(pHam);	//draw the characters
-	IDISPLAY_Update(pHam->a.m_pIDisplay);	//update all drawings
+//decodes the next picture any branch shows after the menu, or starts its background decode; stops once there is none left
+void Hamlet_PrefetchTick(Hamlet* pHam)
+{
+	HamletImageCache* pCache = &pHam->imageCache;
+	const HamletProp* pProp;
+	boolean bWaiting = FALSE;
+	int nBranch;
+	int n;
+	int i;
 
-	//static text box
-	Hamlet_BuildStatic(pHam);
+	for(n = 0; n < 3; n++)
+	{
+		nBranch = (pHam->nPrefetch + n) % 3;
+		for(i = pHam->nFrame + 1; i < STORY_FRAMES; i++)
+		{
+			pProp = &gStory[i].prop[nBranch];
+			if(pProp->wImage == 0 || HamletCache_Has(pCache, pProp->wImage))
+			{	continue;	}
 
-	//go to next screen
-	ISHELL_SetTimer(pMe->m_pIShell, 500, (PFNNOTIFY)Hamlet_BuildLevel5Frame2, pHam);
-}
+			//the branches not highlighted are a guess, they must not crowd out the one that gets picked
+			if(n > 0 && GETRAMFREE(NULL, NULL) < PREFETCH_RAM_RESERVE)
+			{	return;		}
 
-void Hamlet_BuildLevel5Frame2(Hamlet* pHam)
-{
-	AEEApplet * pMe = &pHam->a;
+			if(pProp->wFlags & PROP_COVER)
+			{
+				//the highlighted branch's conclusion takes the place of another's, the others wait their turn
+				if(n > 0 && HamletCache_Decoding(pCache))
+				{
+					bWaiting = TRUE;
+					continue;
+				}
+				if(!HamletCache_DecodeAsync(pCache, pProp->wImage))
+				{	HamletCache_Preload(pCache, &pProp->wImage, 1);	}
+			}
+			else
+			{
+				HamletCache_Preload(pCache, &pProp->wImage, 1);
+			}
 
-	IIMAGE_Release(pHam->pImageSword);
-	pHam->pImageSword = ISHELL_LoadResImage(pMe->m_pIShell, HAMLET_RES_FILE, IMG_SWORD2);
+			//no such picture or no room for it: the menu pick decodes whatever is left, as before
+			if(!HamletCache_Has(pCache, pProp->wImage))
+			{	return;		}
 
-	Hamlet_DrawScenery(pHam);		//draw the scenerary (background behind wall)
-	Hamlet_DrawCharacters(pHam);	//draw the characters
-	IDISPLAY_Update(pHam->a.m_pIDisplay);	//update all drawings
+			ISHELL_SetTimer(pHam->a.m_pIShell, PREFETCH_TICK, (PFNNOTIFY)Hamlet_PrefetchTick, pHam);
+			return;
+		}
+	}
 
-	//go to next screen
-	ISHELL_SetTimer(pMe->m_pIShell, 500, (PFNNOTIFY)Hamlet_BuildLevel5Frame3, pHam);
+	if(bWaiting)
+	{	ISHELL_SetTimer(pHam->a.m_pIShell, PREFETCH_TICK, (PFNNOTIFY)Hamlet_PrefetchTick, pHam);	}
 }
 
-void Hamlet_BuildLevel5Frame3(Hamlet* pHam)
-{
-	AEEApplet * pMe = &pHam->a;
+//decodes gPreloadImages a tick at a time from here, so no animation frame has to touch the resource file
+void Hamlet_StartLoading(Hamlet* pHam)
+{
+	if(!pHam->bLoaded)
+	{	ISHELL_SetTimer(pHam->a.m_pIShell, LOAD_TICK, (PFNNOTIFY)Hamlet_LoadTick, pHam);	}
+}
 
-	IIMAGE_Release(pHam->pImageSword);
-	pHam->pImageSword = ISHELL_LoadResImage(pMe->m_pIShell, HAMLET_RES_FILE, IMG_SWORD3);
+void Hamlet_LoadTick(Hamlet* pHam)
+{
+	int nCount = sizeof(gPreloadImages)/sizeof(gPreloadImages[0]);
 
-	Hamlet_DrawScenery(pHam);		//draw the scenerary (background behind wall)
-	Hamlet_DrawCharacters(pHam);	//draw the characters
-	IDISPLAY_Update(pHam->a.m_pIDisplay);	//update all drawings
+	if(pHam->nLoaded < nCount)
+	{	HamletCache_Preload(&pHam->imageCache, &gPreloadImages[pHam->nLoaded++], 1);	}
 
-	//go to next screen
-	ISHELL_SetTimer(pMe->m_pIShell, LEVEL5_DELAY, (PFNNOTIFY)Hamlet_BuildLevel6, pHam);
-	pHam->nLevel = 6;
+	if(pHam->nLoaded < nCount)
+	{	ISHELL_SetTimer(pHam->a.m_pIShell, LOAD_TICK, (PFNNOTIFY)Hamlet_LoadTick, pHam);	}
+	else
+	{	Hamlet_FinishLoading(pHam);		}
 }
 
-//the level where the rat is revealed
-void Hamlet_BuildLevel6(Hamlet* pHam)
-{
-	AEEApplet * pMe = &pHam->a;
+//a scene is about to be staged: the rest of the preloads go now, and the set pieces the 1-6 keys have
+//not picked yet are IMG_BACK0 and IMG_WALL0
+void Hamlet_FinishLoading(Hamlet* pHam)
+{
+	int nCount = sizeof(gPreloadImages)/sizeof(gPreloadImages[0]);
 
-	IDISPLAY_ClearScreen(pMe->m_pIDisplay);
-	switch(pHam->nBranch)
-	{
-		case MENUID_POLONIUS:
-			pHam->pImageDead = ISHELL_LoadResImage(pMe->m_pIShell, HAMLET_RES_FILE, IMG_POLONIUS1);
-			break;
-		case MENUID_KENNY:
-			pHam->pImageDead = ISHELL_LoadResImage(pMe->m_pIShell, HAMLET_RES_FILE, IMG_KENNY1);
-			break;
-		case MENUID_SPLINTER:
-			pHam->pImageDead = ISHELL_LoadResImage(pMe->m_pIShell, HAMLET_RES_FILE, IMG_SPLINTER1);
-			break;
-	}
+	if(pHam->bLoaded)
+	{	return;		}
 
-	Hamlet_DrawScenery(pHam);		//draw the scenerary (background behind wall)
-	Hamlet_DrawCharacters(pHam);	//draw the characters
-	IDISPLAY_Update(pHam->a.m_pIDisplay);	//update all drawings
+	ISHELL_CancelTimer(pHam->a.m_pIShell, (PFNNOTIFY)Hamlet_LoadTick, pHam);
+	if(pHam->nLoaded < nCount)
+	{	HamletCache_Preload(&pHam->imageCache, &gPreloadImages[pHam->nLoaded], nCount - pHam->nLoaded);	}
+	pHam->nLoaded = nCount;
 
-	//static text box
-	Hamlet_BuildStatic(pHam);
+	Hamlet_SetScenery(pHam, (uint16)(pHam->wBack ? 0 : IMG_BACK0), (uint16)(pHam->wWall ? 0 : IMG_WALL0));
+	pHam->pImageHamlet = HamletCache_Get(&pHam->imageCache, IMG_HAMLET);
+	pHam->pImageGertrude = HamletCache_Get(&pHam->imageCache, IMG_GERTRUDE);
+	pHam->bLoaded = TRUE;
+}
 
-	//go to next screen
-	ISHELL_SetTimer(pMe->m_pIShell, 200, (PFNNOTIFY)Hamlet_BuildLevel6Frame2, pHam);
+//the frame on screen, the set pieces and what is left of the wait for the next frame
+void Hamlet_Suspend(Hamlet* pHam)
+{
+	HamletSnapshot snap;
+	HamletSnapshot* pSnap = &snap;
+
+	Hamlet_TakePendingScenery(pHam);
+	ISHELL_CancelTimer(pHam->a.m_pIShell, NULL, pHam);
+	HamletTiming_Cancel(&pHam->timing);
+	HamletCache_CancelDecode(&pHam->imageCache);	//no decoding while another applet has the handset, Hamlet_Resume starts it over
+	pHam->bSuspended = TRUE;
+
+	MEMSET(pSnap, 0, sizeof(HamletSnapshot));
+	pSnap->dwMagic = HAMLET_STATE_MAGIC;
+	pSnap->wVersion = HAMLET_STATE_VERSION;
+	pSnap->nFrame = (uint8)pHam->nFrame;
+	pSnap->nLevel = (uint8)pHam->nLevel;
+	pSnap->nBranch = (uint8)Hamlet_Branch(pHam);
+	pSnap->wBack = pHam->wBack;
+	pSnap->wWall = pHam->wWall;
+	pSnap->wText = pHam->wText;
+	if(HamletTiming_Remaining(&pHam->timing, &pSnap->dwRemaining))
+	{	pSnap->nFlags |= HAMLET_STATE_TIMED;	}
+	if(pHam->bReplay)
+	{	pSnap->nFlags |= HAMLET_STATE_REPLAY;	}
+
+	//should the applet be stopped before it is resumed, the next start carries on from the file;
+	//a second suspend with nothing moved in between finds it written already
+	if(pHam->bSaved && MEMCMP(pSnap, &pHam->snap, sizeof(HamletSnapshot)) == 0)
+	{	return;		}
+	pHam->snap = snap;
+	pHam->bSaved = (HamletState_Save(pHam->a.m_pIShell, pSnap) == SUCCESS);
 }
 
-//the level where the rat is revealed
-void Hamlet_BuildLevel6Frame2(Hamlet* pHam)
-{
+//puts the snapshot's frame back with one redraw and gives its timer the time it had left;
+//bRestart when the applet was stopped in between and the snapshot is all there is of the story
+void Hamlet_Resume(Hamlet* pHam, HamletSnapshot* pSnap, boolean bRestart)
+{
 	AEEApplet * pMe = &pHam->a;
+	int i;
 
-	IIMAGE_Release(pHam->pImageDead);
-	switch(pHam->nBranch)
+	if(pHam->bSaved)
 	{
-		case MENUID_POLONIUS:
-			pHam->pImageDead = ISHELL_LoadResImage(pMe->m_pIShell, HAMLET_RES_FILE, IMG_POLONIUS2);
-			break;
-		case MENUID_KENNY:
-			pHam->pImageDead = ISHELL_LoadResImage(pMe->m_pIShell, HAMLET_RES_FILE, IMG_KENNY2);
-			break;
-		case MENUID_SPLINTER:
-			pHam->pImageDead = ISHELL_LoadResImage(pMe->m_pIShell, HAMLET_RES_FILE, IMG_SPLINTER2);
-			break;
+		HamletState_Remove(pMe->m_pIShell);
+		pHam->bSaved = FALSE;
+	}
+	if(!Hamlet_CheckSnapshot(pSnap))
+	{
+		//nothing usable, so the level starts over
+		Hamlet_Timer(pHam);
+		return;
 	}
 
-	Hamlet_DrawScenery(pHam);		//draw the scenerary (background behind wall)
-	Hamlet_DrawCharacters(pHam);	//draw the characters
-	IDISPLAY_Update(pHam->a.m_pIDisplay);	//update all drawings
-
-	//go to next screen
-	ISHELL_SetTimer(pMe->m_pIShell, 300, (PFNNOTIFY)Hamlet_BuildLevel6Frame3, pHam);
-}
-
-//the level where the rat is revealed
-void Hamlet_BuildLevel6Frame3(Hamlet* pHam)
-{
-	AEEApplet * pMe = &pHam->a;
+	if(bRestart)
+	{
+		pHam->nFrame = pSnap->nFrame;
+		pHam->nLevel = pSnap->nLevel;
+		pHam->nBranch = pSnap->nBranch;
+		pHam->wText = pSnap->wText;
+		pHam->bReplay = (pSnap->nFlags & HAMLET_STATE_REPLAY) != 0;
+		Hamlet_SetScenery(pHam, pSnap->wBack, pSnap->wWall);
+		Hamlet_RestoreScene(pHam);
+	}
+	Hamlet_RedrawFrame(pHam);
 
-	IIMAGE_Release(pHam->pImageDead);
-	switch(pHam->nBranch)
+	//the background decodes EVT_APP_SUSPEND dropped start over; a restart's RestoreScene and BuildMenu already did
+	if(gStory[pHam->nFrame].nKind == FRAME_MENU && pHam->menu.bActive)
 	{
-		case MENUID_POLONIUS:
-			pHam->pImageDead = ISHELL_LoadResImage(pMe->m_pIShell, HAMLET_RES_FILE, IMG_POLONIUS3);
-			break;
-		case MENUID_KENNY:
-			pHam->pImageDead = ISHELL_LoadResImage(pMe->m_pIShell, HAMLET_RES_FILE, IMG_KENNY3);
-			break;
-		case MENUID_SPLINTER:
-			pHam->pImageDead = ISHELL_LoadResImage(pMe->m_pIShell, HAMLET_RES_FILE, IMG_SPLINTER3);
-			break;
+		Hamlet_PrefetchMenu(pHam, HamletMenu_GetSel(&pHam->menu));
+	}
+	else if(!bRestart && pHam->nBranch >= MENUID_POLONIUS && pHam->nBranch <= MENUID_SPLINTER)
+	{
+		for(i = 0; i < pHam->nFrame; i++)
+		{
+			if(gStory[i].nKind == FRAME_MENU)
+			{	Hamlet_PrefetchBranch(pHam);	}
+		}
 	}
 
-	Hamlet_DrawScenery(pHam);		//draw the scenerary (background behind wall)
-	Hamlet_DrawCharacters(pHam);	//draw the characters
-	IDISPLAY_Update(pHam->a.m_pIDisplay);	//update all drawings
+	if(pSnap->nFlags & HAMLET_STATE_TIMED)
+	{
+		HamletTiming_Start(&pHam->timing);
+		ISHELL_SetTimer(pMe->m_pIShell, HamletTiming_Schedule(&pHam->timing, pSnap->dwRemaining), (PFNNOTIFY)Hamlet_NextFrame, pHam);
+	}
+	pSnap->dwMagic = 0;	//used up
+}
 
-	//go to next screen
-	ISHELL_SetTimer(pMe->m_pIShell, LEVEL6_DELAY, (PFNNOTIFY)Hamlet_Timer, pHam);
-	pHam->nLevel = 7;
+//the file may be left by another build or be damaged; nothing in it is used unless all of it fits this story
+boolean Hamlet_CheckSnapshot(const HamletSnapshot* pSnap)
+{
+	if(pSnap->dwMagic != HAMLET_STATE_MAGIC || pSnap->nFrame >= STORY_FRAMES)
+	{	return FALSE;	}
+	if(pSnap->nBranch > MENUID_SPLINTER || pSnap->nLevel != Hamlet_LevelAfter(pSnap->nFrame))
+	{	return FALSE;	}
+
+	//0 is a set piece not loaded yet, or no text box
+	if(pSnap->wBack && !Hamlet_IsOneOf(pSnap->wBack, gBacks, sizeof(gBacks)/sizeof(gBacks[0])))
+	{	return FALSE;	}
+	if(pSnap->wWall && !Hamlet_IsOneOf(pSnap->wWall, gWalls, sizeof(gWalls)/sizeof(gWalls[0])))
+	{	return FALSE;	}
+	if(pSnap->wText && !Hamlet_IsOneOf(pSnap->wText, gTextIDs, sizeof(gTextIDs)/sizeof(gTextIDs[0])))
+	{	return FALSE;	}
+	return TRUE;
 }
 
-//conclusion
-void Hamlet_BuildLevel7(Hamlet* pHam)
-{
-	AEEApplet * pMe = &pHam->a;
+//the level the next timer or EVT_COMMAND starts; past the last frame, one that does not exist
+int Hamlet_LevelAfter(int nFrame)
+{
+	return (nFrame + 1 < STORY_FRAMES) ? gStory[nFrame + 1].nLevel : gStory[nFrame].nLevel + 1;
+}
 
-	IDISPLAY_ClearScreen(pMe->m_pIDisplay);
+boolean Hamlet_IsOneOf(uint16 wID, const uint16* pwIDs, int nCount)
+{
+	int i;
 
-	switch(pHam->nBranch)
+	for(i = 0; i < nCount; i++)
 	{
-		case MENUID_POLONIUS:
-			Hamlet_DrawScenery(pHam);		//draw the scenerary (background behind wall)
-			Hamlet_DrawCharacters(pHam);	//draw the characters
-			pHam->pImageBastard = ISHELL_LoadResImage(pMe->m_pIShell, HAMLET_RES_FILE, IMG_TEARDROPS);
-			IIMAGE_SetParm(pHam->pImageBastard, IPARM_ROP, AEE_RO_TRANSPARENT, 0 );
-			IIMAGE_Draw(pHam->pImageBastard, 69, 38);
-			break;
-		case MENUID_KENNY:
-			pHam->pImageBastard = ISHELL_LoadResImage(pMe->m_pIShell, HAMLET_RES_FILE, IMG_STANKYLE);
-			IIMAGE_Draw(pHam->pImageBastard, 0, 0);
-			break;
-		case MENUID_SPLINTER:
-			pHam->pImageBastard = ISHELL_LoadResImage(pMe->m_pIShell, HAMLET_RES_FILE, IMG_TURTLES);
-			IIMAGE_Draw(pHam->pImageBastard, 0, 0);
-			break;
+		if(pwIDs[i] == wID)
+		{	return TRUE;	}
 	}
-
-	IDISPLAY_Update(pHam->a.m_pIDisplay);	//update all drawings
-
-	//static text box
-	Hamlet_BuildStatic(pHam);
-
-	//go to next screen
-	ISHELL_SetTimer(pMe->m_pIShell, LEVEL7_DELAY, (PFNNOTIFY)Hamlet_Timer, pHam);
-	pHam->nLevel = 8;
+	return FALSE;
 }
 
-//the static textbox to be used for levels 3, 5, 6, 7
-void Hamlet_BuildStatic(Hamlet* pHam)
+//stages the layers the scene frames up to pHam->nFrame leave behind, out of the cache and without drawing
+void Hamlet_RestoreScene(Hamlet* pHam)
 {
-	AEERect qrc;
-	AECHAR szTitle[32];
-	int textSelect = 0;
+	const HamletFrame* pFrame;
+	const HamletProp* pProp;
+	int i;
 
-	if(pHam->pIStatic == NULL)
-	{
-		ISHELL_CreateInstance(pHam->a.m_pIShell, AEECLSID_STATIC, (void **)&pHam->pIStatic);	
-
-		//make dimensions of the control take up the lower half of screen
-		qrc.x	= 3;
-		qrc.y	= 85;
-		qrc.dx	= pHam->di.cxScreen;
-		qrc.dy	= pHam->di.cyScreen;
+	if(gStory[pHam->nFrame].nKind == FRAME_SCENE || gStory[pHam->nFrame].nKind == FRAME_MENU)
+	{	Hamlet_FinishLoading(pHam);		}
 
-		ISTATIC_SetRect(pHam->pIStatic, &qrc);	//lower half of screen
+	for(i = 0; i <= pHam->nFrame; i++)
+	{
+		pFrame = &gStory[i];
+		if(pFrame->nKind == FRAME_MENU && i < pHam->nFrame)
+		{
+			//past the menu: the rest of the branch is decoded up front, as EVT_COMMAND does
+			Hamlet_PrefetchBranch(pHam);
+		}
+		if(pFrame->nKind == FRAME_SCENE || pFrame->nKind == FRAME_MENU)
+		{
+			pProp = &pFrame->prop[Hamlet_Branch(pHam)];
+			Hamlet_StageScene(pHam, pFrame->nLayer, pFrame->wHide, pProp->wImage, pProp->x, pProp->y, (pProp->wFlags & PROP_COVER) != 0);
+		}
 	}
+}
 
-	//load up title text in our title character array
-	ISHELL_LoadResString(pHam->a.m_pIShell, HAMLET_RES_FILE, STAT_TITLE, szTitle, sizeof(szTitle));		 
+//puts frame pHam->nFrame back on a screen something else has drawn over, text box and menu included
+void Hamlet_RedrawFrame(Hamlet* pHam)
+{
+	const HamletFrame* pFrame = &gStory[pHam->nFrame];
+	const HamletProp* pProp = &pFrame->prop[Hamlet_Branch(pHam)];
+	uint16 wText = pHam->wText;
 
-	//load up our text in a global buffer
-	switch(pHam->nLevel)
+	IDISPLAY_ClearScreen(pHam->a.m_pIDisplay);
+	pHam->wText = 0;
+	switch(pFrame->nKind)
 	{
-		case 3:
-			textSelect = TEXT_LEVEL3;
+		case FRAME_LOGO:
+			Hamlet_ShowLogo(pHam, pProp->wImage, pProp->x, pProp->y);
 			break;
-		case 5:
-			textSelect = TEXT_LEVEL5;
+		case FRAME_INSTRUCTIONS:
+			Hamlet_ShowInstructions(pHam);
 			break;
-		case 6:
-			switch(pHam->nBranch)
-			{
-				case MENUID_POLONIUS:
-					textSelect = TEXT_LEVEL6_POLONIUS;
-					break;
-				case MENUID_KENNY:
-					textSelect = TEXT_LEVEL6_KENNY;
-					break;
-				case MENUID_SPLINTER:
-					textSelect = TEXT_LEVEL6_SPLINTER;
-					break;
-			}
-			break;
-		case 7:
-			switch(pHam->nBranch)
-			{
-				case MENUID_POLONIUS:
-					textSelect = TEXT_LEVEL7_POLONIUS;
-					break;
-				case MENUID_KENNY:
-					textSelect = TEXT_LEVEL7_KENNY;
-					break;
-				case MENUID_SPLINTER:
-					textSelect = TEXT_LEVEL7_SPLINTER;
-					break;
-			}
+		default:
+			HamletCompositor_InvalidateAll(&pHam->compositor);
+			HamletCompositor_Flush(&pHam->compositor);
 			break;
 	}
-	ISHELL_LoadResString(pHam->a.m_pIShell, HAMLET_RES_FILE, textSelect, pHam->szTextBuf, sizeof(pHam->szTextBuf));
-	EndlinizeString(pHam->szTextBuf);
-	
-	ISTATIC_SetText(pHam->pIStatic, szTitle, pHam->szTextBuf, AEE_FONT_BOLD, AEE_FONT_NORMAL);
-		
-	//draw control
-	ISTATIC_Redraw(pHam->pIStatic);
+
+	if(wText)
+	{
+		Hamlet_BuildStatic(pHam, wText);
+	}
+	if(pFrame->nKind == FRAME_MENU)
+	{
+		if(pHam->menu.bActive)
+		{	HamletMenu_Redraw(&pHam->menu);	}
+		else
+		{	Hamlet_BuildMenu(pHam);	}
+	}
 }
 
-//turns '^' into '\n'
-void EndlinizeString(AECHAR* str)
+//the static textbox to be used for levels 3, 5, 6, 7; laid out like the IStatic it replaces, bold title over the text
+void Hamlet_BuildStatic(Hamlet* pHam, uint16 wTextID)
 {
-	int index = -1;
-	while(str[++index]!='\0')
+	const HamletTextLayout* pTitle;
+	const HamletTextLayout* pText = NULL;
+	AEERect qrc;
+	AEERect rcLines;
+
+	//the box already says it, so there is nothing to draw or push
+	if(wTextID == pHam->wText)
+	{	return;		}
+
+	//the rest of the screen below the scene; as wide as the layout, so the lines break where they always did
+	qrc.x	= pHam->spots[SPOT_TEXTBOX].x;
+	qrc.y	= pHam->spots[SPOT_TEXTBOX].y;
+	qrc.dx	= (int16)Hamlet_LayoutSize(pHam, LAYOUT_CX);
+	qrc.dy	= pHam->di.cyScreen - qrc.y;
+
+	//a pixel in from either side, the title on its own line
+	rcLines.x	= (int16)(qrc.x + 1);
+	rcLines.y	= qrc.y;
+	rcLines.dx	= (int16)(qrc.dx - 2);
+	rcLines.dy	= (int16)IDISPLAY_GetFontMetrics(pHam->a.m_pIDisplay, AEE_FONT_BOLD, NULL, NULL);
+	pTitle = HamletText_Layout(&pHam->glyphs, STAT_TITLE, AEE_FONT_BOLD, &rcLines);
+	if(pTitle)
 	{
-		if(str[index] == '^')
-		{
-			str[index] = '\n';
-		}
+		rcLines.y	= pTitle->yEnd;
+		rcLines.dy	= (int16)(qrc.y + qrc.dy - rcLines.y);
+		pText = HamletText_Layout(&pHam->glyphs, wTextID, AEE_FONT_NORMAL, &rcLines);
 	}
+
+	IDISPLAY_EraseRect(pHam->a.m_pIDisplay, &qrc);
+	if(pTitle)
+	{	HamletText_Draw(&pHam->glyphs, pTitle);	}
+	if(pText)
+	{	HamletText_Draw(&pHam->glyphs, pText);	}
+	IDISPLAY_Update(pHam->a.m_pIDisplay);
+	pHam->wText = wTextID;
 }
 
 void Hamlet_BuildMenu(Hamlet* pHam)
 {
 	AEERect qrc;
-	//make dimensions of the control take up the entire screen
-	qrc.x	= 0;
-	qrc.y	= 85;
-	qrc.dx	= pHam->di.cxScreen;
-	qrc.dy	= pHam->di.cyScreen;
+	//make dimensions of the control take up the rest of the screen below the scene, under the layout
+	qrc.x	= pHam->spots[SPOT_MENU].x;
+	qrc.y	= pHam->spots[SPOT_MENU].y;
+	qrc.dx	= (int16)Hamlet_LayoutSize(pHam, LAYOUT_CX);
+	qrc.dy	= pHam->di.cyScreen - qrc.y;
 	
-	//create the menu
-	if(pHam->pIMenu == NULL)
+	//the rows are rendered on the first pass only; after that this just brings the menu back
+	HamletMenu_Build(&pHam->menu, &qrc, STR_MENUTITLE, gMenuItems, sizeof(gMenuItems)/sizeof(gMenuItems[0]));
+	HamletMenu_SetActive(&pHam->menu, TRUE);
+
+	//the first item comes up highlighted
+	Hamlet_PrefetchMenu(pHam, HamletMenu_GetSel(&pHam->menu));
+}
+
+//swaps the set pieces for others out of the cache; picking the one that is up already changes nothing
+void Hamlet_SetScenery(Hamlet* pHam, uint16 wBack, uint16 wWall)
+{
+	if(wBack && (wBack != pHam->wBack || pHam->pImageBack == NULL))
 	{
-		ISHELL_CreateInstance(pHam->a.m_pIShell, AEECLSID_MENUCTL, (void **)&pHam->pIMenu);
+		if(pHam->pImageBack)	{	IIMAGE_Release(pHam->pImageBack);		}
+		pHam->pImageBack = HamletCache_Get(&pHam->imageCache, wBack);
+		pHam->wBack = wBack;
 	}
+	if(wWall && (wWall != pHam->wWall || pHam->pImageWall == NULL))
+	{
+		if(pHam->pImageWall)	{	IIMAGE_Release(pHam->pImageWall);		}
+		pHam->pImageWall = HamletCache_Get(&pHam->imageCache, wWall);
+		pHam->wWall = wWall;
+	}
+}
 
-	IMENUCTL_SetRect(pHam->pIMenu, &qrc);	//lower half of screen
+//puts up the last set pieces picked since the previous tick, with one repaint however many keys were pressed
+void Hamlet_SceneryTick(Hamlet* pHam)
+{
+	Hamlet_TakePendingScenery(pHam);
 
-	//set up the menu
-	IMENUCTL_SetTitle(pHam->pIMenu, HAMLET_RES_FILE, STR_MENUTITLE, NULL);
+	//update only at correct levels: note nLevel is set to the next level
+	if(pHam->nLevel >= 4 && pHam->nLevel <= 7)
+	{
+		Hamlet_DrawScenery(pHam);
+		Hamlet_DrawCharacters(pHam);
+		HamletCompositor_Flush(&pHam->compositor);	//only the swapped set piece is repainted
+	}
+}
 
-	//Add in our menu items
-	IMENUCTL_AddItem(pHam->pIMenu, HAMLET_RES_FILE, STR_POLONIUS, MENUID_POLONIUS, NULL, 0);
-	IMENUCTL_AddItem(pHam->pIMenu, HAMLET_RES_FILE, STR_KENNY, MENUID_KENNY, NULL, 0);
-	IMENUCTL_AddItem(pHam->pIMenu, HAMLET_RES_FILE, STR_SPLINTER, MENUID_SPLINTER, NULL, 0);
+//makes the pending choices the set pieces, without drawing; the tick is not needed after that
+void Hamlet_TakePendingScenery(Hamlet* pHam)
+{
+	if(pHam->wPendingBack == 0 && pHam->wPendingWall == 0)
+	{	return;		}
 
-	IMENUCTL_SetActive(pHam->pIMenu,TRUE);
+	ISHELL_CancelTimer(pHam->a.m_pIShell, (PFNNOTIFY)Hamlet_SceneryTick, pHam);
+	Hamlet_SetScenery(pHam, pHam->wPendingBack, pHam->wPendingWall);
+	pHam->wPendingBack = 0;
+	pHam->wPendingWall = 0;
 }
 
-//draws the background and the wall
+//places the background and the wall
 void Hamlet_DrawScenery(Hamlet* pHam)
 {
-	IIMAGE_Draw(pHam->pImageBack, 85, 25);
-	IIMAGE_SetParm(pHam->pImageWall, IPARM_ROP, AEE_RO_TRANSPARENT, 0 );
-	IIMAGE_Draw(pHam->pImageWall, 0, 0);
+	HamletCompositor_SetLayer(&pHam->compositor, LAYER_BACK, pHam->pImageBack, pHam->spots[SPOT_BACK].x, pHam->spots[SPOT_BACK].y, FALSE);
+	HamletCompositor_SetLayer(&pHam->compositor, LAYER_WALL, pHam->pImageWall, pHam->spots[SPOT_WALL].x, pHam->spots[SPOT_WALL].y, TRUE);
 }
 
-//draws hamlet and gertrude
+//places hamlet and gertrude; the props on top of them belong to the story frames
 void Hamlet_DrawCharacters(Hamlet* pHam)
 {
-	IIMAGE_Draw(pHam->pImageHamlet, 21, 42);
-	IIMAGE_Draw(pHam->pImageGertrude, 53, 27);
-	if(pHam->nLevel == 5 || pHam->nLevel == 6)
-	{
-		IIMAGE_SetParm(pHam->pImageSword, IPARM_ROP, AEE_RO_TRANSPARENT, 0);
-		IIMAGE_Draw(pHam->pImageSword, 5, 52);
-	}
-	
-	if(pHam->nLevel == 6 || (pHam->nLevel > 6 && pHam->nBranch == MENUID_POLONIUS))
-	{
-		IIMAGE_SetParm(pHam->pImageDead, IPARM_ROP, AEE_RO_TRANSPARENT, 0);
-		IIMAGE_Draw(pHam->pImageDead, 0, 37);
-	}
-}
\ No newline at end of file
+	HamletCompositor_SetLayer(&pHam->compositor, LAYER_HAMLET, pHam->pImageHamlet, pHam->spots[SPOT_HAMLET].x, pHam->spots[SPOT_HAMLET].y, TRUE);
+	HamletCompositor_SetLayer(&pHam->compositor, LAYER_GERTRUDE, pHam->pImageGertrude, pHam->spots[SPOT_GERTRUDE].x, pHam->spots[SPOT_GERTRUDE].y, TRUE);
+}
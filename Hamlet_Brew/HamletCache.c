@@ -0,0 +1,463 @@
+/*===========================================================================
+
+FILE: HamletCache.c
+===========================================================================*/
+
+
+/*===============================================================================
+INCLUDES AND VARIABLE DEFINITIONS
+=============================================================================== */
+#include "AEEShell.h"           // Shell interface definitions
+#include "AEEStdLib.h"          // MEMSET etc.
+#include "AEEBitmap.h"          // offscreen bitmaps
+
+#include "HamletCache.h"
+
+static uint16 HamletCache_Atlas(HamletImageCache* pCache, uint16 wResID);
+static IImage* HamletCache_Find(HamletImageCache* pCache, uint16 wResID);
+static boolean HamletCache_Insert(HamletImageCache* pCache, uint16 wResID, IImage* pImage);
+static IBitmap* HamletCache_Scale(HamletImageCache* pCache, HamletCacheEntry* pEntry);
+static IBitmap* HamletCache_ScaleFrames(HamletImageCache* pCache, HamletCacheEntry* pEntry);
+static void HamletCache_ScaledFrame(HamletImageCache* pCache, const HamletCacheEntry* pEntry, int nFrame, AEERect* prc);
+static int HamletCache_ScaleSize(HamletImageCache* pCache, int n);
+static void HamletCache_Decoded(void* pUser, IImage* pImage, AEEImageInfo* pi, int nErr);
+static void HamletCache_EndJob(HamletImageCache* pCache);
+
+/*===============================================================================
+FUNCTION DEFINITIONS
+=============================================================================== */
+
+//empty cache that loads out of the resource bundle
+void HamletCache_Init(HamletImageCache* pCache, HamletResIndex* pRes, IDisplay* pIDisplay)
+{
+	MEMSET(pCache, 0, sizeof(HamletImageCache));
+	pCache->pRes = pRes;
+	pCache->pIDisplay = pIDisplay;
+	pCache->nScaleNum = 1;
+	pCache->nScaleDen = 1;
+}
+
+//images decoded from now on are drawn nNum/nDen times their size
+void HamletCache_SetScale(HamletImageCache* pCache, int nNum, int nDen)
+{
+	if(nNum > 0 && nDen > 0)
+	{
+		pCache->nScaleNum = nNum;
+		pCache->nScaleDen = nDen;
+	}
+}
+
+//decodes every image in the list up front, returns how many are resident
+int HamletCache_Preload(HamletImageCache* pCache, const uint16* pwResIDs, int nCount)
+{
+	int i;
+	int nLoaded = 0;
+	IImage* pImage;
+
+	for(i = 0; i < nCount; i++)
+	{
+		pImage = HamletCache_Get(pCache, pwResIDs[i]);
+		if(pImage)
+		{
+			IIMAGE_Release(pImage);
+			nLoaded++;
+		}
+	}
+	return nLoaded;
+}
+
+//hands out a reference to the decoded image, decoding it only on the first request
+IImage* HamletCache_Get(HamletImageCache* pCache, uint16 wResID)
+{
+	IImage* pImage;
+
+	wResID = HamletCache_Atlas(pCache, wResID);
+
+	//wanted before the decoder is done with it: no telling how long that takes, so it is decoded here instead
+	if(pCache->job.wResID == wResID)
+	{	HamletCache_CancelDecode(pCache);	}
+
+	pImage = HamletCache_Find(pCache, wResID);
+
+	if(pImage)
+	{
+		IIMAGE_AddRef(pImage);
+		return pImage;
+	}
+
+	//first request: decode it and keep the cache's own reference
+	pImage = HamletRes_LoadImage(pCache->pRes, wResID);
+	if(pImage && HamletCache_Insert(pCache, wResID, pImage))
+	{
+		IIMAGE_AddRef(pImage);
+	}
+	return pImage;
+}
+
+//the image wResID is drawn out of, and where in it; the whole image unless wResID is a frame of an atlas
+IImage* HamletCache_GetFrame(HamletImageCache* pCache, uint16 wResID, AEERect* prcFrame)
+{
+	const HamletPakFrame* pFrame = HamletRes_GetFrame(pCache->pRes, wResID);
+	AEEImageInfo info;
+	IImage* pImage;
+
+	pImage = HamletCache_Get(pCache, wResID);
+	if(pImage && pFrame)
+	{
+		prcFrame->x = pFrame->x;
+		prcFrame->y = pFrame->y;
+		prcFrame->dx = (int16)pFrame->cx;
+		prcFrame->dy = (int16)pFrame->cy;
+	}
+	else if(pImage)
+	{
+		IIMAGE_GetInfo(pImage, &info);
+		prcFrame->x = 0;
+		prcFrame->y = 0;
+		prcFrame->dx = (int16)info.cx;
+		prcFrame->dy = (int16)info.cy;
+	}
+	return pImage;
+}
+
+boolean HamletCache_Has(HamletImageCache* pCache, uint16 wResID)
+{
+	wResID = HamletCache_Atlas(pCache, wResID);
+	return pCache->job.wResID == wResID || HamletCache_Find(pCache, wResID) != NULL;
+}
+
+uint16 HamletCache_Decoding(HamletImageCache* pCache)
+{
+	return pCache->job.wResID;
+}
+
+//starts decoding the image in the background; one that is already cached needs nothing
+boolean HamletCache_DecodeAsync(HamletImageCache* pCache, uint16 wResID)
+{
+	HamletCacheJob* pJob = &pCache->job;
+	IShell* pIShell = pCache->pRes->pIShell;
+	const byte* pData;
+	uint32 dwSize;
+
+	wResID = HamletCache_Atlas(pCache, wResID);
+	if(pJob->wResID == wResID || HamletCache_Find(pCache, wResID))
+	{	return TRUE;	}
+	if(pCache->nCount >= HAMLET_CACHE_SIZE)
+	{	return FALSE;	}
+
+	//one job at a time, the one before is no longer the next image wanted
+	HamletCache_EndJob(pCache);
+
+	pData = HamletRes_GetImageData(pCache->pRes, wResID, &dwSize);
+	if(pData == NULL || dwSize == 0)
+	{	return FALSE;	}
+
+	if(ISHELL_CreateInstance(pIShell, AEECLSID_PNG, (void **)&pJob->pImage) != SUCCESS)
+	{	return FALSE;	}
+	if(ISHELL_CreateInstance(pIShell, AEECLSID_MEMASTREAM, (void **)&pJob->pStream) != SUCCESS)
+	{
+		HamletCache_EndJob(pCache);
+		return FALSE;
+	}
+
+	//every byte is readable from the start, the decoder takes them at its own pace and says when it is done
+	pJob->wResID = wResID;
+	IMEMASTREAM_SetEx(pJob->pStream, (byte*)pData, dwSize, 0, NULL, NULL);
+	IIMAGE_Notify(pJob->pImage, HamletCache_Decoded, pCache);
+	IIMAGE_SetStream(pJob->pImage, (IAStream*)pJob->pStream);
+	return TRUE;
+}
+
+void HamletCache_CancelDecode(HamletImageCache* pCache)
+{
+	HamletCache_EndJob(pCache);
+}
+
+//the decoder's notify: the image is ready, or it never will be; the job's objects are let go later, not from inside their own callback
+static void HamletCache_Decoded(void* pUser, IImage* pImage, AEEImageInfo* pi, int nErr)
+{
+	HamletImageCache* pCache = (HamletImageCache*)pUser;
+	HamletCacheJob* pJob = &pCache->job;
+
+	(void)pi;
+	if(nErr == SUCCESS && HamletCache_Insert(pCache, pJob->wResID, pImage))
+	{	pJob->pImage = NULL;	}	//the cache's reference now
+	pJob->wResID = 0;	//cached, or HamletCache_Get decodes it itself
+}
+
+//lets go of what the job still holds; an image that never finished is dropped
+static void HamletCache_EndJob(HamletImageCache* pCache)
+{
+	HamletCacheJob* pJob = &pCache->job;
+
+	if(pJob->pImage)
+	{	IIMAGE_Release(pJob->pImage);	}
+	if(pJob->pStream)
+	{	IMEMASTREAM_Release(pJob->pStream);	}
+	MEMSET(pJob, 0, sizeof(HamletCacheJob));
+}
+
+//the run-length form of a cached image, for drawing it with AEE_RO_TRANSPARENT
+const HamletSprite* HamletCache_GetSprite(HamletImageCache* pCache, IImage* pImage)
+{
+	int i;
+
+	for(i = 0; i < pCache->nCount; i++)
+	{
+		if(pCache->entries[i].pImage == pImage)
+		{	return pCache->entries[i].sprite.pRows ? &pCache->entries[i].sprite : NULL;	}
+	}
+	return NULL;
+}
+
+//the device-sized copy of a cached image, and where the part of it prcFrame has of the image went
+IBitmap* HamletCache_GetScaled(HamletImageCache* pCache, IImage* pImage, const AEERect* prcFrame, AEERect* prcScaled)
+{
+	const HamletCacheEntry* pEntry;
+	int i;
+	int n;
+
+	for(i = 0; i < pCache->nCount; i++)
+	{
+		pEntry = &pCache->entries[i];
+		if(pEntry->pImage != pImage || pEntry->pScaled == NULL)
+		{	continue;	}
+
+		prcScaled->x = 0;
+		prcScaled->y = 0;
+		prcScaled->dx = (int16)pEntry->cxScaled;
+		prcScaled->dy = (int16)pEntry->cyScaled;
+		for(n = 0; n < pEntry->nFrames; n++)
+		{
+			if(pEntry->pFrames[n].x == prcFrame->x && pEntry->pFrames[n].y == prcFrame->y)
+			{
+				HamletCache_ScaledFrame(pCache, pEntry, n, prcScaled);
+				break;
+			}
+		}
+		return pEntry->pScaled;
+	}
+	return NULL;
+}
+
+//drops the cache's own references; images still held by the applet stay alive until released
+void HamletCache_Free(HamletImageCache* pCache)
+{
+	int i;
+
+	HamletCache_EndJob(pCache);
+
+	for(i = 0; i < pCache->nCount; i++)
+	{
+		if(pCache->entries[i].pImage)
+		{	IIMAGE_Release(pCache->entries[i].pImage);	}
+		if(pCache->entries[i].pScaled)
+		{	IBITMAP_Release(pCache->entries[i].pScaled);	}
+		HamletSprite_Free(&pCache->entries[i].sprite);
+	}
+	pCache->nCount = 0;
+}
+
+//what the cache keeps wResID in: its atlas, or the image itself
+static uint16 HamletCache_Atlas(HamletImageCache* pCache, uint16 wResID)
+{
+	const HamletPakFrame* pFrame = HamletRes_GetFrame(pCache->pRes, wResID);
+
+	return pFrame ? pFrame->wAtlasID : wResID;
+}
+
+static IImage* HamletCache_Find(HamletImageCache* pCache, uint16 wResID)
+{
+	int i;
+
+	for(i = 0; i < pCache->nCount; i++)
+	{
+		if(pCache->entries[i].wResID == wResID)
+		{	return pCache->entries[i].pImage;	}
+	}
+	return NULL;
+}
+
+//when the table is full the image is not kept and the caller ends up as its only owner
+static boolean HamletCache_Insert(HamletImageCache* pCache, uint16 wResID, IImage* pImage)
+{
+	HamletCacheEntry* pEntry;
+
+	if(pCache->nCount >= HAMLET_CACHE_SIZE)
+	{	return FALSE;	}
+
+	pEntry = &pCache->entries[pCache->nCount++];
+	pEntry->wResID = wResID;
+	pEntry->pImage = pImage;
+	pEntry->pFrames = HamletRes_GetAtlas(pCache->pRes, wResID, &pEntry->nFrames);
+
+	//opaque images, or a display the sprites cannot render into, just go without one
+	if(pCache->nScaleNum == pCache->nScaleDen)
+	{
+		HamletSprite_Build(&pEntry->sprite, pCache->pIDisplay, pImage, &pCache->palette);
+		return TRUE;
+	}
+
+	//the scaled copy holds the key color where the image is transparent, just what a sprite is cut from
+	pEntry->pScaled = pEntry->pFrames ? HamletCache_ScaleFrames(pCache, pEntry) : HamletCache_Scale(pCache, pEntry);
+	if(pEntry->pScaled)
+	{	HamletSprite_BuildFromBitmap(&pEntry->sprite, pEntry->pScaled, &pCache->palette);	}
+	return TRUE;
+}
+
+//renders the entry's image once at its on-screen size into a bitmap of its own
+static IBitmap* HamletCache_Scale(HamletImageCache* pCache, HamletCacheEntry* pEntry)
+{
+	IImage* pImage = pEntry->pImage;
+	AEEImageInfo info;
+	IBitmap* pDevice = NULL;
+	IBitmap* pScaled = NULL;
+	IBitmap* pOldDest = NULL;
+	int cx;
+	int cy;
+
+	IIMAGE_GetInfo(pImage, &info);
+	cx = HamletCache_ScaleSize(pCache, info.cx);
+	cy = HamletCache_ScaleSize(pCache, info.cy);
+
+	if(IDISPLAY_GetDeviceBitmap(pCache->pIDisplay, &pDevice) != SUCCESS)
+	{	return NULL;	}
+	IBITMAP_CreateCompatibleBitmap(pDevice, &pScaled, (uint16)cx, (uint16)cy);
+	IBITMAP_Release(pDevice);
+	if(pScaled == NULL)
+	{	return NULL;	}
+
+	IDISPLAY_GetDestination(pCache->pIDisplay, &pOldDest);
+	IDISPLAY_SetDestination(pCache->pIDisplay, pScaled);
+	IDISPLAY_SetClipRect(pCache->pIDisplay, NULL);
+	IIMAGE_SetParm(pImage, IPARM_SCALE, cx, cy);
+	IIMAGE_SetParm(pImage, IPARM_ROP, AEE_RO_COPY, 0);
+	IIMAGE_Draw(pImage, 0, 0);
+	IIMAGE_SetParm(pImage, IPARM_SCALE, info.cx, info.cy);	//anyone drawing the image itself gets it as decoded
+	IDISPLAY_SetDestination(pCache->pIDisplay, pOldDest);
+	IBITMAP_Release(pOldDest);
+
+	pEntry->cxScaled = (uint16)cx;
+	pEntry->cyScaled = (uint16)cy;
+	return pScaled;
+}
+
+//an atlas's frames each resized the way the image would be on its own, nearest pixel, in the atlas's row or column
+static IBitmap* HamletCache_ScaleFrames(HamletImageCache* pCache, HamletCacheEntry* pEntry)
+{
+	const HamletPakFrame* pFrame;
+	AEEImageInfo info;
+	AEERect rcAll;
+	AEERect rcFrame;
+	IBitmap* pDevice = NULL;
+	IBitmap* pCanvas = NULL;
+	IBitmap* pScaled = NULL;
+	IBitmap* pOldDest = NULL;
+	IDIB* pIn = NULL;
+	IDIB* pOut = NULL;
+	byte* pRow;
+	int nBytes;
+	int cx = 1;
+	int cy = 1;
+	int row;
+	int col;
+	int i;
+
+	for(i = 0; i < pEntry->nFrames; i++)
+	{
+		HamletCache_ScaledFrame(pCache, pEntry, i, &rcFrame);
+		cx = MAX(cx, rcFrame.x + rcFrame.dx);
+		cy = MAX(cy, rcFrame.y + rcFrame.dy);
+	}
+
+	//the atlas as decoded, to resize out of, and the copy with the key wherever no frame goes
+	IIMAGE_GetInfo(pEntry->pImage, &info);
+	if(IDISPLAY_GetDeviceBitmap(pCache->pIDisplay, &pDevice) != SUCCESS)
+	{	return NULL;	}
+	IBITMAP_CreateCompatibleBitmap(pDevice, &pCanvas, info.cx, info.cy);
+	IBITMAP_CreateCompatibleBitmap(pDevice, &pScaled, (uint16)cx, (uint16)cy);
+	IBITMAP_Release(pDevice);
+
+	if(pCanvas && pScaled)
+	{
+		rcAll.x = 0;
+		rcAll.y = 0;
+		rcAll.dx = (int16)cx;
+		rcAll.dy = (int16)cy;
+
+		IDISPLAY_GetDestination(pCache->pIDisplay, &pOldDest);
+		IDISPLAY_SetDestination(pCache->pIDisplay, pScaled);
+		IDISPLAY_SetClipRect(pCache->pIDisplay, NULL);
+		IDISPLAY_FillRect(pCache->pIDisplay, &rcAll, MAKE_RGB(0xFF, 0x00, 0xFF));
+		IDISPLAY_SetDestination(pCache->pIDisplay, pCanvas);
+		IIMAGE_SetParm(pEntry->pImage, IPARM_ROP, AEE_RO_COPY, 0);
+		IIMAGE_Draw(pEntry->pImage, 0, 0);
+		IDISPLAY_SetDestination(pCache->pIDisplay, pOldDest);
+		IBITMAP_Release(pOldDest);
+
+		IBITMAP_QueryInterface(pCanvas, AEECLSID_DIB, (void **)&pIn);
+		IBITMAP_QueryInterface(pScaled, AEECLSID_DIB, (void **)&pOut);
+	}
+
+	//whole pixels of one size in both, or there is no copy
+	if(pIn == NULL || pOut == NULL || pIn->nDepth != pOut->nDepth || (pIn->nDepth & 7))
+	{
+		if(pScaled)
+		{	IBITMAP_Release(pScaled);	}
+		pScaled = NULL;
+	}
+	else
+	{
+		nBytes = pIn->nDepth / 8;
+		for(i = 0; i < pEntry->nFrames; i++)
+		{
+			pFrame = &pEntry->pFrames[i];
+			HamletCache_ScaledFrame(pCache, pEntry, i, &rcFrame);
+			for(row = 0; row < rcFrame.dy; row++)
+			{
+				pRow = pIn->pBmp + (pFrame->y + row * pFrame->cy / rcFrame.dy) * pIn->nPitch + pFrame->x * nBytes;
+				for(col = 0; col < rcFrame.dx; col++)
+				{
+					MEMCPY(pOut->pBmp + (rcFrame.y + row) * pOut->nPitch + (rcFrame.x + col) * nBytes,
+						   pRow + (col * pFrame->cx / rcFrame.dx) * nBytes, nBytes);
+				}
+			}
+		}
+		IBITMAP_Invalidate(pScaled, &rcAll);
+		pEntry->cxScaled = (uint16)cx;
+		pEntry->cyScaled = (uint16)cy;
+	}
+
+	if(pIn)
+	{	IDIB_Release(pIn);		}
+	if(pOut)
+	{	IDIB_Release(pOut);		}
+	if(pCanvas)
+	{	IBITMAP_Release(pCanvas);	}
+	return pScaled;
+}
+
+//where frame nFrame of the atlas is in its scaled copy
+static void HamletCache_ScaledFrame(HamletImageCache* pCache, const HamletCacheEntry* pEntry, int nFrame, AEERect* prc)
+{
+	int i;
+
+	//each frame starts where the one before it ends, to its right or under it
+	prc->x = 0;
+	prc->y = 0;
+	for(i = 0; i < nFrame; i++)
+	{
+		if(pEntry->pFrames[i + 1].x > pEntry->pFrames[i].x)
+		{	prc->x = (int16)(prc->x + HamletCache_ScaleSize(pCache, pEntry->pFrames[i].cx));	}
+		else
+		{	prc->y = (int16)(prc->y + HamletCache_ScaleSize(pCache, pEntry->pFrames[i].cy));	}
+	}
+	prc->dx = (int16)HamletCache_ScaleSize(pCache, pEntry->pFrames[nFrame].cx);
+	prc->dy = (int16)HamletCache_ScaleSize(pCache, pEntry->pFrames[nFrame].cy);
+}
+
+//a width or height on screen, rounded the way the applet's layout is
+static int HamletCache_ScaleSize(HamletImageCache* pCache, int n)
+{
+	return MAX(1, (n * pCache->nScaleNum + pCache->nScaleDen / 2) / pCache->nScaleDen);
+}
@@ -0,0 +1,91 @@
+/*===========================================================================
+
+FILE: HamletCache.h
+===========================================================================*/
+#ifndef HAMLETCACHE_H
+#define HAMLETCACHE_H
+
+#include "AEEShell.h"           // Shell interface definitions
+#include "AEEBitmap.h"          // offscreen bitmaps
+#include "AEEMemAStream.h"      // the background decode's stream
+
+#include "HamletRes.h"
+#include "HamletSprite.h"
+
+/*-------------------------------------------------------------------
+Decoded image cache, keyed by resource ID. Every IMG_* resource is
+loaded and decoded at most once per session; callers get their own
+reference (IIMAGE_AddRef'd) and release it as they always did.
+Images with transparent pixels also get a run-length sprite, built
+right after the decode, for the compositor's transparent layers. The
+sprites keep palette indices, one palette for all of them. The decoded
+IImage stays in the cache next to its sprite: it is what callers hold
+and what the compositor falls back to drawing. So the indexed bundle
+only saves memory where the decoder keeps indexed PNGs at a byte per
+pixel, as the host's does; a handset decoder that expands them to the
+device depth holds as much as before, and only the sprites shrink.
+
+On a screen the story was not laid out for, HamletCache_SetScale
+makes every image get rendered once more, right after its decode, at
+the size it has on that screen. The compositor draws that copy (or
+the sprite built from it), so frames never pay for the scaling.
+
+A frame the bundle keeps in an atlas is asked for by its own ID like
+any other image; the cache decodes the atlas instead, once for all of
+its frames, and HamletCache_GetFrame says which rect of it the frame
+is. An atlas's scaled copy has each frame resized on its own, laid
+out the same way, so none of them bleeds into the next.
+
+One image at a time can be decoded in the background instead:
+HamletCache_DecodeAsync gives a decoder the whole image as a memory
+stream over the bundle and leaves the pacing to it, the way BREW's
+stream decoders work, and the image joins the cache when IIMAGE_Notify
+says it is done. Asking for it before then drops the job and decodes
+it on the spot, so nothing ever waits on the decoder. Starting another
+background decode in its place drops it too: the new one is what is
+wanted next.
+-------------------------------------------------------------------*/
+#define HAMLET_CACHE_SIZE 32	// there are 18 images in the bundle, 26 without the atlases
+
+typedef struct _HamletCacheEntry {
+	uint16		wResID;
+	IImage*		pImage;
+	HamletSprite	sprite;		// pRows is NULL for opaque images
+	IBitmap*	pScaled;		// the image at its size on screen, NULL when the cache does not scale
+	uint16		cxScaled;
+	uint16		cyScaled;
+	const HamletPakFrame*	pFrames;	// the frames cut out of it, NULL when it is no atlas
+	int			nFrames;
+} HamletCacheEntry;
+
+typedef struct _HamletCacheJob {
+	uint16		wResID;			// 0 while no background decode is under way
+	IImage*		pImage;			// the decoder, it joins the cache once its notify comes
+	IMemAStream*	pStream;	// the encoded image, a view into the bundle
+} HamletCacheJob;
+
+typedef struct _HamletImageCache {
+	HamletResIndex*		pRes;
+	IDisplay*			pIDisplay;		// the sprites are rendered through it
+	int					nScaleNum;		// on-screen size over decoded size, 1/1 by default
+	int					nScaleDen;
+	int					nCount;
+	HamletCacheEntry	entries[HAMLET_CACHE_SIZE];
+	HamletPalette		palette;		// the sprites' colors
+	HamletCacheJob		job;
+} HamletImageCache;
+
+void	HamletCache_Init(HamletImageCache* pCache, HamletResIndex* pRes, IDisplay* pIDisplay);
+void	HamletCache_SetScale(HamletImageCache* pCache, int nNum, int nDen);	//before the first image is loaded
+int		HamletCache_Preload(HamletImageCache* pCache, const uint16* pwResIDs, int nCount);
+IImage*	HamletCache_Get(HamletImageCache* pCache, uint16 wResID);	//caller releases; for a frame, its whole atlas
+IImage*	HamletCache_GetFrame(HamletImageCache* pCache, uint16 wResID, AEERect* prcFrame);	//the same, and the part of it that is wResID
+boolean	HamletCache_Has(HamletImageCache* pCache, uint16 wResID);	//cached, or being decoded in the background
+uint16	HamletCache_Decoding(HamletImageCache* pCache);	//the image being decoded in the background, 0 for none
+boolean	HamletCache_DecodeAsync(HamletImageCache* pCache, uint16 wResID);	//FALSE when it cannot be started
+void	HamletCache_CancelDecode(HamletImageCache* pCache);	//drops the background decode, its image is not cached
+const HamletSprite* HamletCache_GetSprite(HamletImageCache* pCache, IImage* pImage);	//NULL when it has none
+IBitmap* HamletCache_GetScaled(HamletImageCache* pCache, IImage* pImage, const AEERect* prcFrame, AEERect* prcScaled);	//NULL when it is drawn as it is
+void	HamletCache_Free(HamletImageCache* pCache);
+
+#endif // HAMLETCACHE_H
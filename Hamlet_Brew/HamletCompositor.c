@@ -0,0 +1,345 @@
+/*===========================================================================
+
+FILE: HamletCompositor.c
+===========================================================================*/
+
+
+/*===============================================================================
+INCLUDES AND VARIABLE DEFINITIONS
+=============================================================================== */
+#include "AEEShell.h"           // Shell interface definitions
+#include "AEEStdLib.h"          // MEMSET etc.
+
+#include "HamletCompositor.h"
+
+static boolean	HamletRect_Intersect(AEERect* prcOut, const AEERect* prcA, const AEERect* prcB);
+static void		HamletRect_Union(AEERect* prcOut, const AEERect* prcA, const AEERect* prcB);
+static int32	HamletRect_Area(const AEERect* prc);
+static void		HamletCompositor_InvalidateLayer(HamletCompositor* pComp, int nLayer);
+static IDIB*	HamletCompositor_GetTarget(HamletCompositor* pComp, IBitmap** ppDest);
+static void		HamletCompositor_DrawLayers(HamletCompositor* pComp, int nFirst, int nEnd, const AEERect* prcClip, int xOrigin, int yOrigin);
+static void		HamletCompositor_BuildStatic(HamletCompositor* pComp);
+
+/*===============================================================================
+FUNCTION DEFINITIONS
+=============================================================================== */
+
+//empty stack, everything inside prcBounds belongs to the compositor
+void HamletCompositor_Init(HamletCompositor* pComp, IDisplay* pIDisplay, HamletImageCache* pCache, const AEERect* prcBounds, int nStaticLayers)
+{
+	IBitmap* pDevice = NULL;
+
+	MEMSET(pComp, 0, sizeof(HamletCompositor));
+	pComp->pIDisplay = pIDisplay;
+	pComp->pCache = pCache;
+	pComp->rcBounds = *prcBounds;
+	pComp->nStaticLayers = nStaticLayers;
+
+	//without the offscreen bitmap every flush just draws all the layers
+	if(IDISPLAY_GetDeviceBitmap(pIDisplay, &pDevice) == SUCCESS)
+	{
+		IBITMAP_CreateCompatibleBitmap(pDevice, &pComp->pStatic, prcBounds->dx, prcBounds->dy);
+		IBITMAP_Release(pDevice);
+	}
+}
+
+void HamletCompositor_Free(HamletCompositor* pComp)
+{
+	if(pComp->pStatic)
+	{
+		IBITMAP_Release(pComp->pStatic);
+		pComp->pStatic = NULL;
+	}
+}
+
+//puts an image on a layer; only a real change (image, position or rop) dirties anything
+void HamletCompositor_SetLayer(HamletCompositor* pComp, int nLayer, IImage* pImage, int x, int y, boolean bTransparent)
+{
+	AEEImageInfo info;
+	AEERect rcAll;
+
+	if(pImage == NULL)
+	{
+		HamletCompositor_HideLayer(pComp, nLayer);
+		return;
+	}
+
+	IIMAGE_GetInfo(pImage, &info);
+	rcAll.x = 0;
+	rcAll.y = 0;
+	rcAll.dx = (int16)info.cx;
+	rcAll.dy = (int16)info.cy;
+	HamletCompositor_SetLayerFrame(pComp, nLayer, pImage, &rcAll, x, y, bTransparent);
+}
+
+//the same for the prcFrame part of the image, a frame of an atlas
+void HamletCompositor_SetLayerFrame(HamletCompositor* pComp, int nLayer, IImage* pImage, const AEERect* prcFrame, int x, int y, boolean bTransparent)
+{
+	HamletLayer* pLayer = &pComp->layers[nLayer];
+	IBitmap* pScaled;
+	AEERect rcSrc;
+
+	if(pImage == NULL)
+	{
+		HamletCompositor_HideLayer(pComp, nLayer);
+		return;
+	}
+	if(pLayer->pImage == pImage && pLayer->rc.x == x && pLayer->rc.y == y && pLayer->bTransparent == bTransparent
+		&& pLayer->rcFrame.x == prcFrame->x && pLayer->rcFrame.y == prcFrame->y)
+	{	return;		}
+
+	pScaled = HamletCache_GetScaled(pComp->pCache, pImage, prcFrame, &rcSrc);
+	if(pScaled == NULL)
+	{	rcSrc = *prcFrame;	}
+
+	if(nLayer < pComp->nStaticLayers)
+	{	pComp->bStaticValid = FALSE;	}
+
+	HamletCompositor_InvalidateLayer(pComp, nLayer);	//where it was
+	pLayer->pImage = pImage;
+	pLayer->rc.x = x;
+	pLayer->rc.y = y;
+	pLayer->rc.dx = rcSrc.dx;
+	pLayer->rc.dy = rcSrc.dy;
+	pLayer->rcFrame = *prcFrame;
+	pLayer->rcSrc = rcSrc;
+	pLayer->bTransparent = bTransparent;
+	pLayer->pSprite = bTransparent ? HamletCache_GetSprite(pComp->pCache, pImage) : NULL;
+	pLayer->pScaled = pScaled;
+	HamletCompositor_InvalidateLayer(pComp, nLayer);	//where it is now
+}
+
+void HamletCompositor_HideLayer(HamletCompositor* pComp, int nLayer)
+{
+	if(pComp->layers[nLayer].pImage)
+	{
+		if(nLayer < pComp->nStaticLayers)
+		{	pComp->bStaticValid = FALSE;	}
+
+		HamletCompositor_InvalidateLayer(pComp, nLayer);
+		pComp->layers[nLayer].pImage = NULL;
+	}
+}
+
+//adds a rect to the dirty list, merging it into anything it touches
+void HamletCompositor_Invalidate(HamletCompositor* pComp, const AEERect* prc)
+{
+	AEERect rc;
+	AEERect rcMerged;
+	int i;
+	int nBest = 0;
+	int32 nBestGrowth = 0x7FFFFFFF;
+	int32 nGrowth;
+
+	if(!HamletRect_Intersect(&rc, prc, &pComp->rcBounds))
+	{	return;		}
+
+	//fold in every rect that overlaps; repeat since the bigger rect may now reach others
+	i = 0;
+	while(i < pComp->nDirty)
+	{
+		if(HamletRect_Intersect(&rcMerged, &rc, &pComp->dirty[i]))
+		{
+			HamletRect_Union(&rc, &rc, &pComp->dirty[i]);
+			pComp->dirty[i] = pComp->dirty[--pComp->nDirty];
+			i = 0;
+		}
+		else
+		{	i++;	}
+	}
+
+	if(pComp->nDirty < HAMLET_MAX_DIRTY)
+	{
+		pComp->dirty[pComp->nDirty++] = rc;
+		return;
+	}
+
+	//list is full: grow whichever rect gets the least bigger
+	for(i = 0; i < pComp->nDirty; i++)
+	{
+		HamletRect_Union(&rcMerged, &rc, &pComp->dirty[i]);
+		nGrowth = HamletRect_Area(&rcMerged) - HamletRect_Area(&pComp->dirty[i]);
+		if(nGrowth < nBestGrowth)
+		{
+			nBestGrowth = nGrowth;
+			nBest = i;
+		}
+	}
+	HamletRect_Union(&pComp->dirty[nBest], &rc, &pComp->dirty[nBest]);
+}
+
+//the screen under us was cleared, so all of it has to come back
+void HamletCompositor_InvalidateAll(HamletCompositor* pComp)
+{
+	pComp->nDirty = 1;
+	pComp->dirty[0] = pComp->rcBounds;
+}
+
+//repaints the dirty rects bottom layer first, pushing each to the screen as soon as it is drawn
+boolean HamletCompositor_Flush(HamletCompositor* pComp)
+{
+	AEERect rcClip;
+	int i;
+
+	if(pComp->nDirty == 0)
+	{	return FALSE;	}
+
+	if(pComp->pStatic && !pComp->bStaticValid)
+	{
+		HamletCompositor_BuildStatic(pComp);
+	}
+
+	for(i = 0; i < pComp->nDirty; i++)
+	{
+		rcClip = pComp->dirty[i];
+		IDISPLAY_SetClipRect(pComp->pIDisplay, &rcClip);
+
+		if(pComp->pStatic)
+		{
+			//one opaque copy for everything below the sprites
+			IDISPLAY_BitBlt(pComp->pIDisplay, rcClip.x, rcClip.y, rcClip.dx, rcClip.dy, pComp->pStatic,
+							rcClip.x - pComp->rcBounds.x, rcClip.y - pComp->rcBounds.y, AEE_RO_COPY);
+			HamletCompositor_DrawLayers(pComp, pComp->nStaticLayers, HAMLET_MAX_LAYERS, &rcClip, 0, 0);
+		}
+		else
+		{
+			IDISPLAY_EraseRect(pComp->pIDisplay, &rcClip);
+			HamletCompositor_DrawLayers(pComp, 0, HAMLET_MAX_LAYERS, &rcClip, 0, 0);
+		}
+
+		//one update per rect, so two apart do not send everything between them
+		IDISPLAY_Update(pComp->pIDisplay);
+	}
+	IDISPLAY_SetClipRect(pComp->pIDisplay, NULL);
+	pComp->nDirty = 0;
+	return TRUE;
+}
+
+//draws layers [nFirst, nEnd) that touch prcClip; the origin shifts them into an offscreen bitmap
+static void HamletCompositor_DrawLayers(HamletCompositor* pComp, int nFirst, int nEnd, const AEERect* prcClip, int xOrigin, int yOrigin)
+{
+	AEERect rcOverlap;
+	AEERect rcDrawn;
+	HamletLayer* pLayer;
+	IBitmap* pDest = NULL;
+	IDIB* pDIB = NULL;
+	int i;
+
+	for(i = nFirst; i < nEnd; i++)
+	{
+		pLayer = &pComp->layers[i];
+		if(pLayer->pImage == NULL || !HamletRect_Intersect(&rcOverlap, &pLayer->rc, prcClip))
+		{	continue;	}
+
+		if(pLayer->pSprite)
+		{
+			if(pDest == NULL)
+			{	pDIB = HamletCompositor_GetTarget(pComp, &pDest);	}
+
+			//the sprite is the whole atlas, the layer's part of the clip keeps the other frames out
+			rcOverlap.x = (int16)(rcOverlap.x - xOrigin);
+			rcOverlap.y = (int16)(rcOverlap.y - yOrigin);
+			if(pDIB && HamletSprite_Draw(pLayer->pSprite, pDIB, &rcOverlap, pLayer->rc.x - pLayer->rcSrc.x - xOrigin,
+										 pLayer->rc.y - pLayer->rcSrc.y - yOrigin, &rcDrawn))
+			{
+				IBITMAP_Invalidate(pDest, &rcDrawn);
+				continue;
+			}
+		}
+
+		if(pLayer->pScaled)
+		{
+			IDISPLAY_BitBlt(pComp->pIDisplay, pLayer->rc.x - xOrigin, pLayer->rc.y - yOrigin, pLayer->rc.dx, pLayer->rc.dy,
+							pLayer->pScaled, pLayer->rcSrc.x, pLayer->rcSrc.y, pLayer->bTransparent ? AEE_RO_TRANSPARENT : AEE_RO_COPY);
+			continue;
+		}
+
+		IIMAGE_SetParm(pLayer->pImage, IPARM_ROP, pLayer->bTransparent ? AEE_RO_TRANSPARENT : AEE_RO_COPY, 0);
+		IIMAGE_SetOffset(pLayer->pImage, pLayer->rcSrc.x, pLayer->rcSrc.y);
+		IIMAGE_SetDrawSize(pLayer->pImage, pLayer->rcSrc.dx, pLayer->rcSrc.dy);
+		IIMAGE_Draw(pLayer->pImage, pLayer->rc.x - xOrigin, pLayer->rc.y - yOrigin);
+	}
+
+	if(pDIB)
+	{	IDIB_Release(pDIB);		}
+	if(pDest)
+	{	IBITMAP_Release(pDest);	}
+}
+
+//the display's current destination and its pixels; NULL when it has no DIB to write into
+static IDIB* HamletCompositor_GetTarget(HamletCompositor* pComp, IBitmap** ppDest)
+{
+	IDIB* pDIB = NULL;
+
+	if(IDISPLAY_GetDestination(pComp->pIDisplay, ppDest) != SUCCESS)
+	{
+		*ppDest = NULL;
+		return NULL;
+	}
+	if(IBITMAP_QueryInterface(*ppDest, AEECLSID_DIB, (void **)&pDIB) != SUCCESS)
+	{	return NULL;	}
+	return pDIB;
+}
+
+//composites the static layers into the offscreen bitmap
+static void HamletCompositor_BuildStatic(HamletCompositor* pComp)
+{
+	AEERect rcAll;
+
+	rcAll.x = 0;
+	rcAll.y = 0;
+	rcAll.dx = pComp->rcBounds.dx;
+	rcAll.dy = pComp->rcBounds.dy;
+
+	IDISPLAY_SetDestination(pComp->pIDisplay, pComp->pStatic);
+	IDISPLAY_SetClipRect(pComp->pIDisplay, NULL);
+	IDISPLAY_EraseRect(pComp->pIDisplay, &rcAll);
+	HamletCompositor_DrawLayers(pComp, 0, pComp->nStaticLayers, &pComp->rcBounds, pComp->rcBounds.x, pComp->rcBounds.y);
+	IDISPLAY_SetDestination(pComp->pIDisplay, NULL);	//back to the screen
+
+	pComp->bStaticValid = TRUE;
+}
+
+static void HamletCompositor_InvalidateLayer(HamletCompositor* pComp, int nLayer)
+{
+	if(pComp->layers[nLayer].pImage)
+	{
+		HamletCompositor_Invalidate(pComp, &pComp->layers[nLayer].rc);
+	}
+}
+
+//FALSE when the rects do not overlap at all
+static boolean HamletRect_Intersect(AEERect* prcOut, const AEERect* prcA, const AEERect* prcB)
+{
+	int x0 = MAX(prcA->x, prcB->x);
+	int y0 = MAX(prcA->y, prcB->y);
+	int x1 = MIN(prcA->x + prcA->dx, prcB->x + prcB->dx);
+	int y1 = MIN(prcA->y + prcA->dy, prcB->y + prcB->dy);
+
+	if(x1 <= x0 || y1 <= y0)
+	{	return FALSE;	}
+
+	prcOut->x = (int16)x0;
+	prcOut->y = (int16)y0;
+	prcOut->dx = (int16)(x1 - x0);
+	prcOut->dy = (int16)(y1 - y0);
+	return TRUE;
+}
+
+static void HamletRect_Union(AEERect* prcOut, const AEERect* prcA, const AEERect* prcB)
+{
+	int x0 = MIN(prcA->x, prcB->x);
+	int y0 = MIN(prcA->y, prcB->y);
+	int x1 = MAX(prcA->x + prcA->dx, prcB->x + prcB->dx);
+	int y1 = MAX(prcA->y + prcA->dy, prcB->y + prcB->dy);
+
+	prcOut->x = (int16)x0;
+	prcOut->y = (int16)y0;
+	prcOut->dx = (int16)(x1 - x0);
+	prcOut->dy = (int16)(y1 - y0);
+}
+
+static int32 HamletRect_Area(const AEERect* prc)
+{
+	return (int32)prc->dx * prc->dy;
+}
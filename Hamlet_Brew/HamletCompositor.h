@@ -0,0 +1,73 @@
+/*===========================================================================
+
+FILE: HamletCompositor.h
+===========================================================================*/
+#ifndef HAMLETCOMPOSITOR_H
+#define HAMLETCOMPOSITOR_H
+
+#include "AEEShell.h"           // Shell interface definitions
+#include "AEEBitmap.h"          // offscreen bitmaps
+
+#include "HamletCache.h"
+
+/*-------------------------------------------------------------------
+Dirty-rectangle compositor for the scene above the text box.
+The scene is a fixed stack of image layers. Changing a layer only
+marks the old and new bounding boxes dirty; a flush repaints the
+layers that intersect those boxes, clipped to them, so the display
+only gets the pixels that actually changed.
+
+The bottom nStaticLayers layers only change when the user picks a
+new set piece, so they are pre-composited into an offscreen bitmap.
+A flush is then one opaque copy out of that bitmap plus the sprites
+on top of it, per dirty rect, and each rect goes out to the screen
+with its own IDISPLAY_Update instead of as part of their union.
+
+Transparent layers whose image has a run-length sprite in the cache
+are copied run by run into the destination DIB instead of going
+through IIMAGE_Draw's per-pixel key test.
+
+When the cache scales, a layer takes the size of the image's scaled
+copy and draws out of it; only the positions come from the caller.
+
+A layer can show one frame of an atlas, a rect of its image. The
+frame is drawn with the rest of the atlas clipped away: the sprite
+and the scaled copy are the atlas's own, shifted so the frame lands
+on the layer.
+-------------------------------------------------------------------*/
+#define HAMLET_MAX_LAYERS	8
+#define HAMLET_MAX_DIRTY	6	// more than this and the closest rects get merged
+
+typedef struct _HamletLayer {
+	IImage*		pImage;			// NULL when the layer is hidden
+	AEERect		rc;				// where the image lands on screen
+	AEERect		rcFrame;		// the part of pImage shown, all of it unless it is an atlas
+	AEERect		rcSrc;			// the same part of pScaled, or of pImage when there is no copy
+	boolean		bTransparent;
+	const HamletSprite*	pSprite;	// set for transparent layers that have one
+	IBitmap*	pScaled;		// the cache's on-screen copy of pImage, NULL to draw pImage itself
+} HamletLayer;
+
+typedef struct _HamletCompositor {
+	IDisplay*	pIDisplay;
+	HamletImageCache*	pCache;		// where the layers' sprites come from
+	AEERect		rcBounds;		// nothing is drawn outside of this
+	HamletLayer	layers[HAMLET_MAX_LAYERS];	// index 0 is the bottom of the stack
+	AEERect		dirty[HAMLET_MAX_DIRTY];
+	int			nDirty;
+
+	int			nStaticLayers;	// layers below this index live in pStatic
+	IBitmap*	pStatic;		// same size as rcBounds, NULL if it could not be created
+	boolean		bStaticValid;
+} HamletCompositor;
+
+void	HamletCompositor_Init(HamletCompositor* pComp, IDisplay* pIDisplay, HamletImageCache* pCache, const AEERect* prcBounds, int nStaticLayers);
+void	HamletCompositor_Free(HamletCompositor* pComp);
+void	HamletCompositor_SetLayer(HamletCompositor* pComp, int nLayer, IImage* pImage, int x, int y, boolean bTransparent);
+void	HamletCompositor_SetLayerFrame(HamletCompositor* pComp, int nLayer, IImage* pImage, const AEERect* prcFrame, int x, int y, boolean bTransparent);
+void	HamletCompositor_HideLayer(HamletCompositor* pComp, int nLayer);
+void	HamletCompositor_Invalidate(HamletCompositor* pComp, const AEERect* prc);
+void	HamletCompositor_InvalidateAll(HamletCompositor* pComp);
+boolean	HamletCompositor_Flush(HamletCompositor* pComp);	//FALSE when nothing had to be drawn
+
+#endif // HAMLETCOMPOSITOR_H
@@ -0,0 +1,253 @@
+/*===========================================================================
+
+FILE: HamletMenu.c
+===========================================================================*/
+
+
+/*===============================================================================
+INCLUDES AND VARIABLE DEFINITIONS
+=============================================================================== */
+#include "AEEShell.h"           // Shell interface definitions
+#include "AEEStdLib.h"          // MEMSET etc.
+#include "AEEBitmap.h"          // the rows' canvas
+
+#include "HamletMenu.h"
+
+#define HAMLET_MENU_ROWS(n)		(1 + 2 * (n))	// title, then every item plain and highlighted
+
+static void	HamletMenu_ShowRow(HamletMenu* pMenu, int nItem, boolean bErase);
+static void	HamletMenu_PaintRow(HamletMenu* pMenu, int nItem, boolean bHighlight, int x, int y, const AEERect* prcClip);
+static int	HamletMenu_RenderRows(HamletMenu* pMenu);
+
+/*===============================================================================
+FUNCTION DEFINITIONS
+=============================================================================== */
+
+void HamletMenu_Init(HamletMenu* pMenu, IDisplay* pIDisplay, HamletGlyphCache* pGlyphs)
+{
+	MEMSET(pMenu, 0, sizeof(HamletMenu));
+	pMenu->pIDisplay = pIDisplay;
+	pMenu->pGlyphs = pGlyphs;
+}
+
+//renders the rows, unless this very menu was built before; either way the first item is selected
+int HamletMenu_Build(HamletMenu* pMenu, const AEERect* prc, uint16 wTitleID, const HamletMenuItem* pItems, int nItems)
+{
+	int i;
+
+	nItems = MIN(nItems, HAMLET_MENU_ITEMS);
+	pMenu->nSel = 0;
+	if(pMenu->bBuilt && pMenu->rc.x == prc->x && pMenu->rc.y == prc->y && pMenu->rc.dx == prc->dx
+	   && pMenu->rc.dy == prc->dy && pMenu->wTitleID == wTitleID && pMenu->nItems == nItems)
+	{
+		for(i = 0; i < nItems; i++)
+		{
+			if(pMenu->items[i].nItemID != pItems[i].nItemID || pMenu->items[i].wResID != pItems[i].wResID)
+			{	break;	}
+		}
+		if(i == nItems)
+		{	return SUCCESS;		}
+	}
+
+	HamletSprite_Free(&pMenu->rows);
+	pMenu->bBuilt = TRUE;
+	pMenu->rc = *prc;
+	pMenu->wTitleID = wTitleID;
+	pMenu->nItems = nItems;
+	for(i = 0; i < nItems; i++)
+	{	pMenu->items[i] = pItems[i];	}
+	return HamletMenu_RenderRows(pMenu);
+}
+
+void HamletMenu_SetActive(HamletMenu* pMenu, boolean bActive)
+{
+	pMenu->bActive = bActive;
+	if(bActive)
+	{	HamletMenu_Redraw(pMenu);	}
+}
+
+//the whole menu: its rect cleared, then every row
+void HamletMenu_Redraw(HamletMenu* pMenu)
+{
+	int i;
+
+	if(!pMenu->bBuilt)
+	{	return;		}
+
+	IDISPLAY_EraseRect(pMenu->pIDisplay, &pMenu->rc);
+	for(i = -1; i < pMenu->nItems; i++)
+	{	HamletMenu_ShowRow(pMenu, i, FALSE);	}
+	IDISPLAY_Update(pMenu->pIDisplay);
+}
+
+//up and down move the selection, repainting just the two rows; select hands back the item
+boolean HamletMenu_HandleKey(HamletMenu* pMenu, uint16 wKey, uint16* pnPicked)
+{
+	int nOld = pMenu->nSel;
+
+	if(!pMenu->bActive || pMenu->nItems == 0)
+	{	return FALSE;	}
+
+	switch(wKey)
+	{
+		case AVK_UP:
+			if(pMenu->nSel > 0)
+			{	pMenu->nSel--;	}
+			break;
+		case AVK_DOWN:
+			if(pMenu->nSel < pMenu->nItems - 1)
+			{	pMenu->nSel++;	}
+			break;
+		case AVK_SELECT:
+			*pnPicked = pMenu->items[pMenu->nSel].nItemID;
+			return TRUE;
+		default:
+			return FALSE;
+	}
+
+	if(pMenu->nSel != nOld)
+	{
+		HamletMenu_ShowRow(pMenu, nOld, TRUE);
+		HamletMenu_ShowRow(pMenu, pMenu->nSel, TRUE);
+		IDISPLAY_Update(pMenu->pIDisplay);
+	}
+	return FALSE;
+}
+
+uint16 HamletMenu_GetSel(HamletMenu* pMenu)
+{
+	return pMenu->nItems ? pMenu->items[pMenu->nSel].nItemID : 0;
+}
+
+void HamletMenu_Free(HamletMenu* pMenu)
+{
+	HamletSprite_Free(&pMenu->rows);
+	pMenu->bBuilt = FALSE;
+	pMenu->bActive = FALSE;
+}
+
+//item nItem's row, -1 for the title, in the state the selection gives it; the part below the menu is left off
+static void HamletMenu_ShowRow(HamletMenu* pMenu, int nItem, boolean bErase)
+{
+	boolean bHighlight = (nItem >= 0 && nItem == pMenu->nSel);
+	int nRow = (nItem < 0) ? 0 : (bHighlight ? 2 + 2 * nItem : 1 + 2 * nItem);
+	int y = pMenu->rc.y + (nItem + 1) * HAMLET_MENU_ROW_CY;
+	IBitmap* pDest = NULL;
+	IDIB* pDIB = NULL;
+	AEERect rcRow;
+	AEERect rcDrawn;
+	boolean bDrawn = FALSE;
+
+	rcRow.x = pMenu->rc.x;
+	rcRow.y = (int16)y;
+	rcRow.dx = pMenu->rc.dx;
+	rcRow.dy = (int16)MIN(HAMLET_MENU_ROW_CY, pMenu->rc.y + pMenu->rc.dy - y);
+	if(rcRow.dy <= 0)
+	{	return;		}
+
+	if(bErase)
+	{	IDISPLAY_EraseRect(pMenu->pIDisplay, &rcRow);	}
+
+	if(pMenu->rows.pRows && IDISPLAY_GetDestination(pMenu->pIDisplay, &pDest) == SUCCESS
+	   && IBITMAP_QueryInterface(pDest, AEECLSID_DIB, (void **)&pDIB) == SUCCESS)
+	{
+		bDrawn = HamletSprite_Draw(&pMenu->rows, pDIB, &rcRow, rcRow.x, y - nRow * HAMLET_MENU_ROW_CY, &rcDrawn);
+		if(bDrawn && rcDrawn.dx > 0 && rcDrawn.dy > 0)
+		{	IBITMAP_Invalidate(pDest, &rcDrawn);	}
+	}
+	if(!bDrawn)
+	{	HamletMenu_PaintRow(pMenu, nItem, bHighlight, rcRow.x, y, &rcRow);	}
+
+	if(pDIB)
+	{	IDIB_Release(pDIB);		}
+	if(pDest)
+	{	IBITMAP_Release(pDest);	}
+}
+
+//the row's text centered on it, and the frame when it is highlighted; (x, y) is the row's top left
+static void HamletMenu_PaintRow(HamletMenu* pMenu, int nItem, boolean bHighlight, int x, int y, const AEERect* prcClip)
+{
+	uint16 wResID = (nItem < 0) ? pMenu->wTitleID : pMenu->items[nItem].wResID;
+	AEEFont nFont = (nItem < 0) ? AEE_FONT_BOLD : AEE_FONT_NORMAL;
+	const HamletTextLayout* pLayout;
+	AEERect rcText;
+	AEERect rcEdge;
+	int cyFont;
+
+	cyFont = IDISPLAY_GetFontMetrics(pMenu->pIDisplay, nFont, NULL, NULL);
+	rcText.dx = (int16)IDISPLAY_MeasureText(pMenu->pIDisplay, nFont, HamletText_Get(pMenu->pGlyphs->pTable, wResID, NULL));
+	rcText.dy = (int16)cyFont;
+	rcText.x = (int16)(x + (pMenu->rc.dx - rcText.dx) / 2);
+	rcText.y = (int16)(y + (HAMLET_MENU_ROW_CY - cyFont) / 2);
+	pLayout = HamletText_Layout(pMenu->pGlyphs, wResID, nFont, &rcText);
+	if(pLayout)
+	{	HamletText_Draw(pMenu->pGlyphs, pLayout);	}
+
+	if(bHighlight)
+	{
+		IDISPLAY_SetClipRect(pMenu->pIDisplay, prcClip);
+		rcEdge.x = (int16)x;
+		rcEdge.y = (int16)y;
+		rcEdge.dx = pMenu->rc.dx;
+		rcEdge.dy = 1;
+		IDISPLAY_FillRect(pMenu->pIDisplay, &rcEdge, HAMLET_MENU_FRAME);
+		rcEdge.y = (int16)(y + HAMLET_MENU_ROW_CY - 1);
+		IDISPLAY_FillRect(pMenu->pIDisplay, &rcEdge, HAMLET_MENU_FRAME);
+		rcEdge.y = (int16)y;
+		rcEdge.dx = 1;
+		rcEdge.dy = HAMLET_MENU_ROW_CY;
+		IDISPLAY_FillRect(pMenu->pIDisplay, &rcEdge, HAMLET_MENU_FRAME);
+		rcEdge.x = (int16)(x + pMenu->rc.dx - 1);
+		IDISPLAY_FillRect(pMenu->pIDisplay, &rcEdge, HAMLET_MENU_FRAME);
+		IDISPLAY_SetClipRect(pMenu->pIDisplay, NULL);
+	}
+}
+
+//paints every row once into a key-filled canvas, one under the other, and keeps what is not key
+static int HamletMenu_RenderRows(HamletMenu* pMenu)
+{
+	IDisplay* pIDisplay = pMenu->pIDisplay;
+	IBitmap* pDevice = NULL;
+	IBitmap* pCanvas = NULL;
+	IBitmap* pOldDest = NULL;
+	AEERect rcAll;
+	int nErr;
+	int i;
+
+	rcAll.x = 0;
+	rcAll.y = 0;
+	rcAll.dx = pMenu->rc.dx;
+	rcAll.dy = (int16)(HAMLET_MENU_ROWS(pMenu->nItems) * HAMLET_MENU_ROW_CY);
+	if(rcAll.dx <= 0)
+	{	return EBADPARM;	}
+
+	nErr = IDISPLAY_GetDeviceBitmap(pIDisplay, &pDevice);
+	if(nErr == SUCCESS)
+	{
+		nErr = IBITMAP_CreateCompatibleBitmap(pDevice, &pCanvas, (uint16)rcAll.dx, (uint16)rcAll.dy);
+		IBITMAP_Release(pDevice);
+	}
+
+	if(nErr == SUCCESS)
+	{
+		IDISPLAY_GetDestination(pIDisplay, &pOldDest);
+		IDISPLAY_SetDestination(pIDisplay, pCanvas);
+		IDISPLAY_SetClipRect(pIDisplay, NULL);
+		IDISPLAY_FillRect(pIDisplay, &rcAll, HAMLET_SPRITE_KEY);
+		HamletMenu_PaintRow(pMenu, -1, FALSE, 0, 0, NULL);
+		for(i = 0; i < pMenu->nItems; i++)
+		{
+			HamletMenu_PaintRow(pMenu, i, FALSE, 0, (1 + 2 * i) * HAMLET_MENU_ROW_CY, NULL);
+			HamletMenu_PaintRow(pMenu, i, TRUE, 0, (2 + 2 * i) * HAMLET_MENU_ROW_CY, NULL);
+		}
+		IDISPLAY_SetDestination(pIDisplay, pOldDest);
+		IBITMAP_Release(pOldDest);
+
+		//the text's palette already has the text color in it
+		nErr = HamletSprite_BuildFromBitmap(&pMenu->rows, pCanvas, &pMenu->pGlyphs->palette);
+	}
+
+	if(pCanvas)
+	{	IBITMAP_Release(pCanvas);	}
+	return nErr;
+}
@@ -0,0 +1,56 @@
+/*===========================================================================
+
+FILE: HamletMenu.h
+===========================================================================*/
+#ifndef HAMLETMENU_H
+#define HAMLETMENU_H
+
+#include "AEEShell.h"           // Shell interface definitions
+#include "AEEDisp.h"            // IDisplay
+
+#include "HamletText.h"
+#include "HamletSprite.h"
+
+/*-------------------------------------------------------------------
+The kill-choice menu: a title row over one row per item, the selected
+item framed. Every row is rendered once, when the menu is built, into
+one run-length sprite: the title, then each item plain and each item
+highlighted. Showing the menu erases its rect and copies the rows out
+of the sprite; moving the selection repaints only the row it leaves
+and the row it lands on. Building the same menu again keeps the rows
+and just puts the selection back on the first item.
+
+A display the sprite cannot draw into gets the rows painted in place
+instead, the same way they were painted into the sprite.
+-------------------------------------------------------------------*/
+#define HAMLET_MENU_ITEMS	3
+#define HAMLET_MENU_ROW_CY	14		// the handset menu's item height, BrewMenu.swift's itemHeight
+#define HAMLET_MENU_FRAME	MAKE_RGB(0, 0, 255)
+
+typedef struct _HamletMenuItem {
+	uint16		nItemID;
+	uint16		wResID;
+} HamletMenuItem;
+
+typedef struct _HamletMenu {
+	IDisplay*			pIDisplay;
+	HamletGlyphCache*	pGlyphs;		// the text, and the palette the rows share with it
+	boolean				bBuilt;
+	boolean				bActive;		// on screen and taking keys
+	AEERect				rc;
+	uint16				wTitleID;
+	int					nItems;
+	HamletMenuItem		items[HAMLET_MENU_ITEMS];
+	int					nSel;
+	HamletSprite		rows;			// HAMLET_MENU_ROW_CY apart; no rows when it could not be rendered
+} HamletMenu;
+
+void	HamletMenu_Init(HamletMenu* pMenu, IDisplay* pIDisplay, HamletGlyphCache* pGlyphs);
+int		HamletMenu_Build(HamletMenu* pMenu, const AEERect* prc, uint16 wTitleID, const HamletMenuItem* pItems, int nItems);
+void	HamletMenu_SetActive(HamletMenu* pMenu, boolean bActive);	//draws it when it comes up
+void	HamletMenu_Redraw(HamletMenu* pMenu);
+boolean	HamletMenu_HandleKey(HamletMenu* pMenu, uint16 wKey, uint16* pnPicked);	//TRUE when the key picked an item
+uint16	HamletMenu_GetSel(HamletMenu* pMenu);
+void	HamletMenu_Free(HamletMenu* pMenu);
+
+#endif // HAMLETMENU_H
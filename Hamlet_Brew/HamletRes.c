@@ -0,0 +1,291 @@
+/*===========================================================================
+
+FILE: HamletRes.c
+===========================================================================*/
+
+
+/*===============================================================================
+INCLUDES AND VARIABLE DEFINITIONS
+=============================================================================== */
+#include "AEEShell.h"           // Shell interface definitions
+#include "AEEStdLib.h"          // MEMSET etc.
+#include "AEEFile.h"			// File interface definitions
+#include "AEEMemAStream.h"
+
+#include "HamletRes.h"
+
+static int						HamletRes_BuildTable(HamletResIndex* pRes, HamletResTable* pTable, uint16 wType);
+static int						HamletRes_FindFrames(HamletResIndex* pRes);
+static int						HamletRes_BuildFrameTable(HamletResIndex* pRes, HamletResTable* pTable, boolean bAtlas);
+static const HamletPakEntry*	HamletRes_Find(HamletResIndex* pRes, HamletResTable* pTable, uint16 wResID);
+static uint16					HamletRes_Slot(const HamletResTable* pTable, uint16 wResID);
+
+/*===============================================================================
+FUNCTION DEFINITIONS
+=============================================================================== */
+
+//maps pszPakFile and indexes its directory; on failure every lookup falls back to pszResFile
+int HamletRes_Open(HamletResIndex* pRes, IShell* pIShell, const char* pszResFile, const char* pszPakFile)
+{
+	const HamletPakHeader* pHeader;
+	FileInfo fi;
+	int nErr = EFAILED;
+
+	MEMSET(pRes, 0, sizeof(HamletResIndex));
+	pRes->pIShell = pIShell;
+	pRes->pszResFile = pszResFile;
+
+	if(ISHELL_CreateInstance(pIShell, AEECLSID_FILEMGR, (void **)&pRes->pIFileMgr) != SUCCESS)
+	{	return ECLASSNOTSUPPORT;	}
+
+	pRes->pIFile = IFILEMGR_OpenFile(pRes->pIFileMgr, pszPakFile, _OFM_READ);
+	if(pRes->pIFile && IFILE_GetInfo(pRes->pIFile, &fi) == SUCCESS && fi.dwSize >= sizeof(HamletPakHeader))
+	{
+		pRes->pBase = (const byte*)IFILE_Map(pRes->pIFile, NULL, fi.dwSize, AEE_FMAP_PROT_READ, AEE_FMAP_SHARED, 0);
+		pRes->dwSize = fi.dwSize;
+	}
+
+	//the directory has to be whole before anything is taken from it
+	pHeader = (const HamletPakHeader*)pRes->pBase;
+	if(pHeader && pHeader->dwMagic == HAMLET_PAK_MAGIC && pHeader->wVersion == HAMLET_PAK_VERSION
+		&& sizeof(HamletPakHeader) + pHeader->nEntries * sizeof(HamletPakEntry) <= pRes->dwSize)
+	{
+		pRes->pEntries = (const HamletPakEntry*)(pHeader + 1);
+		nErr = HamletRes_BuildTable(pRes, &pRes->strings, RESTYPE_STRING);
+		if(nErr == SUCCESS)
+		{	nErr = HamletRes_BuildTable(pRes, &pRes->images, RESTYPE_IMAGE);	}
+		if(nErr == SUCCESS)
+		{	nErr = HamletRes_FindFrames(pRes);	}
+	}
+
+	if(nErr != SUCCESS)
+	{
+		HamletRes_Close(pRes);
+		pRes->pIShell = pIShell;
+		pRes->pszResFile = pszResFile;
+	}
+	return nErr;
+}
+
+//the bundle's own copy of the string, zero-terminated; nothing is copied
+const AECHAR* HamletRes_GetString(HamletResIndex* pRes, uint16 wResID, int* pnLen)
+{
+	const HamletPakEntry* pEntry = HamletRes_Find(pRes, &pRes->strings, wResID);
+
+	if(pEntry == NULL)
+	{	return NULL;	}
+
+	if(pnLen)
+	{	*pnLen = (int)(pEntry->dwSize / sizeof(AECHAR)) - 1;	}
+	return (const AECHAR*)(pRes->pBase + pEntry->dwOffset);
+}
+
+//same contract as ISHELL_LoadResString: nSize is in bytes, returns the characters copied
+int HamletRes_LoadString(HamletResIndex* pRes, uint16 wResID, AECHAR* pBuff, int nSize)
+{
+	const AECHAR* pText;
+	int nLen;
+
+	pText = HamletRes_GetString(pRes, wResID, &nLen);
+	if(pText == NULL)
+	{	return ISHELL_LoadResString(pRes->pIShell, pRes->pszResFile, wResID, pBuff, nSize);	}
+
+	if(nSize < (int)sizeof(AECHAR))
+	{	return 0;	}
+
+	nLen = MIN(nLen, (int)(nSize / sizeof(AECHAR)) - 1);
+	MEMCPY(pBuff, pText, nLen * sizeof(AECHAR));
+	pBuff[nLen] = 0;
+	return nLen;
+}
+
+//decodes straight out of the mapping through a memory stream that does not own the bytes
+IImage* HamletRes_LoadImage(HamletResIndex* pRes, uint16 wResID)
+{
+	const HamletPakEntry* pEntry = HamletRes_Find(pRes, &pRes->images, wResID);
+	IMemAStream* pStream = NULL;
+	IImage* pImage = NULL;
+
+	if(pEntry == NULL)
+	{	return ISHELL_LoadResImage(pRes->pIShell, pRes->pszResFile, wResID);	}
+
+	if(ISHELL_CreateInstance(pRes->pIShell, AEECLSID_PNG, (void **)&pImage) != SUCCESS)
+	{	return NULL;	}
+
+	if(ISHELL_CreateInstance(pRes->pIShell, AEECLSID_MEMASTREAM, (void **)&pStream) != SUCCESS)
+	{
+		IIMAGE_Release(pImage);
+		return NULL;
+	}
+
+	IMEMASTREAM_SetEx(pStream, (byte*)pRes->pBase + pEntry->dwOffset, pEntry->dwSize, 0, NULL, NULL);
+	IIMAGE_SetStream(pImage, (IAStream*)pStream);
+	IMEMASTREAM_Release(pStream);
+	return pImage;
+}
+
+//the image's encoded bytes, for decoding them some other way than all at once
+const byte* HamletRes_GetImageData(HamletResIndex* pRes, uint16 wResID, uint32* pdwSize)
+{
+	const HamletPakEntry* pEntry = HamletRes_Find(pRes, &pRes->images, wResID);
+
+	if(pEntry == NULL)
+	{	return NULL;	}
+
+	*pdwSize = pEntry->dwSize;
+	return pRes->pBase + pEntry->dwOffset;
+}
+
+//the atlas rect a frame's ID stands for
+const HamletPakFrame* HamletRes_GetFrame(HamletResIndex* pRes, uint16 wResID)
+{
+	uint16 wSlot = HamletRes_Slot(&pRes->frames, wResID);
+
+	return wSlot ? &pRes->pFrames[wSlot - 1] : NULL;
+}
+
+//every frame cut out of wAtlasID, in the order they are laid out
+const HamletPakFrame* HamletRes_GetAtlas(HamletResIndex* pRes, uint16 wAtlasID, int* pnFrames)
+{
+	uint16 wSlot = HamletRes_Slot(&pRes->atlases, wAtlasID);
+	int i = wSlot - 1;
+	int n;
+
+	if(wSlot == 0)
+	{
+		*pnFrames = 0;
+		return NULL;
+	}
+
+	for(n = 1; i + n < pRes->nFrames && pRes->pFrames[i + n].wAtlasID == wAtlasID; n++)
+	{	}
+	*pnFrames = n;
+	return &pRes->pFrames[i];
+}
+
+//unmaps the bundle; views handed out earlier are dead after this
+void HamletRes_Close(HamletResIndex* pRes)
+{
+	if(pRes->strings.pwSlots)
+	{	FREE(pRes->strings.pwSlots);	}
+	if(pRes->images.pwSlots)
+	{	FREE(pRes->images.pwSlots);		}
+	if(pRes->frames.pwSlots)
+	{	FREE(pRes->frames.pwSlots);		}
+	if(pRes->atlases.pwSlots)
+	{	FREE(pRes->atlases.pwSlots);	}
+	if(pRes->pIFile)
+	{	IFILE_Release(pRes->pIFile);	}
+	if(pRes->pIFileMgr)
+	{	IFILEMGR_Release(pRes->pIFileMgr);	}
+	MEMSET(pRes, 0, sizeof(HamletResIndex));
+}
+
+//one slot per ID between the lowest and highest of wType; bad entries are left out
+static int HamletRes_BuildTable(HamletResIndex* pRes, HamletResTable* pTable, uint16 wType)
+{
+	const HamletPakHeader* pHeader = (const HamletPakHeader*)pRes->pBase;
+	const HamletPakEntry* pEntry;
+	uint16 wLast = 0;
+	int i;
+
+	pTable->wFirstID = 0xFFFF;
+	for(i = 0; i < pHeader->nEntries; i++)
+	{
+		pEntry = &pRes->pEntries[i];
+		if(pEntry->wType == wType)
+		{
+			pTable->wFirstID = MIN(pTable->wFirstID, pEntry->wResID);
+			wLast = MAX(wLast, pEntry->wResID);
+		}
+	}
+	if(wLast < pTable->wFirstID)
+	{	return SUCCESS;		}
+
+	pTable->nSlots = (uint16)(wLast - pTable->wFirstID + 1);
+	pTable->pwSlots = (uint16*)MALLOC(pTable->nSlots * sizeof(uint16));
+	if(pTable->pwSlots == NULL)
+	{	return ENOMEMORY;	}
+
+	for(i = 0; i < pHeader->nEntries; i++)
+	{
+		pEntry = &pRes->pEntries[i];
+		if(pEntry->wType != wType || pEntry->dwOffset > pRes->dwSize || pEntry->dwSize > pRes->dwSize - pEntry->dwOffset)
+		{	continue;	}
+		if(wType == RESTYPE_STRING && ((pEntry->dwOffset & 1) || pEntry->dwSize < sizeof(AECHAR)
+			|| *(const AECHAR*)(pRes->pBase + pEntry->dwOffset + pEntry->dwSize - sizeof(AECHAR)) != 0))
+		{	continue;	}
+
+		pTable->pwSlots[pEntry->wResID - pTable->wFirstID] = (uint16)(i + 1);
+	}
+	return SUCCESS;
+}
+
+//the frame table, if the bundle has one that fits in it, and its two indexes
+static int HamletRes_FindFrames(HamletResIndex* pRes)
+{
+	const HamletPakHeader* pHeader = (const HamletPakHeader*)pRes->pBase;
+	const HamletPakEntry* pEntry;
+	int i;
+
+	for(i = 0; i < pHeader->nEntries; i++)
+	{
+		pEntry = &pRes->pEntries[i];
+		if(pEntry->wType == RESTYPE_HAMLET_FRAMES && !(pEntry->dwOffset & 1)
+			&& pEntry->dwOffset <= pRes->dwSize && pEntry->dwSize <= pRes->dwSize - pEntry->dwOffset)
+		{
+			pRes->pFrames = (const HamletPakFrame*)(pRes->pBase + pEntry->dwOffset);
+			pRes->nFrames = (int)(pEntry->dwSize / sizeof(HamletPakFrame));
+			if(HamletRes_BuildFrameTable(pRes, &pRes->frames, FALSE) != SUCCESS
+				|| HamletRes_BuildFrameTable(pRes, &pRes->atlases, TRUE) != SUCCESS)
+			{	return ENOMEMORY;	}
+			return SUCCESS;
+		}
+	}
+	return SUCCESS;
+}
+
+//one slot per ID between the lowest and highest frame or atlas ID; the first frame with an ID gets its slot
+static int HamletRes_BuildFrameTable(HamletResIndex* pRes, HamletResTable* pTable, boolean bAtlas)
+{
+	uint16 wLast = 0;
+	uint16 wID;
+	int i;
+
+	pTable->wFirstID = 0xFFFF;
+	for(i = 0; i < pRes->nFrames; i++)
+	{
+		wID = bAtlas ? pRes->pFrames[i].wAtlasID : pRes->pFrames[i].wResID;
+		pTable->wFirstID = MIN(pTable->wFirstID, wID);
+		wLast = MAX(wLast, wID);
+	}
+	if(wLast < pTable->wFirstID)
+	{	return SUCCESS;		}
+
+	pTable->nSlots = (uint16)(wLast - pTable->wFirstID + 1);
+	pTable->pwSlots = (uint16*)MALLOC(pTable->nSlots * sizeof(uint16));
+	if(pTable->pwSlots == NULL)
+	{	return ENOMEMORY;	}
+
+	for(i = pRes->nFrames - 1; i >= 0; i--)
+	{
+		wID = bAtlas ? pRes->pFrames[i].wAtlasID : pRes->pFrames[i].wResID;
+		pTable->pwSlots[wID - pTable->wFirstID] = (uint16)(i + 1);
+	}
+	return SUCCESS;
+}
+
+static const HamletPakEntry* HamletRes_Find(HamletResIndex* pRes, HamletResTable* pTable, uint16 wResID)
+{
+	uint16 wSlot = HamletRes_Slot(pTable, wResID);
+
+	return wSlot ? &pRes->pEntries[wSlot - 1] : NULL;
+}
+
+//0 when the table has nothing for wResID
+static uint16 HamletRes_Slot(const HamletResTable* pTable, uint16 wResID)
+{
+	if(pTable->pwSlots == NULL || wResID < pTable->wFirstID || wResID - pTable->wFirstID >= pTable->nSlots)
+	{	return 0;	}
+	return pTable->pwSlots[wResID - pTable->wFirstID];
+}
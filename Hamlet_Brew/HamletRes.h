@@ -0,0 +1,86 @@
+/*===========================================================================
+
+FILE: HamletRes.h
+===========================================================================*/
+#ifndef HAMLETRES_H
+#define HAMLETRES_H
+
+#include "AEEShell.h"           // Shell interface definitions
+#include "AEEFile.h"			// File interface definitions
+
+/*-------------------------------------------------------------------
+Resource bundle. hamlet.pak carries the same strings and images as
+HAMLET_RES_FILE in one flat file: a header, a directory sorted by
+resource ID, then the data. It is opened and mapped once; lookups go
+through a table indexed by ID, and strings and image bytes are handed
+out as views into the mapping. IDs the bundle lacks fall back to the
+ISHELL_LoadRes* calls on HAMLET_RES_FILE.
+
+The frames of an animation are bundled as one atlas image. A frame
+table says which atlas, and which rect of it, each frame's own IMG_*
+ID stands for; the frames have no image of their own in the bundle.
+It gets two tables like the directory's, one by frame ID and one by
+atlas ID pointing at the atlas's first frame.
+-------------------------------------------------------------------*/
+#define HAMLET_PAK_FILE		"hamlet.pak"
+#define HAMLET_PAK_MAGIC	0x4B415048	// "HPAK"
+#define HAMLET_PAK_VERSION	2
+#define RESTYPE_HAMLET_FRAMES	0x4846	// the frame table, one entry of HamletPakFrames
+
+//on-disk layout, little endian like the handset
+typedef struct _HamletPakHeader {
+	uint32		dwMagic;
+	uint16		wVersion;
+	uint16		nEntries;
+} HamletPakHeader;
+
+typedef struct _HamletPakEntry {
+	uint16		wResID;
+	uint16		wType;			// RESTYPE_STRING, RESTYPE_IMAGE or RESTYPE_HAMLET_FRAMES
+	uint32		dwOffset;		// from the start of the file; strings are 2-byte aligned
+	uint32		dwSize;			// bytes, a string's terminating 0 included
+} HamletPakEntry;
+
+//the frames of one atlas are next to each other in the table, in a row or a column, first one at 0,0
+typedef struct _HamletPakFrame {
+	uint16		wResID;			// the frame's own IMG_*
+	uint16		wAtlasID;		// the IMG_* it is cut out of
+	int16		x;				// where it is in the atlas
+	int16		y;
+	uint16		cx;
+	uint16		cy;
+} HamletPakFrame;
+
+//directory or frame table slots, indexed by wResID - wFirstID
+typedef struct _HamletResTable {
+	uint16		wFirstID;
+	uint16		nSlots;
+	uint16*		pwSlots;		// entry or frame number + 1, 0 for IDs the bundle lacks
+} HamletResTable;
+
+typedef struct _HamletResIndex {
+	IShell*					pIShell;
+	const char*				pszResFile;
+	IFileMgr*				pIFileMgr;
+	IFile*					pIFile;
+	const byte*				pBase;			// the mapped bundle, NULL when it could not be opened
+	uint32					dwSize;
+	const HamletPakEntry*	pEntries;
+	HamletResTable			strings;
+	HamletResTable			images;
+	const HamletPakFrame*	pFrames;		// NULL when nothing is bundled as an atlas
+	int						nFrames;
+	HamletResTable			frames;			// by the frame's own IMG_*
+	HamletResTable			atlases;		// by wAtlasID, to the first of its frames
+} HamletResIndex;
+
+int				HamletRes_Open(HamletResIndex* pRes, IShell* pIShell, const char* pszResFile, const char* pszPakFile);
+const AECHAR*	HamletRes_GetString(HamletResIndex* pRes, uint16 wResID, int* pnLen);	//view, NULL if not bundled
+int				HamletRes_LoadString(HamletResIndex* pRes, uint16 wResID, AECHAR* pBuff, int nSize);
+IImage*			HamletRes_LoadImage(HamletResIndex* pRes, uint16 wResID);	//caller releases
+const byte*		HamletRes_GetImageData(HamletResIndex* pRes, uint16 wResID, uint32* pdwSize);	//view, NULL if not bundled
+const HamletPakFrame*	HamletRes_GetFrame(HamletResIndex* pRes, uint16 wResID);	//NULL when wResID is an image of its own
+const HamletPakFrame*	HamletRes_GetAtlas(HamletResIndex* pRes, uint16 wAtlasID, int* pnFrames);	//its frames, NULL when it is no atlas
+void			HamletRes_Close(HamletResIndex* pRes);
+
+#endif // HAMLETRES_H
@@ -0,0 +1,318 @@
+/*===========================================================================
+
+FILE: HamletSprite.c
+===========================================================================*/
+
+
+/*===============================================================================
+INCLUDES AND VARIABLE DEFINITIONS
+=============================================================================== */
+#include "AEEShell.h"           // Shell interface definitions
+#include "AEEStdLib.h"          // MEMSET etc.
+#include "AEEBitmap.h"          // offscreen bitmaps and their DIBs
+
+#include "HamletSprite.h"
+
+#define HAMLET_PALETTE_SLOTS	(HAMLET_PALETTE_SIZE * 2)	// a full palette leaves half of them empty
+
+//native color to palette entry, built once per sprite so no pixel searches the palette
+typedef struct _HamletPaletteMap {
+	uint16		wColors[HAMLET_PALETTE_SLOTS];
+	uint16		wEntries[HAMLET_PALETTE_SLOTS];	// index into the palette plus one, 0 for an empty slot
+} HamletPaletteMap;
+
+static int HamletSprite_Encode(HamletSprite* pSprite, const IDIB* pDIB, uint16 wKey, HamletPalette* pPalette);
+static int HamletPalette_Index(HamletPalette* pPalette, HamletPaletteMap* pMap, uint16 wColor, boolean bAdd);
+static HamletPaletteMap* HamletPalette_NewMap(const HamletPalette* pPalette);
+static uint32 HamletPaletteMap_Slot(const HamletPaletteMap* pMap, uint16 wColor);
+
+/*===============================================================================
+FUNCTION DEFINITIONS
+=============================================================================== */
+
+//renders the image once and keeps its opaque runs; EFAILED when the image has no transparent pixels
+int HamletSprite_Build(HamletSprite* pSprite, IDisplay* pIDisplay, IImage* pImage, HamletPalette* pPalette)
+{
+	AEEImageInfo info;
+	AEERect rcAll;
+	IBitmap* pDevice = NULL;
+	IBitmap* pCanvas = NULL;
+	IBitmap* pOldDest = NULL;
+	int nErr;
+
+	MEMSET(pSprite, 0, sizeof(HamletSprite));
+	IIMAGE_GetInfo(pImage, &info);
+	if(info.cx == 0 || info.cy == 0)
+	{	return EBADPARM;	}
+
+	nErr = IDISPLAY_GetDeviceBitmap(pIDisplay, &pDevice);
+	if(nErr == SUCCESS)
+	{
+		nErr = IBITMAP_CreateCompatibleBitmap(pDevice, &pCanvas, info.cx, info.cy);
+		IBITMAP_Release(pDevice);
+	}
+
+	if(nErr == SUCCESS)
+	{
+		rcAll.x = 0;
+		rcAll.y = 0;
+		rcAll.dx = (int16)info.cx;
+		rcAll.dy = (int16)info.cy;
+
+		//fill the canvas with the key, whatever stays key after a transparent draw is a gap
+		IDISPLAY_GetDestination(pIDisplay, &pOldDest);
+		IDISPLAY_SetDestination(pIDisplay, pCanvas);
+		IDISPLAY_SetClipRect(pIDisplay, NULL);
+		IDISPLAY_FillRect(pIDisplay, &rcAll, HAMLET_SPRITE_KEY);
+		IIMAGE_SetParm(pImage, IPARM_ROP, AEE_RO_TRANSPARENT, 0);
+		IIMAGE_Draw(pImage, 0, 0);
+		IDISPLAY_SetDestination(pIDisplay, pOldDest);
+		IBITMAP_Release(pOldDest);
+
+		nErr = HamletSprite_BuildFromBitmap(pSprite, pCanvas, pPalette);
+	}
+
+	if(pCanvas)
+	{	IBITMAP_Release(pCanvas);	}
+	return nErr;
+}
+
+//the same for a picture already rendered into a bitmap, with the key color where it is transparent
+int HamletSprite_BuildFromBitmap(HamletSprite* pSprite, IBitmap* pBitmap, HamletPalette* pPalette)
+{
+	IDIB* pDIB = NULL;
+	int nErr;
+
+	MEMSET(pSprite, 0, sizeof(HamletSprite));
+	nErr = IBITMAP_QueryInterface(pBitmap, AEECLSID_DIB, (void **)&pDIB);
+	if(nErr == SUCCESS && pDIB->nDepth != 16)
+	{	nErr = EUNSUPPORTED;	}
+	if(nErr == SUCCESS)
+	{	nErr = HamletSprite_Encode(pSprite, pDIB, (uint16)IBITMAP_RGBToNative(pBitmap, HAMLET_SPRITE_KEY), pPalette);	}
+
+	if(pDIB)
+	{	IDIB_Release(pDIB);		}
+	return nErr;
+}
+
+//copies the opaque runs that fall inside prcClip; FALSE when the DIB is not one the sprite can go into
+boolean HamletSprite_Draw(const HamletSprite* pSprite, IDIB* pDIB, const AEERect* prcClip, int x, int y, AEERect* prcDrawn)
+{
+	const HamletSpriteRow* pRow;
+	const HamletSpriteRun* pRun;
+	uint32 dwPixel;
+	uint16* pOut;
+	int x0;
+	int y0;
+	int x1;
+	int y1;
+	int xStart;
+	int xEnd;
+	int row;
+	int i;
+	int k;
+
+	if(pSprite->pRows == NULL || pDIB->nDepth != 16 || pDIB->nColorScheme != pSprite->nColorScheme)
+	{	return FALSE;	}
+
+	//the part of the sprite inside both the clip and the DIB, in sprite coordinates
+	x0 = MAX(MAX(prcClip->x, 0), x) - x;
+	y0 = MAX(MAX(prcClip->y, 0), y) - y;
+	x1 = MIN(MIN(prcClip->x + prcClip->dx, pDIB->cx), x + pSprite->cx) - x;
+	y1 = MIN(MIN(prcClip->y + prcClip->dy, pDIB->cy), y + pSprite->cy) - y;
+
+	prcDrawn->x = (int16)(x + x0);
+	prcDrawn->y = (int16)(y + y0);
+	prcDrawn->dx = (int16)MAX(x1 - x0, 0);
+	prcDrawn->dy = (int16)MAX(y1 - y0, 0);
+	if(x1 <= x0 || y1 <= y0)
+	{	return TRUE;	}
+
+	for(row = y0; row < y1; row++)
+	{
+		pRow = &pSprite->pRows[row];
+		pRun = pSprite->pRuns + pRow->wFirstRun;
+		dwPixel = pRow->dwFirstPixel;
+		pOut = (uint16*)(pDIB->pBmp + (y + row) * pDIB->nPitch) + x;
+
+		for(i = 0; i < pRow->nRuns && pRun->x < x1; i++, dwPixel += pRun->cx, pRun++)
+		{
+			xStart = MAX(pRun->x, x0);
+			xEnd = MIN(pRun->x + pRun->cx, x1);
+			if(xEnd <= xStart)
+			{	continue;	}
+
+			if(pSprite->pIndices)
+			{
+				//the palette lookup is the only per-pixel work there is
+				for(k = xStart; k < xEnd; k++)
+				{	pOut[k] = pSprite->pPalette->wColors[pSprite->pIndices[dwPixel + k - pRun->x]];	}
+			}
+			else
+			{	MEMCPY(pOut + xStart, pSprite->pPixels + dwPixel + (xStart - pRun->x), (xEnd - xStart) * sizeof(uint16));	}
+		}
+	}
+	return TRUE;
+}
+
+void HamletSprite_Free(HamletSprite* pSprite)
+{
+	if(pSprite->pRows)
+	{	FREE(pSprite->pRows);	}
+	MEMSET(pSprite, 0, sizeof(HamletSprite));
+}
+
+//two passes over the rendered pixels: count the runs and the new colors, then store them
+static int HamletSprite_Encode(HamletSprite* pSprite, const IDIB* pDIB, uint16 wKey, HamletPalette* pPalette)
+{
+	const uint16* pIn;
+	HamletSpriteRun* pRun;
+	HamletPalette grown;
+	HamletPaletteMap* pMap = NULL;
+	uint32 dwPixel = 0;
+	uint32 dwRuns = 0;
+	uint32 dwOpaque = 0;
+	int nErr = SUCCESS;
+	int x;
+	int y;
+	int xStart;
+
+	//the colors go into a copy, so a sprite that does not fit leaves the shared palette alone
+	if(pPalette && pPalette->nColors && pPalette->nColorScheme != pDIB->nColorScheme)
+	{	pPalette = NULL;	}
+	if(pPalette)
+	{
+		grown = *pPalette;
+		grown.nColorScheme = pDIB->nColorScheme;
+		pMap = HamletPalette_NewMap(&grown);
+		if(pMap == NULL)
+		{	pPalette = NULL;	}
+	}
+
+	for(y = 0; y < pDIB->cy; y++)
+	{
+		pIn = (const uint16*)(pDIB->pBmp + y * pDIB->nPitch);
+		for(x = 0; x < pDIB->cx; x++)
+		{
+			if(pIn[x] != wKey)
+			{
+				dwOpaque++;
+				if(x == 0 || pIn[x - 1] == wKey)
+				{	dwRuns++;	}
+				if(pPalette && HamletPalette_Index(&grown, pMap, pIn[x], TRUE) < 0)
+				{	pPalette = NULL;	}
+			}
+		}
+	}
+
+	//fully opaque draws just as well through the image; past 64K runs wFirstRun cannot hold them
+	if(dwOpaque == (uint32)pDIB->cx * pDIB->cy)
+	{	nErr = EFAILED;		}
+	else if(dwRuns > 0xFFFF)
+	{	nErr = EUNSUPPORTED;	}
+	else
+	{
+		pSprite->pRows = (HamletSpriteRow*)MALLOC(pDIB->cy * sizeof(HamletSpriteRow) + dwRuns * sizeof(HamletSpriteRun)
+												  + dwOpaque * (pPalette ? sizeof(uint8) : sizeof(uint16)));
+		if(pSprite->pRows == NULL)
+		{	nErr = ENOMEMORY;	}
+	}
+	if(nErr != SUCCESS)
+	{
+		if(pMap)
+		{	FREE(pMap);	}
+		return nErr;
+	}
+
+	pSprite->pRuns = (HamletSpriteRun*)(pSprite->pRows + pDIB->cy);
+	if(pPalette)
+	{
+		*pPalette = grown;
+		pSprite->pIndices = (uint8*)(pSprite->pRuns + dwRuns);
+		pSprite->pPalette = pPalette;
+	}
+	else
+	{	pSprite->pPixels = (uint16*)(pSprite->pRuns + dwRuns);	}
+	pSprite->cx = pDIB->cx;
+	pSprite->cy = pDIB->cy;
+	pSprite->nColorScheme = pDIB->nColorScheme;
+	pSprite->dwOpaque = dwOpaque;
+
+	pRun = pSprite->pRuns;
+	for(y = 0; y < pDIB->cy; y++)
+	{
+		pIn = (const uint16*)(pDIB->pBmp + y * pDIB->nPitch);
+		pSprite->pRows[y].wFirstRun = (uint16)(pRun - pSprite->pRuns);
+		pSprite->pRows[y].dwFirstPixel = dwPixel;
+
+		x = 0;
+		while(x < pDIB->cx)
+		{
+			while(x < pDIB->cx && pIn[x] == wKey)
+			{	x++;	}
+			if(x == pDIB->cx)
+			{	break;	}
+
+			xStart = x;
+			for(; x < pDIB->cx && pIn[x] != wKey; x++, dwPixel++)
+			{
+				if(pSprite->pIndices)
+				{	pSprite->pIndices[dwPixel] = (uint8)HamletPalette_Index(pPalette, pMap, pIn[x], FALSE);	}
+				else
+				{	pSprite->pPixels[dwPixel] = pIn[x];		}
+			}
+			pRun->x = (uint16)xStart;
+			pRun->cx = (uint16)(x - xStart);
+			pRun++;
+			pSprite->pRows[y].nRuns++;
+		}
+	}
+	if(pMap)
+	{	FREE(pMap);	}
+	return SUCCESS;
+}
+
+//the color's entry, added at the end when bAdd; -1 when it is not there or the palette is full
+static int HamletPalette_Index(HamletPalette* pPalette, HamletPaletteMap* pMap, uint16 wColor, boolean bAdd)
+{
+	uint32 dwSlot = HamletPaletteMap_Slot(pMap, wColor);
+
+	if(pMap->wEntries[dwSlot])
+	{	return pMap->wEntries[dwSlot] - 1;	}
+	if(!bAdd || pPalette->nColors == HAMLET_PALETTE_SIZE)
+	{	return -1;	}
+
+	pMap->wColors[dwSlot] = wColor;
+	pMap->wEntries[dwSlot] = (uint16)(pPalette->nColors + 1);
+	pPalette->wColors[pPalette->nColors] = wColor;
+	return pPalette->nColors++;
+}
+
+//a map of the colors the palette has so far, NULL when there is no memory for one
+static HamletPaletteMap* HamletPalette_NewMap(const HamletPalette* pPalette)
+{
+	HamletPaletteMap* pMap = (HamletPaletteMap*)MALLOC(sizeof(HamletPaletteMap));
+	uint32 dwSlot;
+	int i;
+
+	if(pMap == NULL)
+	{	return NULL;	}
+
+	for(i = 0; i < pPalette->nColors; i++)
+	{
+		dwSlot = HamletPaletteMap_Slot(pMap, pPalette->wColors[i]);
+		pMap->wColors[dwSlot] = pPalette->wColors[i];
+		pMap->wEntries[dwSlot] = (uint16)(i + 1);
+	}
+	return pMap;
+}
+
+//the slot the color hashes to, or the first empty one after it when the color is not in the map
+static uint32 HamletPaletteMap_Slot(const HamletPaletteMap* pMap, uint16 wColor)
+{
+	uint32 dwSlot = ((uint32)wColor * 40503u >> 7) & (HAMLET_PALETTE_SLOTS - 1);
+
+	while(pMap->wEntries[dwSlot] && pMap->wColors[dwSlot] != wColor)
+	{	dwSlot = (dwSlot + 1) & (HAMLET_PALETTE_SLOTS - 1);		}
+	return dwSlot;
+}
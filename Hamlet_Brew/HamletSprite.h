@@ -0,0 +1,62 @@
+/*===========================================================================
+
+FILE: HamletSprite.h
+===========================================================================*/
+#ifndef HAMLETSPRITE_H
+#define HAMLETSPRITE_H
+
+#include "AEEShell.h"           // Shell interface definitions
+#include "AEEBitmap.h"          // IDIB
+
+/*-------------------------------------------------------------------
+Run-length sprite. A color-keyed image is rendered once, when it is
+decoded, and every row is stored as the runs of opaque pixels in it.
+Drawing skips the transparent gaps outright and copies each run
+straight into the destination DIB, so there is no per-pixel key test
+and no IPARM_ROP to set up. Only 16-bit DIBs are handled; anything
+else leaves the caller to draw the IImage itself.
+
+Given a palette, a sprite keeps one byte per opaque pixel instead:
+its index into the palette, which the sprites of a cache share and
+which grows by whatever colors each new sprite brings. The runs are
+expanded through it as they are copied. A sprite whose colors do not
+fit in what is left of the palette keeps its pixels as they are.
+-------------------------------------------------------------------*/
+#define HAMLET_PALETTE_SIZE	256
+#define HAMLET_SPRITE_KEY	MAKE_RGB(0xFF, 0x00, 0xFF)	// magenta, the transparent color of the BMPs
+
+typedef struct _HamletPalette {
+	uint8		nColorScheme;	// of the DIBs its colors came from, IDIB_COLORSCHEME_*
+	uint16		nColors;
+	uint16		wColors[HAMLET_PALETTE_SIZE];	// native
+} HamletPalette;
+
+typedef struct _HamletSpriteRun {
+	uint16		x;				// first opaque pixel of the run, from the left edge
+	uint16		cx;
+} HamletSpriteRun;
+
+typedef struct _HamletSpriteRow {
+	uint16		nRuns;
+	uint16		wFirstRun;		// index into pRuns
+	uint32		dwFirstPixel;	// index into pPixels
+} HamletSpriteRow;
+
+typedef struct _HamletSprite {
+	uint16				cx;
+	uint16				cy;
+	uint8				nColorScheme;	// of the DIB it was rendered into, IDIB_COLORSCHEME_*
+	HamletSpriteRow*	pRows;			// NULL when there is no sprite; one block holds rows, runs and pixels
+	HamletSpriteRun*	pRuns;
+	uint16*				pPixels;		// the opaque pixels only, row after row; NULL when pIndices has them
+	uint8*				pIndices;		// the same as indices into pPalette
+	const HamletPalette*	pPalette;
+	uint32				dwOpaque;
+} HamletSprite;
+
+int		HamletSprite_Build(HamletSprite* pSprite, IDisplay* pIDisplay, IImage* pImage, HamletPalette* pPalette);	//pPalette may be NULL
+int		HamletSprite_BuildFromBitmap(HamletSprite* pSprite, IBitmap* pBitmap, HamletPalette* pPalette);
+boolean	HamletSprite_Draw(const HamletSprite* pSprite, IDIB* pDIB, const AEERect* prcClip, int x, int y, AEERect* prcDrawn);
+void	HamletSprite_Free(HamletSprite* pSprite);
+
+#endif // HAMLETSPRITE_H
@@ -0,0 +1,82 @@
+/*===========================================================================
+
+FILE: HamletState.c
+===========================================================================*/
+
+
+/*===============================================================================
+INCLUDES AND VARIABLE DEFINITIONS
+=============================================================================== */
+#include "AEEShell.h"           // Shell interface definitions
+#include "AEEStdLib.h"          // MEMSET etc.
+#include "AEEFile.h"			// File interface definitions
+
+#include "HamletState.h"
+
+/*===============================================================================
+FUNCTION DEFINITIONS
+=============================================================================== */
+
+int HamletState_Save(IShell* pIShell, const HamletSnapshot* pSnap)
+{
+	IFileMgr* pIFileMgr = NULL;
+	IFile* pIFile;
+	int nErr = EFAILED;
+
+	if(ISHELL_CreateInstance(pIShell, AEECLSID_FILEMGR, (void **)&pIFileMgr) != SUCCESS)
+	{	return ECLASSNOTSUPPORT;	}
+
+	//_OFM_CREATE fails on a file that is there already, like one another version left behind
+	if(IFILEMGR_Test(pIFileMgr, HAMLET_STATE_FILE) == SUCCESS)
+	{	IFILEMGR_Remove(pIFileMgr, HAMLET_STATE_FILE);	}
+	pIFile = IFILEMGR_OpenFile(pIFileMgr, HAMLET_STATE_FILE, _OFM_CREATE);
+	if(pIFile)
+	{
+		if(IFILE_Write(pIFile, pSnap, sizeof(HamletSnapshot)) == sizeof(HamletSnapshot))
+		{	nErr = SUCCESS;		}
+		IFILE_Release(pIFile);
+	}
+
+	//half a snapshot is worse than none
+	if(nErr != SUCCESS)
+	{	IFILEMGR_Remove(pIFileMgr, HAMLET_STATE_FILE);	}
+	IFILEMGR_Release(pIFileMgr);
+	return nErr;
+}
+
+int HamletState_Load(IShell* pIShell, HamletSnapshot* pSnap)
+{
+	IFileMgr* pIFileMgr = NULL;
+	IFile* pIFile;
+	int nErr = EFAILED;
+
+	MEMSET(pSnap, 0, sizeof(HamletSnapshot));
+	if(ISHELL_CreateInstance(pIShell, AEECLSID_FILEMGR, (void **)&pIFileMgr) != SUCCESS)
+	{	return ECLASSNOTSUPPORT;	}
+
+	pIFile = IFILEMGR_OpenFile(pIFileMgr, HAMLET_STATE_FILE, _OFM_READ);
+	if(pIFile)
+	{
+		if(IFILE_Read(pIFile, pSnap, sizeof(HamletSnapshot)) == sizeof(HamletSnapshot)
+			&& pSnap->dwMagic == HAMLET_STATE_MAGIC && pSnap->wVersion == HAMLET_STATE_VERSION)
+		{	nErr = SUCCESS;		}
+		IFILE_Release(pIFile);
+	}
+	IFILEMGR_Release(pIFileMgr);
+
+	if(nErr != SUCCESS)
+	{	MEMSET(pSnap, 0, sizeof(HamletSnapshot));	}
+	return nErr;
+}
+
+void HamletState_Remove(IShell* pIShell)
+{
+	IFileMgr* pIFileMgr = NULL;
+
+	if(ISHELL_CreateInstance(pIShell, AEECLSID_FILEMGR, (void **)&pIFileMgr) != SUCCESS)
+	{	return;		}
+
+	if(IFILEMGR_Test(pIFileMgr, HAMLET_STATE_FILE) == SUCCESS)
+	{	IFILEMGR_Remove(pIFileMgr, HAMLET_STATE_FILE);	}
+	IFILEMGR_Release(pIFileMgr);
+}
@@ -0,0 +1,44 @@
+/*===========================================================================
+
+FILE: HamletState.h
+===========================================================================*/
+#ifndef HAMLETSTATE_H
+#define HAMLETSTATE_H
+
+#include "AEEShell.h"           // Shell interface definitions
+
+/*-------------------------------------------------------------------
+Suspend snapshot. Everything the story needs to put the frame on
+screen back and carry on from it fits in a few bytes: which frame,
+which branch, the set pieces picked with the 1-6 keys and how long
+the next frame still had to wait. It is written to HAMLET_STATE_FILE
+on EVT_APP_SUSPEND and removed once it has been used, so a file left
+over means the applet was stopped while suspended and the next
+EVT_APP_START picks the story up from there.
+-------------------------------------------------------------------*/
+#define HAMLET_STATE_FILE		"hamlet.sav"
+#define HAMLET_STATE_MAGIC		0x56415348	// "HSAV"
+#define HAMLET_STATE_VERSION	1
+
+#define HAMLET_STATE_TIMED		0x01	// the next frame was on a timer
+#define HAMLET_STATE_REPLAY		0x02	// EVT_HAMLET_REPLAY was on
+
+//on-disk layout, little endian like the handset
+typedef struct _HamletSnapshot {
+	uint32		dwMagic;
+	uint16		wVersion;
+	uint8		nFrame;			// gStory index of the frame on screen
+	uint8		nLevel;			// what the next timer or EVT_COMMAND starts
+	uint8		nBranch;		// MENUID_* picked at the menu
+	uint8		nFlags;			// HAMLET_STATE_*
+	uint16		wBack;			// IMG_* of the set pieces
+	uint16		wWall;
+	uint16		wText;			// string in the text box, 0 for none
+	uint32		dwRemaining;	// ms the next frame still had to wait
+} HamletSnapshot;
+
+int		HamletState_Save(IShell* pIShell, const HamletSnapshot* pSnap);
+int		HamletState_Load(IShell* pIShell, HamletSnapshot* pSnap);	// EFAILED when there is none or it is not this version's
+void	HamletState_Remove(IShell* pIShell);
+
+#endif // HAMLETSTATE_H
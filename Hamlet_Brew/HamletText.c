@@ -0,0 +1,394 @@
+/*===========================================================================
+
+FILE: HamletText.c
+===========================================================================*/
+
+
+/*===============================================================================
+INCLUDES AND VARIABLE DEFINITIONS
+=============================================================================== */
+#include "AEEShell.h"           // Shell interface definitions
+#include "AEEStdLib.h"          // MEMSET etc.
+#include "AEEBitmap.h"          // the glyph atlas' canvas
+
+#include "HamletText.h"
+
+#define HAMLET_TEXT_LOADMAX	256		// longest string a resource-file load can return
+#define HAMLET_ATLAS_ROWS	((HAMLET_GLYPHS + HAMLET_GLYPHS_ACROSS - 1) / HAMLET_GLYPHS_ACROSS)
+
+static const AECHAR gszEmpty[1] = { 0 };
+
+static int					HamletText_Load(HamletText* pText, HamletResIndex* pRes, uint16 wResID);
+static HamletGlyphAtlas*	HamletText_Atlas(HamletGlyphCache* pCache, AEEFont nFont);
+static int					HamletText_BuildAtlas(HamletGlyphCache* pCache, HamletGlyphAtlas* pAtlas, AEEFont nFont);
+static void					HamletText_DrawGlyphs(HamletGlyphAtlas* pAtlas, IDIB* pDIB, const HamletTextLine* pLine,
+												  const AEERect* prcClip, AEERect* prcDrawn);
+
+/*===============================================================================
+FUNCTION DEFINITIONS
+=============================================================================== */
+
+//looks up and converts every string in the list, once
+int HamletText_Init(HamletTextTable* pTable, HamletResIndex* pRes, const uint16* pwResIDs, int nCount)
+{
+	uint16 wLast = 0;
+	int nErr = SUCCESS;
+	int i;
+
+	MEMSET(pTable, 0, sizeof(HamletTextTable));
+	if(nCount <= 0)
+	{	return SUCCESS;		}
+
+	pTable->wFirstID = 0xFFFF;
+	for(i = 0; i < nCount; i++)
+	{
+		pTable->wFirstID = MIN(pTable->wFirstID, pwResIDs[i]);
+		wLast = MAX(wLast, pwResIDs[i]);
+	}
+	pTable->nSlots = (uint16)(wLast - pTable->wFirstID + 1);
+	pTable->pSlots = (HamletText*)MALLOC(pTable->nSlots * sizeof(HamletText));
+	if(pTable->pSlots == NULL)
+	{
+		pTable->nSlots = 0;
+		return ENOMEMORY;
+	}
+
+	for(i = 0; i < nCount; i++)
+	{
+		if(HamletText_Load(&pTable->pSlots[pwResIDs[i] - pTable->wFirstID], pRes, pwResIDs[i]) != SUCCESS)
+		{	nErr = ENOMEMORY;	}
+	}
+	return nErr;
+}
+
+//ready to draw, no load or copy; an ID outside the table gives the empty string
+const AECHAR* HamletText_Get(HamletTextTable* pTable, uint16 wResID, int* pnLen)
+{
+	HamletText* pText = NULL;
+
+	if(wResID >= pTable->wFirstID && wResID - pTable->wFirstID < pTable->nSlots)
+	{	pText = &pTable->pSlots[wResID - pTable->wFirstID];	}
+
+	if(pText == NULL || pText->pText == NULL)
+	{
+		if(pnLen)	{	*pnLen = 0;	}
+		return gszEmpty;
+	}
+
+	if(pnLen)	{	*pnLen = pText->nLen;	}
+	return pText->pText;
+}
+
+void HamletText_Free(HamletTextTable* pTable)
+{
+	int i;
+
+	for(i = 0; i < pTable->nSlots; i++)
+	{
+		if(pTable->pSlots[i].pOwned)
+		{	FREE(pTable->pSlots[i].pOwned);	}
+	}
+	if(pTable->pSlots)
+	{	FREE(pTable->pSlots);	}
+	MEMSET(pTable, 0, sizeof(HamletTextTable));
+}
+
+void HamletText_InitGlyphs(HamletGlyphCache* pCache, IDisplay* pIDisplay, HamletTextTable* pTable)
+{
+	MEMSET(pCache, 0, sizeof(HamletGlyphCache));
+	pCache->pIDisplay = pIDisplay;
+	pCache->pTable = pTable;
+}
+
+//breaks wResID into the lines that fit prc, the way the handset's IStatic does, unless that was done before
+const HamletTextLayout* HamletText_Layout(HamletGlyphCache* pCache, uint16 wResID, AEEFont nFont, const AEERect* prc)
+{
+	HamletTextLine lines[HAMLET_LAYOUT_LINES];
+	HamletTextLayout* pLayout;
+	HamletGlyphAtlas* pAtlas;
+	const AECHAR* pText;
+	boolean bGlyphs;
+	int cyLine;
+	int nLines = 0;
+	int y;
+	int nFits;
+	int nBreak;
+	int i;
+
+	for(i = 0; i < HAMLET_LAYOUTS; i++)
+	{
+		pLayout = &pCache->layouts[i];
+		if(pLayout->wResID == wResID && pLayout->nFont == nFont && pLayout->rc.x == prc->x && pLayout->rc.y == prc->y
+		   && pLayout->rc.dx == prc->dx && pLayout->rc.dy == prc->dy)
+		{	return pLayout;	}
+	}
+
+	pAtlas = HamletText_Atlas(pCache, nFont);
+	bGlyphs = (pAtlas && pAtlas->sprite.pRows);
+	cyLine = IDISPLAY_GetFontMetrics(pCache->pIDisplay, nFont, NULL, NULL);
+
+	//a line ends at a '\n', or at the last space that still fits, or wherever the width runs out
+	pText = HamletText_Get(pCache->pTable, wResID, NULL);
+	y = prc->y;
+	while(*pText && y < prc->y + prc->dy && nLines < HAMLET_LAYOUT_LINES)
+	{
+		IDISPLAY_MeasureTextEx(pCache->pIDisplay, nFont, pText, -1, prc->dx, &nFits);
+		nBreak = -1;
+		for(i = 0; pText[i] && i <= nFits; i++)
+		{
+			if(pText[i] == '\n')
+			{
+				nBreak = i;
+				break;
+			}
+			if(pText[i] == ' ')
+			{	nBreak = i;	}
+		}
+		if(pText[i] == 0 && i <= nFits)
+		{	nBreak = i;		}
+		else if(nBreak < 0)
+		{	nBreak = MAX(1, nFits);	}
+
+		for(i = 0; i < nBreak; i++)
+		{
+			if(pText[i] < HAMLET_GLYPH_FIRST || pText[i] >= HAMLET_GLYPH_FIRST + HAMLET_GLYPHS)
+			{	bGlyphs = FALSE;	}
+		}
+		lines[nLines].pText = pText;
+		lines[nLines].nLen = (int16)nBreak;
+		lines[nLines].x = prc->x;
+		lines[nLines].y = (int16)y;
+		nLines++;
+
+		y += cyLine;
+		pText += nBreak;
+		if(*pText == ' ' || *pText == '\n')
+		{	pText++;	}
+	}
+
+	//take the next slot round, the layout in it can be made again
+	pLayout = &pCache->layouts[pCache->nNextLayout];
+	pCache->nNextLayout = (pCache->nNextLayout + 1) % HAMLET_LAYOUTS;
+	if(pLayout->pLines)
+	{	FREE(pLayout->pLines);	}
+	MEMSET(pLayout, 0, sizeof(HamletTextLayout));
+	if(nLines)
+	{
+		pLayout->pLines = (HamletTextLine*)MALLOC(nLines * sizeof(HamletTextLine));
+		if(pLayout->pLines == NULL)
+		{	return NULL;	}
+		MEMCPY(pLayout->pLines, lines, nLines * sizeof(HamletTextLine));
+	}
+	pLayout->wResID = wResID;
+	pLayout->nFont = nFont;
+	pLayout->rc = *prc;
+	pLayout->yEnd = (int16)y;
+	pLayout->bGlyphs = bGlyphs;
+	pLayout->nLines = nLines;
+	return pLayout;
+}
+
+//glyph blits into the display's DIB when it takes them, IDISPLAY_DrawText otherwise
+void HamletText_Draw(HamletGlyphCache* pCache, const HamletTextLayout* pLayout)
+{
+	HamletGlyphAtlas* pAtlas = HamletText_Atlas(pCache, pLayout->nFont);
+	const HamletTextLine* pLine;
+	IBitmap* pDest = NULL;
+	IDIB* pDIB = NULL;
+	AEERect rcDrawn;
+	int i;
+
+	if(pLayout->bGlyphs && pAtlas && IDISPLAY_GetDestination(pCache->pIDisplay, &pDest) == SUCCESS
+	   && IBITMAP_QueryInterface(pDest, AEECLSID_DIB, (void **)&pDIB) == SUCCESS
+	   && (pDIB->nDepth != 16 || pDIB->nColorScheme != pAtlas->sprite.nColorScheme))
+	{
+		IDIB_Release(pDIB);
+		pDIB = NULL;
+	}
+
+	if(pDIB == NULL)
+	{	IDISPLAY_SetClipRect(pCache->pIDisplay, &pLayout->rc);	}
+	for(i = 0; i < pLayout->nLines; i++)
+	{
+		pLine = &pLayout->pLines[i];
+		if(pDIB)
+		{
+			HamletText_DrawGlyphs(pAtlas, pDIB, pLine, &pLayout->rc, &rcDrawn);
+			if(rcDrawn.dx > 0 && rcDrawn.dy > 0)
+			{	IBITMAP_Invalidate(pDest, &rcDrawn);	}
+		}
+		else
+		{
+			IDISPLAY_DrawText(pCache->pIDisplay, pLayout->nFont, pLine->pText, pLine->nLen, pLine->x, pLine->y,
+							  NULL, IDF_TEXT_TRANSPARENT);
+		}
+	}
+	if(pDIB == NULL)
+	{	IDISPLAY_SetClipRect(pCache->pIDisplay, NULL);	}
+
+	if(pDIB)
+	{	IDIB_Release(pDIB);		}
+	if(pDest)
+	{	IBITMAP_Release(pDest);	}
+}
+
+void HamletText_FreeGlyphs(HamletGlyphCache* pCache)
+{
+	int i;
+
+	for(i = 0; i < HAMLET_FONTS; i++)
+	{	HamletSprite_Free(&pCache->atlas[i].sprite);	}
+	for(i = 0; i < HAMLET_LAYOUTS; i++)
+	{
+		if(pCache->layouts[i].pLines)
+		{	FREE(pCache->layouts[i].pLines);	}
+	}
+	MEMSET(pCache, 0, sizeof(HamletGlyphCache));
+}
+
+//a baked view when the bundle has one, otherwise a converted copy
+static int HamletText_Load(HamletText* pText, HamletResIndex* pRes, uint16 wResID)
+{
+	AECHAR szBuf[HAMLET_TEXT_LOADMAX];
+	const AECHAR* pView;
+	int nLen;
+	int i;
+
+	pView = HamletRes_GetString(pRes, wResID, &nLen);
+	for(i = 0; pView && i < nLen; i++)
+	{
+		if(pView[i] == '^')
+		{	break;	}
+	}
+	if(pView && i == nLen)
+	{
+		pText->pText = pView;
+		pText->nLen = nLen;
+		return SUCCESS;
+	}
+
+	nLen = HamletRes_LoadString(pRes, wResID, szBuf, sizeof(szBuf));
+	pText->pOwned = (AECHAR*)MALLOC((nLen + 1) * sizeof(AECHAR));
+	if(pText->pOwned == NULL)
+	{	return ENOMEMORY;	}
+
+	//'^' is how the resource file writes a line break
+	for(i = 0; i < nLen; i++)
+	{	pText->pOwned[i] = (szBuf[i] == '^') ? '\n' : szBuf[i];	}
+	pText->pOwned[nLen] = 0;
+	pText->pText = pText->pOwned;
+	pText->nLen = nLen;
+	return SUCCESS;
+}
+
+//nFont's atlas, built the first time it is asked for; NULL for a font the cache has no slot for
+static HamletGlyphAtlas* HamletText_Atlas(HamletGlyphCache* pCache, AEEFont nFont)
+{
+	HamletGlyphAtlas* pAtlas;
+	int nIndex = (int)nFont - (int)AEE_FONT_NORMAL;
+
+	if(nIndex < 0 || nIndex >= HAMLET_FONTS)
+	{	return NULL;	}
+
+	pAtlas = &pCache->atlas[nIndex];
+	if(!pAtlas->bTried)
+	{
+		pAtlas->bTried = TRUE;
+		HamletText_BuildAtlas(pCache, pAtlas, nFont);
+	}
+	return pAtlas->sprite.pRows ? pAtlas : NULL;
+}
+
+//draws every glyph once, each in its own cell of a key-filled canvas, and keeps the text pixels
+static int HamletText_BuildAtlas(HamletGlyphCache* pCache, HamletGlyphAtlas* pAtlas, AEEFont nFont)
+{
+	IDisplay* pIDisplay = pCache->pIDisplay;
+	IBitmap* pDevice = NULL;
+	IBitmap* pCanvas = NULL;
+	IBitmap* pOldDest = NULL;
+	AEERect rcAll;
+	AECHAR ch;
+	int nErr;
+	int i;
+
+	pAtlas->cxCell = 1;
+	pAtlas->cyLine = (int16)IDISPLAY_GetFontMetrics(pIDisplay, nFont, NULL, NULL);
+	for(i = 0; i < HAMLET_GLYPHS; i++)
+	{
+		ch = (AECHAR)(HAMLET_GLYPH_FIRST + i);
+		pAtlas->cxGlyph[i] = (uint8)IDISPLAY_MeasureTextEx(pIDisplay, nFont, &ch, 1, -1, NULL);
+		pAtlas->cxCell = (int16)MAX(pAtlas->cxCell, pAtlas->cxGlyph[i]);
+	}
+	if(pAtlas->cyLine <= 0)
+	{	return EFAILED;		}
+
+	nErr = IDISPLAY_GetDeviceBitmap(pIDisplay, &pDevice);
+	if(nErr == SUCCESS)
+	{
+		nErr = IBITMAP_CreateCompatibleBitmap(pDevice, &pCanvas, (uint16)(HAMLET_GLYPHS_ACROSS * pAtlas->cxCell),
+											  (uint16)(HAMLET_ATLAS_ROWS * pAtlas->cyLine));
+		IBITMAP_Release(pDevice);
+	}
+
+	if(nErr == SUCCESS)
+	{
+		rcAll.x = 0;
+		rcAll.y = 0;
+		rcAll.dx = (int16)(HAMLET_GLYPHS_ACROSS * pAtlas->cxCell);
+		rcAll.dy = (int16)(HAMLET_ATLAS_ROWS * pAtlas->cyLine);
+
+		IDISPLAY_GetDestination(pIDisplay, &pOldDest);
+		IDISPLAY_SetDestination(pIDisplay, pCanvas);
+		IDISPLAY_SetClipRect(pIDisplay, NULL);
+		IDISPLAY_FillRect(pIDisplay, &rcAll, HAMLET_SPRITE_KEY);
+		for(i = 0; i < HAMLET_GLYPHS; i++)
+		{
+			ch = (AECHAR)(HAMLET_GLYPH_FIRST + i);
+			IDISPLAY_DrawText(pIDisplay, nFont, &ch, 1, (i % HAMLET_GLYPHS_ACROSS) * pAtlas->cxCell,
+							  (i / HAMLET_GLYPHS_ACROSS) * pAtlas->cyLine, NULL, IDF_TEXT_TRANSPARENT);
+		}
+		IDISPLAY_SetDestination(pIDisplay, pOldDest);
+		IBITMAP_Release(pOldDest);
+
+		nErr = HamletSprite_BuildFromBitmap(&pAtlas->sprite, pCanvas, &pCache->palette);
+	}
+
+	if(pCanvas)
+	{	IBITMAP_Release(pCanvas);	}
+	return nErr;
+}
+
+//one line's glyphs, each clipped to its own cell and prcClip; prcDrawn gets the part of the line that was inside
+static void HamletText_DrawGlyphs(HamletGlyphAtlas* pAtlas, IDIB* pDIB, const HamletTextLine* pLine,
+								  const AEERect* prcClip, AEERect* prcDrawn)
+{
+	AEERect rcCell;
+	AEERect rcGlyph;
+	int xLeft = MAX(prcClip->x, 0);
+	int xRight = MIN(prcClip->x + prcClip->dx, pDIB->cx);
+	int yTop = MAX(MAX(prcClip->y, 0), pLine->y);
+	int yBottom = MIN(MIN(prcClip->y + prcClip->dy, pDIB->cy), pLine->y + pAtlas->cyLine);
+	int x = pLine->x;
+	int n;
+	int i;
+
+	rcCell.y = (int16)yTop;
+	rcCell.dy = (int16)(yBottom - yTop);
+	for(i = 0; i < pLine->nLen; i++)
+	{
+		n = pLine->pText[i] - HAMLET_GLYPH_FIRST;
+		if(n > 0)	//a space has nothing to draw
+		{
+			rcCell.x = (int16)MAX(x, xLeft);
+			rcCell.dx = (int16)(MIN(x + pAtlas->cxGlyph[n], xRight) - rcCell.x);
+			HamletSprite_Draw(&pAtlas->sprite, pDIB, &rcCell, x - (n % HAMLET_GLYPHS_ACROSS) * pAtlas->cxCell,
+							  pLine->y - (n / HAMLET_GLYPHS_ACROSS) * pAtlas->cyLine, &rcGlyph);
+		}
+		x += pAtlas->cxGlyph[n];
+	}
+
+	prcDrawn->x = (int16)MAX(pLine->x, xLeft);
+	prcDrawn->y = (int16)yTop;
+	prcDrawn->dx = (int16)(MIN(x, xRight) - prcDrawn->x);
+	prcDrawn->dy = (int16)(yBottom - yTop);
+}
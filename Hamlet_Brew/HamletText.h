@@ -0,0 +1,97 @@
+/*===========================================================================
+
+FILE: HamletText.h
+===========================================================================*/
+#ifndef HAMLETTEXT_H
+#define HAMLETTEXT_H
+
+#include "AEEShell.h"           // Shell interface definitions
+#include "AEEDisp.h"            // IDisplay and its fonts
+
+#include "HamletRes.h"
+#include "HamletSprite.h"
+
+/*-------------------------------------------------------------------
+Text table. Every string the applet shows is looked up once, in
+Hamlet_InitAppData, and kept ready to draw: '^' already turned into
+'\n' and the length known. Strings the bundle carries baked (hamlet_pack
+does it) are views into the mapping; anything else is loaded and
+converted once into a copy the table owns.
+-------------------------------------------------------------------*/
+typedef struct _HamletText {
+	const AECHAR*	pText;		// NULL for an ID the table does not hold
+	int				nLen;
+	AECHAR*			pOwned;		// the converted copy, when pText is not a view
+} HamletText;
+
+typedef struct _HamletTextTable {
+	uint16			wFirstID;
+	uint16			nSlots;
+	HamletText*		pSlots;		// indexed by wResID - wFirstID
+} HamletTextTable;
+
+int				HamletText_Init(HamletTextTable* pTable, HamletResIndex* pRes, const uint16* pwResIDs, int nCount);
+const AECHAR*	HamletText_Get(HamletTextTable* pTable, uint16 wResID, int* pnLen);	//never NULL
+void			HamletText_Free(HamletTextTable* pTable);
+
+/*-------------------------------------------------------------------
+Glyph cache. The first time a font is used every printable character
+of it is drawn once, into cells eight to a row of an offscreen bitmap,
+and kept as a run-length sprite: the font's glyph atlas. Laying a
+string out (breaking it into lines that fit a rect, placing each line)
+is done once too, and the result is kept by string ID, font and rect.
+Drawing a paragraph seen before is then nothing but glyph blits
+straight into the display's DIB; text a glyph cannot be blitted for
+(a character outside the atlas, a display the sprite does not fit)
+goes to IDISPLAY_DrawText a line at a time instead.
+
+The atlas is drawn in the display's text color of the moment, which
+the applet never changes.
+-------------------------------------------------------------------*/
+#define HAMLET_GLYPH_FIRST	' '
+#define HAMLET_GLYPHS		('~' - HAMLET_GLYPH_FIRST + 1)
+#define HAMLET_GLYPHS_ACROSS	8		// cells in a row of the atlas, all a run of the row may have to be walked past
+#define HAMLET_FONTS		3		// AEE_FONT_NORMAL, AEE_FONT_BOLD and AEE_FONT_LARGE
+#define HAMLET_LAYOUTS		24		// more than the text table has strings
+#define HAMLET_LAYOUT_LINES	32
+
+typedef struct _HamletGlyphAtlas {
+	boolean			bTried;			// built, or found not to build
+	int16			cxCell;			// the widest advance
+	int16			cyLine;			// ascent plus descent
+	uint8			cxGlyph[HAMLET_GLYPHS];	// advance of each, glyph n is in cell n of the atlas
+	HamletSprite	sprite;			// no rows when the atlas could not be built
+} HamletGlyphAtlas;
+
+typedef struct _HamletTextLine {
+	const AECHAR*	pText;			// into the text table
+	int16			nLen;
+	int16			x;
+	int16			y;				// top of the line
+} HamletTextLine;
+
+typedef struct _HamletTextLayout {
+	uint16			wResID;			// 0 for a free slot
+	AEEFont			nFont;
+	AEERect			rc;				// lines start at its top left, break to fit its width and stop at its bottom
+	int16			yEnd;			// below the last line
+	boolean			bGlyphs;		// every character is in the atlas
+	int				nLines;
+	HamletTextLine*	pLines;
+} HamletTextLayout;
+
+typedef struct _HamletGlyphCache {
+	IDisplay*			pIDisplay;
+	HamletTextTable*	pTable;
+	HamletGlyphAtlas	atlas[HAMLET_FONTS];	// by nFont - AEE_FONT_NORMAL
+	HamletPalette		palette;		// the atlases' few colors, so a text pixel is kept in a byte
+	HamletTextLayout	layouts[HAMLET_LAYOUTS];
+	int					nNextLayout;	// the slot a new layout replaces once all are taken
+} HamletGlyphCache;
+
+void					HamletText_InitGlyphs(HamletGlyphCache* pCache, IDisplay* pIDisplay, HamletTextTable* pTable);
+const HamletTextLayout*	HamletText_Layout(HamletGlyphCache* pCache, uint16 wResID, AEEFont nFont, const AEERect* prc);	//NULL without memory
+void					HamletText_Draw(HamletGlyphCache* pCache, const HamletTextLayout* pLayout);	//clipped to its rect, no update
+void					HamletText_FreeGlyphs(HamletGlyphCache* pCache);
+
+#endif // HAMLETTEXT_H
@@ -0,0 +1,155 @@
+/*===========================================================================
+
+FILE: HamletTiming.c
+===========================================================================*/
+
+
+/*===============================================================================
+INCLUDES AND VARIABLE DEFINITIONS
+=============================================================================== */
+#include "AEEShell.h"           // Shell interface definitions
+#include "AEEStdLib.h"          // MEMSET, GETUPTIMEMS, DBGPRINTF
+
+#include "HamletTiming.h"
+
+static int HamletTiming_Bucket(uint32 dwLate);
+
+/*===============================================================================
+FUNCTION DEFINITIONS
+=============================================================================== */
+
+void HamletTiming_Init(HamletTiming* pTiming)
+{
+	MEMSET(pTiming, 0, sizeof(HamletTiming));
+	pTiming->nMaxLateFrame = -1;
+}
+
+//anchors a new chain at the current time; whatever was pending before is forgotten
+void HamletTiming_Start(HamletTiming* pTiming)
+{
+	pTiming->dwAnchor = GETUPTIMEMS();
+	pTiming->dwOffset = 0;
+	pTiming->bPending = FALSE;
+	pTiming->bHeld = FALSE;
+}
+
+//the next frame is due dwDelay after the previous one was due, not after now
+int32 HamletTiming_Schedule(HamletTiming* pTiming, uint32 dwDelay)
+{
+	int32 nWait;
+
+	pTiming->dwOffset += dwDelay;
+	pTiming->bPending = TRUE;
+	pTiming->bHeld = FALSE;
+
+	//unsigned differences, so GETUPTIMEMS wrapping around does not matter
+	nWait = (int32)(pTiming->dwAnchor + pTiming->dwOffset - GETUPTIMEMS());
+	return nWait > 0 ? nWait : 0;
+}
+
+//how long the pending frame still has to wait, 0 once it is late
+boolean HamletTiming_Remaining(const HamletTiming* pTiming, uint32* pdwMs)
+{
+	int32 nWait;
+
+	*pdwMs = 0;
+	if(pTiming->bHeld)
+	{
+		*pdwMs = pTiming->dwHeld;
+		return TRUE;
+	}
+	if(!pTiming->bPending)
+	{	return FALSE;	}
+
+	nWait = (int32)(pTiming->dwAnchor + pTiming->dwOffset - GETUPTIMEMS());
+	if(nWait > 0)
+	{	*pdwMs = (uint32)nWait;	}
+	return TRUE;
+}
+
+//a second EVT_APP_SUSPEND before the resume has to find the same wait left as the first one did
+void HamletTiming_Cancel(HamletTiming* pTiming)
+{
+	if(!pTiming->bPending)
+	{	return;		}
+
+	HamletTiming_Remaining(pTiming, &pTiming->dwHeld);
+	pTiming->bHeld = TRUE;
+	pTiming->bPending = FALSE;
+}
+
+//the pending frame's timer went off; nFrame is the story frame it brings up
+void HamletTiming_Fired(HamletTiming* pTiming, int nFrame)
+{
+	uint32 dwDue;
+	uint32 dwNow;
+	uint32 dwLate;
+
+	if(!pTiming->bPending)
+	{	return;		}
+	pTiming->bPending = FALSE;
+
+	dwDue = pTiming->dwAnchor + pTiming->dwOffset;
+	dwNow = GETUPTIMEMS();
+	dwLate = (int32)(dwNow - dwDue) > 0 ? dwNow - dwDue : 0;
+
+	if(nFrame >= 0 && nFrame < HAMLET_TIMING_FRAMES)
+	{
+		pTiming->frames[nFrame].dwDue = dwDue;
+		pTiming->frames[nFrame].dwFired = dwNow;
+	}
+
+	pTiming->nFired++;
+	pTiming->dwTotalLate += dwLate;
+	pTiming->dwHistogram[HamletTiming_Bucket(dwLate)]++;
+	if(pTiming->nMaxLateFrame < 0 || dwLate > pTiming->dwMaxLate)
+	{
+		pTiming->dwMaxLate = dwLate;
+		pTiming->nMaxLateFrame = nFrame;
+	}
+}
+
+void HamletTiming_Report(const HamletTiming* pTiming)
+{
+	uint32 dwLow;
+	int i;
+
+	if(pTiming->nFired == 0)
+	{	return;		}
+
+	DBGPRINTF("Hamlet timing: %u frames, %u ms late on average, at most %u ms (frame %d)",
+			  pTiming->nFired, pTiming->dwTotalLate / pTiming->nFired, pTiming->dwMaxLate, pTiming->nMaxLateFrame);
+
+	for(i = 0; i < HAMLET_TIMING_FRAMES; i++)
+	{
+		if(pTiming->frames[i].dwDue || pTiming->frames[i].dwFired)
+		{
+			DBGPRINTF("  frame %2d due %8u fired %8u late %d ms", i, pTiming->frames[i].dwDue, pTiming->frames[i].dwFired,
+					  (int)(int32)(pTiming->frames[i].dwFired - pTiming->frames[i].dwDue));
+		}
+	}
+
+	for(i = 0; i < HAMLET_TIMING_BUCKETS; i++)
+	{
+		dwLow = i ? (1u << (i - 1)) : 0;
+		if(i == 0 || i == 1)
+		{	DBGPRINTF("  %3u ms     %u", dwLow, pTiming->dwHistogram[i]);	}
+		else if(i < HAMLET_TIMING_BUCKETS - 1)
+		{	DBGPRINTF("  %3u-%-3u ms %u", dwLow, dwLow * 2 - 1, pTiming->dwHistogram[i]);	}
+		else
+		{	DBGPRINTF("  %3u+ ms    %u", dwLow, pTiming->dwHistogram[i]);	}
+	}
+}
+
+//0 ms in bucket 0, then one bucket per power of two
+static int HamletTiming_Bucket(uint32 dwLate)
+{
+	int nBucket = 0;
+
+	while(dwLate && nBucket < HAMLET_TIMING_BUCKETS - 1)
+	{
+		dwLate >>= 1;
+		nBucket++;
+	}
+	return nBucket;
+}
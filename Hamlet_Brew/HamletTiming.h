@@ -0,0 +1,53 @@
+/*===========================================================================
+
+FILE: HamletTiming.h
+===========================================================================*/
+#ifndef HAMLETTIMING_H
+#define HAMLETTIMING_H
+
+#include "AEEShell.h"           // Shell interface definitions
+
+/*-------------------------------------------------------------------
+Frame scheduler. A chain of timed frames (the story up to the menu,
+or the rest of it after a pick) is anchored at the GETUPTIMEMS it
+started at, and every frame is due at the anchor plus the sum of the
+delays before it. Load and draw time is taken out of the next wait
+instead of being added to it, so lateness does not pile up along the
+500/200/300 ms animations.
+
+Each timed frame also records when it was due and when it actually
+fired. How late frames were is kept in a histogram with power-of-two
+buckets: 0, 1, 2-3, 4-7 ... ms, the last bucket open-ended.
+-------------------------------------------------------------------*/
+#define HAMLET_TIMING_FRAMES	16		// per-frame records, by story frame index
+#define HAMLET_TIMING_BUCKETS	9		// the last one holds 128 ms and up
+
+typedef struct _HamletFrameTime {
+	uint32		dwDue;			// GETUPTIMEMS the frame was scheduled for
+	uint32		dwFired;		// GETUPTIMEMS its timer actually went off
+} HamletFrameTime;
+
+typedef struct _HamletTiming {
+	uint32			dwAnchor;		// GETUPTIMEMS the running chain started at
+	uint32			dwOffset;		// when the pending frame is due, in ms after dwAnchor
+	boolean			bPending;
+	boolean			bHeld;			// HamletTiming_Cancel stopped the pending frame with dwHeld ms to go
+	uint32			dwHeld;
+
+	uint32			nFired;
+	uint32			dwTotalLate;
+	uint32			dwMaxLate;
+	int				nMaxLateFrame;
+	uint32			dwHistogram[HAMLET_TIMING_BUCKETS];
+	HamletFrameTime	frames[HAMLET_TIMING_FRAMES];	// the latest time each frame fired
+} HamletTiming;
+
+void	HamletTiming_Init(HamletTiming* pTiming);
+void	HamletTiming_Start(HamletTiming* pTiming);		// a new chain begins now
+int32	HamletTiming_Schedule(HamletTiming* pTiming, uint32 dwDelay);	// ms to hand ISHELL_SetTimer
+boolean	HamletTiming_Remaining(const HamletTiming* pTiming, uint32* pdwMs);	// FALSE when no frame is pending or held
+void	HamletTiming_Cancel(HamletTiming* pTiming);		// its timer was cancelled: the wait left is held, the clock no longer runs it down
+void	HamletTiming_Fired(HamletTiming* pTiming, int nFrame);
+void	HamletTiming_Report(const HamletTiming* pTiming);	// DBGPRINTFs the frames and the histogram
+
+#endif // HAMLETTIMING_H
@@ -0,0 +1,207 @@
+/*===========================================================================
+
+FILE: BlitBench.c
+
+Times the HostBlit.c kernels on the frame Hamlet.c draws most: a clear,
+then the background, the wall, both characters, the sword and a victim,
+at their on-screen places and sizes. Every path the CPU can run is
+measured for each depth and has to leave the same screen behind as the
+scalar one.
+
+	blit_bench [-n frames]
+
+The sprites are synthetic, shaped like the real ones: the wall is a
+frame around a transparent window, the characters and props are
+ellipses in transparent boxes.
+===========================================================================*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "HostInternal.h"
+
+#define BENCH_CX		HOST_SCREEN_CX
+#define BENCH_CY		HOST_SCREEN_CY
+#define BENCH_SPRITES	6
+#define BENCH_KEY		0xA5u		// fits every depth, so one pattern serves them all
+
+typedef struct _BenchSprite {
+	int		x;
+	int		y;
+	int		cx;
+	int		cy;
+	boolean	bKeyed;
+	boolean	bWindow;		// a frame with a hole instead of an ellipse
+	byte*	pPixels;
+} BenchSprite;
+
+//the scene after Hamlet_DrawScenery, Hamlet_DrawCharacters and one prop on each of two layers
+static BenchSprite gScene[BENCH_SPRITES] =
+{
+	{ 85, 25, 43, 60,	FALSE,	FALSE,	NULL },		// background
+	{ 0,  0,  128, 85,	TRUE,	TRUE,	NULL },		// wall
+	{ 21, 42, 22, 43,	TRUE,	FALSE,	NULL },		// hamlet
+	{ 53, 27, 28, 58,	TRUE,	FALSE,	NULL },		// gertrude
+	{ 5,  52, 23, 22,	TRUE,	FALSE,	NULL },		// sword
+	{ 0,  37, 53, 48,	TRUE,	FALSE,	NULL },		// victim
+};
+
+static uint64_t Bench_NowNs(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static void Bench_Store(byte* p, int nBytes, uint32 dwValue)
+{
+	switch(nBytes)
+	{
+		case 1:	*p = (uint8)dwValue;				break;
+		case 2:	*(uint16*)p = (uint16)dwValue;		break;
+		default:	*(uint32*)p = dwValue;			break;
+	}
+}
+
+//fills every sprite for nBytes per pixel; pixels outside the shape get the key
+static boolean Bench_MakeSprites(int nBytes)
+{
+	BenchSprite* pSprite;
+	boolean bInside;
+	int dx;
+	int dy;
+	int x;
+	int y;
+	int i;
+
+	for(i = 0; i < BENCH_SPRITES; i++)
+	{
+		pSprite = &gScene[i];
+		free(pSprite->pPixels);
+		pSprite->pPixels = (byte*)malloc((size_t)(pSprite->cx * pSprite->cy * nBytes));
+		if(pSprite->pPixels == NULL)
+		{	return FALSE;	}
+
+		for(y = 0; y < pSprite->cy; y++)
+		{
+			for(x = 0; x < pSprite->cx; x++)
+			{
+				dx = 2 * x - pSprite->cx + 1;
+				dy = 2 * y - pSprite->cy + 1;
+				if(!pSprite->bKeyed)
+				{	bInside = TRUE;		}
+				else if(pSprite->bWindow)
+				{	bInside = (x < 12 || x >= pSprite->cx - 40 || y < 10 || y >= pSprite->cy - 10);	}
+				else
+				{	bInside = (dx * dx * pSprite->cy * pSprite->cy + dy * dy * pSprite->cx * pSprite->cx
+							   <= pSprite->cx * pSprite->cx * pSprite->cy * pSprite->cy);	}
+
+				Bench_Store(pSprite->pPixels + (y * pSprite->cx + x) * nBytes, nBytes,
+							bInside ? (uint32)(x * 7 + y * 13 + i) & 0x7F : BENCH_KEY);
+			}
+		}
+	}
+	return TRUE;
+}
+
+//the clear and the six blits, clipped to the screen the way HostBitmap_Blit clips them
+static void Bench_Frame(const HostBlitKernels* pKernels, byte* pScreen, int nBytes)
+{
+	const BenchSprite* pSprite;
+	int nPitch = BENCH_CX * nBytes;
+	int cx;
+	int cy;
+	int i;
+
+	pKernels->pfnFill(pScreen, nPitch, BENCH_CX, BENCH_CY, 0x5A);
+	for(i = 0; i < BENCH_SPRITES; i++)
+	{
+		pSprite = &gScene[i];
+		cx = MIN(pSprite->cx, BENCH_CX - pSprite->x);
+		cy = MIN(pSprite->cy, BENCH_CY - pSprite->y);
+		if(pSprite->bKeyed)
+		{
+			pKernels->pfnKeyed(pScreen + pSprite->y * nPitch + pSprite->x * nBytes, nPitch,
+							   pSprite->pPixels, pSprite->cx * nBytes, cx, cy, BENCH_KEY);
+		}
+		else
+		{
+			pKernels->pfnCopy(pScreen + pSprite->y * nPitch + pSprite->x * nBytes, nPitch,
+							  pSprite->pPixels, pSprite->cx * nBytes, cx, cy);
+		}
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	static const int nDepths[] = { 8, 16, 32 };
+	const HostBlitKernels* pKernels;
+	byte* pScreen;
+	byte* pReference;
+	uint64_t qwStart;
+	double dScalarNs = 0;
+	double dNs;
+	int nFrames = 20000;
+	int nBytes;
+	int nDepth;
+	int nPath;
+	int i;
+
+	for(i = 1; i < argc; i++)
+	{
+		if(strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+		{	nFrames = atoi(argv[++i]);	}
+		else
+		{
+			fprintf(stderr, "usage: %s [-n frames]\n", argv[0]);
+			return 2;
+		}
+	}
+
+	nFrames = MAX(1, nFrames);
+
+	HostBlit_Init();
+	pScreen = (byte*)malloc(BENCH_CX * BENCH_CY * 4);
+	pReference = (byte*)malloc(BENCH_CX * BENCH_CY * 4);
+	if(pScreen == NULL || pReference == NULL)
+	{	return 1;	}
+
+	printf("%d frames of one clear and %d blits on a %dx%d screen\n", nFrames, BENCH_SPRITES, BENCH_CX, BENCH_CY);
+	printf("  depth  path      ns/frame  speedup  selected\n");
+	for(nDepth = 0; nDepth < (int)(sizeof(nDepths)/sizeof(nDepths[0])); nDepth++)
+	{
+		nBytes = nDepths[nDepth] / 8;
+		if(!Bench_MakeSprites(nBytes))
+		{	return 1;	}
+
+		for(nPath = 0; (pKernels = HostBlit_GetPath(nDepths[nDepth], nPath)) != NULL; nPath++)
+		{
+			Bench_Frame(pKernels, pScreen, nBytes);
+			if(nPath == 0)
+			{	memcpy(pReference, pScreen, (size_t)(BENCH_CX * BENCH_CY * nBytes));	}
+			else if(memcmp(pReference, pScreen, (size_t)(BENCH_CX * BENCH_CY * nBytes)) != 0)
+			{
+				fprintf(stderr, "%s drew a different %d-bit frame than scalar\n", pKernels->pszPath, nDepths[nDepth]);
+				return 1;
+			}
+
+			qwStart = Bench_NowNs();
+			for(i = 0; i < nFrames; i++)
+			{	Bench_Frame(pKernels, pScreen, nBytes);	}
+			dNs = (double)(Bench_NowNs() - qwStart) / nFrames;
+			if(nPath == 0)
+			{	dScalarNs = dNs;	}
+
+			printf("  %-6d %-8s %9.0f %8.2fx  %s\n", nDepths[nDepth], pKernels->pszPath, dNs, dScalarNs / dNs,
+				   pKernels == HostBlit_Get(nDepths[nDepth]) ? "*" : "");
+		}
+	}
+
+	for(i = 0; i < BENCH_SPRITES; i++)
+	{	free(gScene[i].pPixels);	}
+	free(pScreen);
+	free(pReference);
+	return 0;
+}
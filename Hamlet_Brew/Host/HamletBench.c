@@ -0,0 +1,532 @@
+/*===========================================================================
+
+FILE: HamletBench.c
+
+Runs the Hamlet.c applet end to end in the host runtime and reports,
+per story level, how many dispatches it took and how long they ran,
+with image decode time and heap traffic alongside.
+
+	hamlet_bench [-a assetdir] [-d appdir] [-b polonius|kenny|splinter|all] [-n runs] [-r] [-u ms] [-v] [-l loops]
+				 [-s ms [-k]] [-m keys] [-g cxXcy] [-c bits] [-p ms]
+
+The applet directory is where it finds hamlet.pak (build/ by default).
+
+Timers run on a virtual clock unless -r asks for real time, so many runs
+take seconds. Every run of a branch has to leave the same trail of
+frames behind; the bench hashes the screen after each dispatch and
+fails when two runs disagree.
+
+-u makes every screen update cost that many ms of virtual time, like a
+slow handset, so late frames show up in the story length. -v lets the
+applet's DBGPRINTFs (its frame timing report among them) through.
+
+-l puts the applet in replay mode: after level 7 it goes back to level
+3 and the bench picks the branch at the menu again, loops more times.
+Once the first pass has decoded the branch's pictures every pass has to
+find the applet with the same objects alive and the heap at the same
+size and peak when it gets back to the menu; the bench fails otherwise.
+
+-s suspends the applet once the story clock has passed that many ms,
+the way an incoming call would, and resumes it right away; with -k it
+is stopped in between and a new one has only the snapshot file to go
+on. Either way the screen has to come back exactly as it was.
+
+-m mashes the 1-6 keys: after a frame of levels 3-7 that many set-piece
+presses go in, cycling through all six. The dispatch after that is the
+one that shows them, so it gets no presses of its own. Their handling
+is timed apart from the levels, along with the screen updates it does.
+
+-g runs the story on a screen of another size than the handset's. The
+applet scales its pictures once, while it starts, so the levels should
+cost about what they do at the handset's size.
+
+-c gives the screen 8 (RGB332) or 32 (RGB888) bits a pixel instead of
+the handset's 16. The applet's sprites and glyph blits only take 16-bit
+bitmaps, so at the other depths it draws through its images instead,
+and the host converts their RGB565 pixels as they go in.
+
+-p picks at the menu once it has been up that many ms of story, the way
+a person who knows the story would, instead of when nothing is left
+scheduled. The applet is then still decoding in the background, and
+whatever it had not got to is decoded in levels 5-7; -p 0 picks before
+the first timer after the menu. With -l the menu gets the rest of its
+decoding done on the next visit, so replays are held to the same heap
+from pass 3 on instead of pass 2.
+
+Startup is the constructor and EVT_APP_START together; first pixel is the
+wall time from AEEClsCreateInstance to the first IDISPLAY_Update that had
+anything to push, which is all a person waits for.
+
+The bench reports how many screen updates a run made, how many of them
+had nothing drawn to push, and how many pixels went out.
+
+Levels are told apart by IDISPLAY_ClearScreen: every level starts with
+one, so a dispatch belongs to the level numbered by the clears so far.
+Each level also reports the most IImages, IStatics, IMenuCtls, menu
+items and heap bytes that were alive at the end of any of its dispatches.
+===========================================================================*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "HostRuntime.h"
+#include "AEEMenu.h"
+#include "Hamlet.bid"
+
+#define BENCH_LEVELS	7
+#define BENCH_BRANCHES	3
+#define BENCH_REPLAY_LEVEL	3			// where a replaying story goes after level 7
+#define BENCH_MENU_LEVEL	4
+#define EVT_HAMLET_REPLAY	(EVT_USER + 1)	// as in Hamlet.c
+#define BENCH_STATE_FILE	"hamlet.sav"	// HAMLET_STATE_FILE
+
+typedef struct _BenchLevel {
+	uint32	nDispatches;
+	uint64_t qwUs;
+	uint32	dwMaxUs;
+	uint32	nDecodes;
+	uint64_t qwDecodeUs;
+	uint32	nAllocs;
+	uint32	nStringLoads;
+
+	// high-water marks after a dispatch
+	uint32	nLiveImages;
+	uint32	nLiveStatics;
+	uint32	nLiveMenus;
+	uint32	nLiveMenuItems;
+	uint32	dwLiveBytes;
+} BenchLevel;
+
+// what is alive whenever a replaying story waits at the menu
+typedef struct _BenchSnapshot {
+	uint32	nObjects;
+	uint32	nMenuItems;
+	uint32	dwLiveBytes;
+	uint32	dwPeakBytes;
+} BenchSnapshot;
+
+typedef struct _BenchResult {
+	BenchLevel	levels[BENCH_LEVELS + 1];	// by level, [0] unused
+	uint64_t	qwStartupUs;
+	uint64_t	qwFirstPixelUs;	// from AEEClsCreateInstance to the first screen update
+	uint32		dwPeakBytes;
+	uint32		dwLeakBytes;
+	uint32		nLiveObjects;
+	uint32		nRuns;
+	uint32		dwDigest;		// screen after every dispatch, folded together
+	uint32		dwStoryMs;		// on the host's clock
+	uint32		nPasses;		// through the menu, per run
+	uint32		nSettled;		// the pass from which the menu has to look the same
+	BenchSnapshot	settled;	// the menu on that pass, when the branch is decoded
+	BenchSnapshot	last;		// and on the last one
+
+	uint32		nResumes;
+	uint64_t	qwResumeUs;		// from EVT_APP_SUSPEND's return to the frame being back
+	uint32		nResumeDecodes;
+
+	uint32		nKeys;			// -m presses
+	uint64_t	qwKeyUs;
+	uint32		nKeyUpdates;
+
+	uint32		nUpdates;		// IDISPLAY_Updates, over all runs
+	uint32		nEmptyUpdates;
+	uint64_t	qwPixelsPushed;
+} BenchResult;
+
+static const char* gBranchNames[BENCH_BRANCHES] = { "polonius", "kenny", "splinter" };
+
+//FNV-1a over the screen's bytes, continuing from dwHash
+static uint32 Bench_Hash(IShell* pIShell, uint32 dwHash)
+{
+	const byte* pPixels;
+	int cx;
+	int cy;
+	int nDepth;
+	int i;
+
+	pPixels = Host_GetFramebuffer(pIShell, &cx, &cy, &nDepth);
+	for(i = 0; i < cx * cy * (nDepth / 8); i++)
+	{	dwHash = (dwHash ^ pPixels[i]) * 16777619u;	}
+	return dwHash;
+}
+
+//levels 3-7 clear once each, so past level 7 a replaying story is back at level 3
+static int Bench_Level(uint32 nClears)
+{
+	uint32 nPass = BENCH_LEVELS - BENCH_REPLAY_LEVEL + 1;
+
+	if(nClears <= BENCH_LEVELS)
+	{	return (int)nClears;	}
+	return BENCH_REPLAY_LEVEL + (int)((nClears - BENCH_REPLAY_LEVEL) % nPass);
+}
+
+static void Bench_Snap(BenchSnapshot* pSnap, const HostStats* pStats)
+{
+	pSnap->nObjects = pStats->nLiveImages + pStats->nLiveBitmaps + pStats->nLiveStatics + pStats->nLiveMenus;
+	pSnap->nMenuItems = pStats->nLiveMenuItems;
+	pSnap->dwLiveBytes = pStats->dwLiveBytes;
+	pSnap->dwPeakBytes = pStats->dwPeakBytes;
+}
+
+//nResumeClears are the clears that put a frame back after a suspend, they start no level
+static void Bench_Charge(BenchResult* pResult, const HostStats* pBefore, const HostStats* pAfter, uint32 nResumeClears)
+{
+	BenchLevel* pLevel = &pResult->levels[Bench_Level(pAfter->nClears - nResumeClears)];
+	uint32 dwUs = pAfter->dwDispatchUs - pBefore->dwDispatchUs;
+
+	pLevel->nDispatches++;
+	pLevel->qwUs += dwUs;
+	pLevel->dwMaxUs = MAX(pLevel->dwMaxUs, dwUs);
+	pLevel->nDecodes += pAfter->nImageDecodes - pBefore->nImageDecodes;
+	pLevel->qwDecodeUs += pAfter->dwDecodeUs - pBefore->dwDecodeUs;
+	pLevel->nAllocs += pAfter->nAllocs - pBefore->nAllocs;
+	pLevel->nStringLoads += pAfter->nStringLoads - pBefore->nStringLoads;
+
+	pLevel->nLiveImages = MAX(pLevel->nLiveImages, pAfter->nLiveImages);
+	pLevel->nLiveStatics = MAX(pLevel->nLiveStatics, pAfter->nLiveStatics);
+	pLevel->nLiveMenus = MAX(pLevel->nLiveMenus, pAfter->nLiveMenus);
+	pLevel->nLiveMenuItems = MAX(pLevel->nLiveMenuItems, pAfter->nLiveMenuItems);
+	pLevel->dwLiveBytes = MAX(pLevel->dwLiveBytes, pAfter->dwLiveBytes);
+}
+
+//takes the screen away from the applet and gives it back, through a new applet when bRestart;
+//the frame that was up has to be redrawn pixel for pixel
+static boolean Bench_Suspend(IShell* pIShell, boolean bRestart, BenchResult* pResult, uint32* pnResumeClears)
+{
+	HostStats* pStats = Host_GetStats(pIShell);
+	HostStats before;
+	uint32 dwScreen = Bench_Hash(pIShell, 2166136261u);
+	uint64_t qwStart;
+
+	Host_SuspendApplet(pIShell);
+	before = *pStats;
+	qwStart = Host_NowUs();
+	if(bRestart)
+	{
+		Host_StopApplet(pIShell);
+		if(!Host_StartApplet(pIShell, AEECLSID_HAMLET_BID))
+		{	return FALSE;	}
+	}
+	else
+	{
+		Host_ResumeApplet(pIShell);
+	}
+	pResult->qwResumeUs += Host_NowUs() - qwStart;
+	pResult->nResumeDecodes += pStats->nImageDecodes - before.nImageDecodes;
+	pResult->nResumes++;
+	*pnResumeClears += pStats->nClears - before.nClears;
+
+	if(Bench_Hash(pIShell, 2166136261u) != dwScreen)
+	{
+		fprintf(stderr, "the screen at %u ms did not come back after %s\n", (uint32)(Host_ClockUs(pIShell) / 1000),
+				bRestart ? "a restart" : "EVT_APP_RESUME");
+		return FALSE;
+	}
+	return TRUE;
+}
+
+//nKeys set-piece presses in a row, as fast as a thumb on the keypad gets them in; pnPressed carries the cycle on within a run
+static void Bench_Mash(IShell* pIShell, int nKeys, int* pnPressed, BenchResult* pResult)
+{
+	HostStats* pStats = Host_GetStats(pIShell);
+	HostStats before = *pStats;
+	int i;
+
+	for(i = 0; i < nKeys; i++)
+	{
+		Host_SendEvent(pIShell, EVT_KEY, (uint16)(AVK_1 + (*pnPressed)++ % 6), 0);
+		pResult->nKeys++;
+	}
+	pResult->qwKeyUs += pStats->dwDispatchUs - before.dwDispatchUs;
+	pResult->nKeyUpdates += pStats->nUpdates - before.nUpdates;
+}
+
+//one story from EVT_APP_START to the last timer, or to the menu after nLoops replays; nBranch is how far down the menu to go
+static boolean Bench_Run(const char* pszAssets, const char* pszAppDir, int nBranch, boolean bRealTime,
+						 uint32 dwUpdateMs, boolean bVerbose, int nLoops, uint32 dwSuspendMs, boolean bRestart,
+						 int nMash, int cxScreen, int cyScreen, int nDepth, int nPickMs, BenchResult* pResult)
+{
+	IShell* pIShell = Host_Create(pszAssets, cxScreen, cyScreen);
+	HostStats* pStats;
+	HostStats before;
+	uint32 dwBaseBytes;
+	uint32 dwDigest = 2166136261u;
+	uint64_t qwStart;
+	uint64_t qwPickUs = 0;
+	boolean bPickDue = FALSE;
+	BenchSnapshot snap;
+	char szState[512];
+	boolean bOk = TRUE;
+	boolean bSuspended = (dwSuspendMs == 0);
+	uint32 nResumeClears = 0;
+	boolean bMashed = FALSE;
+	int nPressed = 0;
+	int nLevel;
+	int nPicks = 0;
+	int nSettled = (nPickMs >= 0) ? 2 : 1;	// picks before the menu finds everything decoded
+	int i;
+
+	if(pIShell == NULL)
+	{	return FALSE;	}
+	if(!Host_SetColorDepth(pIShell, nDepth))
+	{
+		Host_Destroy(pIShell);
+		return FALSE;
+	}
+
+	//a snapshot left by an earlier run would start the story in the middle
+	snprintf(szState, sizeof(szState), "%s/%s", pszAppDir, BENCH_STATE_FILE);
+	remove(szState);
+
+	Host_SetAppDir(pIShell, pszAppDir);
+	Host_SetQuiet(pIShell, !bVerbose);
+	if(!bRealTime)
+	{
+		Host_SetVirtualClock(pIShell);
+		Host_SetUpdateCost(pIShell, dwUpdateMs * 1000);
+	}
+
+	pStats = Host_GetStats(pIShell);
+	dwBaseBytes = pStats->dwLiveBytes;	// the display
+	before = *pStats;
+	qwStart = Host_NowUs();
+	if(!Host_StartApplet(pIShell, AEECLSID_HAMLET_BID))
+	{
+		Host_Destroy(pIShell);
+		return FALSE;
+	}
+	//EVT_APP_START draws the logo, so it is charged to level 1; startup also counts the constructor
+	pResult->qwStartupUs += Host_NowUs() - qwStart;
+	pResult->qwFirstPixelUs += pStats->dwFirstPixelUs;
+	Bench_Charge(pResult, &before, pStats, 0);
+	dwDigest = Bench_Hash(pIShell, dwDigest);
+	if(nLoops > 0)
+	{	Host_SendEvent(pIShell, EVT_HAMLET_REPLAY, TRUE, 0);	}
+
+	for(;;)
+	{
+		before = *pStats;
+		if(!(bPickDue && Host_ClockUs(pIShell) >= qwPickUs) && Host_RunNextTimer(pIShell))
+		{
+			Bench_Charge(pResult, &before, pStats, nResumeClears);
+			dwDigest = Bench_Hash(pIShell, dwDigest);
+			nLevel = Bench_Level(pStats->nClears - nResumeClears);
+			if(nPickMs >= 0 && nLevel == BENCH_MENU_LEVEL && pStats->nClears != before.nClears)
+			{
+				//-p does not wait for the timers the menu leaves behind
+				bPickDue = TRUE;
+				qwPickUs = Host_ClockUs(pIShell) + (uint64_t)nPickMs * 1000;
+			}
+			if(nMash > 0 && !bMashed && nLevel >= 3 && nLevel <= BENCH_LEVELS)
+			{
+				Bench_Mash(pIShell, nMash, &nPressed, pResult);
+				bMashed = TRUE;
+			}
+			else
+			{
+				bMashed = FALSE;
+			}
+			if(!bSuspended && Host_ClockUs(pIShell) >= (uint64_t)dwSuspendMs * 1000)
+			{
+				bSuspended = TRUE;
+				if(!Bench_Suspend(pIShell, bRestart, pResult, &nResumeClears))
+				{	bOk = FALSE;	}
+				dwDigest = Bench_Hash(pIShell, dwDigest);
+			}
+			continue;
+		}
+
+		//nothing scheduled, or -p is due: the story waits at the menu, or it is over
+		if(nPicks > 0)
+		{
+			Bench_Snap(&snap, pStats);
+			if(nPicks == nSettled)
+			{	pResult->settled = snap;	}
+			pResult->last = snap;
+		}
+		if(nPicks == nLoops + 1)
+		{	break;	}
+
+		for(i = 0; i < nBranch; i++)
+		{	Host_SendEvent(pIShell, EVT_KEY, AVK_DOWN, 0);	}
+		Host_SendEvent(pIShell, EVT_KEY, AVK_SELECT, 0);
+		bPickDue = FALSE;
+		if(Host_PendingTimers(pIShell) == 0)
+		{	break;	}	//the keys started nothing, there was no menu up
+		nPicks++;
+		Bench_Charge(pResult, &before, pStats, nResumeClears);
+		dwDigest = Bench_Hash(pIShell, dwDigest);
+	}
+	pResult->dwStoryMs = (uint32)(Host_ClockUs(pIShell) / 1000);
+	pResult->nPasses = nPicks;
+
+	if(nPicks == 0)
+	{	bOk = FALSE;	}
+	if(pResult->nRuns > 0 && dwDigest != pResult->dwDigest)
+	{
+		fprintf(stderr, "run %u drew different frames than run 1\n", pResult->nRuns + 1);
+		bOk = FALSE;
+	}
+	pResult->nSettled = nSettled + 1;
+	if(nLoops >= nSettled && memcmp(&pResult->settled, &pResult->last, sizeof(BenchSnapshot)) != 0)
+	{
+		fprintf(stderr, "replay grew from pass %d to pass %d: %u to %u objects, %u to %u menu items, "
+				"%u to %u bytes live, %u to %u bytes peak\n", nSettled + 1, nPicks + 1,
+				pResult->settled.nObjects, pResult->last.nObjects, pResult->settled.nMenuItems, pResult->last.nMenuItems,
+				pResult->settled.dwLiveBytes, pResult->last.dwLiveBytes, pResult->settled.dwPeakBytes, pResult->last.dwPeakBytes);
+		bOk = FALSE;
+	}
+	pResult->dwDigest = dwDigest;
+	pResult->dwPeakBytes = MAX(pResult->dwPeakBytes, pStats->dwPeakBytes);
+	pResult->nUpdates += pStats->nUpdates;
+	pResult->nEmptyUpdates += pStats->nEmptyUpdates;
+	pResult->qwPixelsPushed += pStats->dwPixelsPushed;
+	pResult->nRuns++;
+	Host_StopApplet(pIShell);
+	pResult->dwLeakBytes = MAX(pResult->dwLeakBytes, pStats->dwLiveBytes - dwBaseBytes);
+	Bench_Snap(&snap, pStats);
+	pResult->nLiveObjects = MAX(pResult->nLiveObjects, snap.nObjects - 1);	// the device bitmap stays
+	Host_Destroy(pIShell);
+	return bOk;
+}
+
+static void Bench_Report(const char* pszBranch, const BenchResult* pResult)
+{
+	const BenchLevel* pLevel;
+	double dRuns = (double)pResult->nRuns;
+	char szLevel[8];
+	int i;
+
+	printf("branch %s, %u run%s\n", pszBranch, pResult->nRuns, pResult->nRuns == 1 ? "" : "s");
+	printf("  startup %.3f ms, first pixel %.3f ms after creation, frames digest %08x\n", pResult->qwStartupUs / 1000.0 / dRuns,
+		   pResult->qwFirstPixelUs / 1000.0 / dRuns, pResult->dwDigest);
+	printf("  level   frames   avg ms   max ms   decodes  decode ms   allocs  strings  images statics menus items  live KB\n");
+	for(i = 0; i <= BENCH_LEVELS; i++)
+	{
+		pLevel = &pResult->levels[i];
+		if(pLevel->nDispatches == 0)
+		{	continue;	}
+
+		snprintf(szLevel, sizeof(szLevel), "%d", i);
+		printf("  %-7s %6.1f %8.3f %8.3f %9.1f %10.3f %8.1f %8.1f %7u %7u %5u %5u %8.1f\n", szLevel,
+			   pLevel->nDispatches / dRuns,
+			   pLevel->qwUs / 1000.0 / pLevel->nDispatches,
+			   pLevel->dwMaxUs / 1000.0,
+			   pLevel->nDecodes / dRuns,
+			   pLevel->qwDecodeUs / 1000.0 / dRuns,
+			   pLevel->nAllocs / dRuns,
+			   pLevel->nStringLoads / dRuns,
+			   pLevel->nLiveImages,
+			   pLevel->nLiveStatics,
+			   pLevel->nLiveMenus,
+			   pLevel->nLiveMenuItems,
+			   pLevel->dwLiveBytes / 1024.0);
+	}
+	if(pResult->nUpdates)
+	{
+		printf("  %.1f screen updates, %.1f with nothing to push, %.0f pixels pushed\n", pResult->nUpdates / dRuns,
+			   pResult->nEmptyUpdates / dRuns, pResult->qwPixelsPushed / dRuns);
+	}
+	if(pResult->nResumes)
+	{
+		printf("  back from a suspend in %.3f ms with %.1f decodes\n", pResult->qwResumeUs / 1000.0 / pResult->nResumes,
+			   (double)pResult->nResumeDecodes / pResult->nResumes);
+	}
+	if(pResult->nKeys)
+	{
+		printf("  %u set-piece keys in %.3f ms, %.2f us and %.3f screen updates each\n", pResult->nKeys,
+			   pResult->qwKeyUs / 1000.0, (double)pResult->qwKeyUs / pResult->nKeys, (double)pResult->nKeyUpdates / pResult->nKeys);
+	}
+	if(pResult->nPasses > 1 && pResult->nPasses >= pResult->nSettled)
+	{
+		printf("  %u passes, at the menu from pass %u on: %u objects, %u menu items, %u bytes live, %u bytes peak\n",
+			   pResult->nPasses, pResult->nSettled, pResult->last.nObjects, pResult->last.nMenuItems,
+			   pResult->last.dwLiveBytes, pResult->last.dwPeakBytes);
+	}
+	printf("  peak heap %u bytes, %u bytes and %u objects left after EVT_APP_STOP\n\n",
+		   pResult->dwPeakBytes, pResult->dwLeakBytes, pResult->nLiveObjects);
+}
+
+int main(int argc, char* argv[])
+{
+	const char* pszAssets = "../Assets.xcassets";
+	const char* pszAppDir = "build";
+	const char* pszBranch = "all";
+	BenchResult result;
+	boolean bRealTime = FALSE;
+	boolean bVerbose = FALSE;
+	uint32 dwUpdateMs = 0;
+	uint64_t qwStart;
+	int nRuns = 1;
+	int nLoops = 0;
+	uint32 dwSuspendMs = 0;
+	boolean bRestart = FALSE;
+	int nMash = 0;
+	int cxScreen = HOST_SCREEN_CX;
+	int cyScreen = HOST_SCREEN_CY;
+	int nDepth = 16;
+	int nPickMs = -1;	// when nothing is scheduled
+	int nBranch;
+	int i;
+
+	for(i = 1; i < argc; i++)
+	{
+		if(strcmp(argv[i], "-a") == 0 && i + 1 < argc)
+		{	pszAssets = argv[++i];	}
+		else if(strcmp(argv[i], "-d") == 0 && i + 1 < argc)
+		{	pszAppDir = argv[++i];	}
+		else if(strcmp(argv[i], "-b") == 0 && i + 1 < argc)
+		{	pszBranch = argv[++i];	}
+		else if(strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+		{	nRuns = atoi(argv[++i]);	}
+		else if(strcmp(argv[i], "-r") == 0)
+		{	bRealTime = TRUE;	}
+		else if(strcmp(argv[i], "-u") == 0 && i + 1 < argc)
+		{	dwUpdateMs = (uint32)atoi(argv[++i]);	}
+		else if(strcmp(argv[i], "-v") == 0)
+		{	bVerbose = TRUE;	}
+		else if(strcmp(argv[i], "-l") == 0 && i + 1 < argc)
+		{	nLoops = atoi(argv[++i]);	}
+		else if(strcmp(argv[i], "-s") == 0 && i + 1 < argc)
+		{	dwSuspendMs = (uint32)atoi(argv[++i]);	}
+		else if(strcmp(argv[i], "-k") == 0)
+		{	bRestart = TRUE;	}
+		else if(strcmp(argv[i], "-m") == 0 && i + 1 < argc)
+		{	nMash = atoi(argv[++i]);	}
+		else if(strcmp(argv[i], "-g") == 0 && i + 1 < argc && sscanf(argv[++i], "%dx%d", &cxScreen, &cyScreen) == 2
+				&& cxScreen > 0 && cyScreen > 0)
+		{	;	}
+		else if(strcmp(argv[i], "-c") == 0 && i + 1 < argc)
+		{	nDepth = atoi(argv[++i]);	}
+		else if(strcmp(argv[i], "-p") == 0 && i + 1 < argc)
+		{	nPickMs = atoi(argv[++i]);	}
+		else
+		{
+			fprintf(stderr, "usage: %s [-a assetdir] [-d appdir] [-b polonius|kenny|splinter|all] [-n runs] [-r] [-u ms] [-v] [-l loops] [-s ms [-k]] [-m keys] [-g cxXcy] [-c bits] [-p ms]\n", argv[0]);
+			return 2;
+		}
+	}
+	nRuns = MAX(1, nRuns);
+	nLoops = MAX(0, nLoops);
+	nPickMs = MAX(-1, nPickMs);
+
+	for(nBranch = 0; nBranch < BENCH_BRANCHES; nBranch++)
+	{
+		if(strcmp(pszBranch, "all") != 0 && strcmp(pszBranch, gBranchNames[nBranch]) != 0)
+		{	continue;	}
+
+		memset(&result, 0, sizeof(result));
+		qwStart = Host_NowUs();
+		for(i = 0; i < nRuns; i++)
+		{
+			if(!Bench_Run(pszAssets, pszAppDir, nBranch, bRealTime, dwUpdateMs, bVerbose, nLoops, dwSuspendMs, bRestart, nMash, cxScreen, cyScreen, nDepth, nPickMs, &result))
+			{
+				fprintf(stderr, "run %d of %s failed (assets in %s?)\n", i + 1, gBranchNames[nBranch], pszAssets);
+				return 1;
+			}
+		}
+		printf("%d stories of %u ms in %.3f s\n", nRuns, result.dwStoryMs, (Host_NowUs() - qwStart) / 1e6);
+		Bench_Report(gBranchNames[nBranch], &result);
+	}
+	return 0;
+}
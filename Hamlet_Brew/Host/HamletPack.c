@@ -0,0 +1,467 @@
+/*===========================================================================
+
+FILE: HamletPack.c
+
+Builds hamlet.pak, the resource bundle HamletRes.c maps, from the
+images and strings HostResources.c knows about.
+
+	hamlet_pack [-a assetdir] -o hamlet.pak
+
+The directory is sorted by resource ID. Strings are stored as
+zero-terminated little-endian AECHARs with their line breaks already
+'\n', images as PNGs. Every image is re-encoded as an 8-bit indexed PNG
+over one palette shared by the whole bundle: index 0 is transparent,
+the rest are the colors of all the images in ID order. An image whose
+colors no longer fit in 256 entries keeps its own PNG bytes.
+
+The frames of each animation HostRes_Atlas lists are put side by side
+or one under the other, whichever makes the smaller image, into one
+atlas before any of that, and drop out of the bundle themselves. Where each one went is kept in
+the frame table, the one RESTYPE_HAMLET_FRAMES entry.
+===========================================================================*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <png.h>
+
+#include "HostInternal.h"
+#include "HamletRes.h"
+
+#define PACK_MAX_ENTRIES	64
+#define PACK_MAX_FRAMES		32
+#define PACK_MAX_COLORS		256
+#define PACK_RGBA(p)		(((uint32)(p)[0] << 24) | ((uint32)(p)[1] << 16) | ((uint32)(p)[2] << 8) | 0xFF)
+
+typedef struct _PackItem {
+	HamletPakEntry	entry;
+	byte*			pData;
+} PackItem;
+
+//the bundle's palette as RGBA words, entry 0 the transparent one
+typedef struct _PackPalette {
+	uint32		dwColors[PACK_MAX_COLORS];
+	int			nColors;
+} PackPalette;
+
+static int Pack_Compare(const void* p1, const void* p2)
+{
+	return (int)((const PackItem*)p1)->entry.wResID - (int)((const PackItem*)p2)->entry.wResID;
+}
+
+static byte* Pack_ReadFile(const char* pszPath, uint32* pdwSize)
+{
+	FILE* pFile = fopen(pszPath, "rb");
+	byte* pData = NULL;
+	long nLen;
+
+	if(pFile == NULL)
+	{	return NULL;	}
+
+	fseek(pFile, 0, SEEK_END);
+	nLen = ftell(pFile);
+	fseek(pFile, 0, SEEK_SET);
+	if(nLen > 0)
+	{	pData = (byte*)malloc((size_t)nLen);	}
+	if(pData && fread(pData, 1, (size_t)nLen, pFile) != (size_t)nLen)
+	{
+		free(pData);
+		pData = NULL;
+	}
+	fclose(pFile);
+	*pdwSize = (uint32)nLen;
+	return pData;
+}
+
+//ASCII to little-endian UTF-16 with the terminator, line breaks baked from '^' to '\n'
+static byte* Pack_WideString(const char* psz, uint32* pdwSize)
+{
+	size_t nLen = strlen(psz) + 1;
+	byte* pData = (byte*)malloc(nLen * 2);
+	size_t i;
+
+	if(pData == NULL)
+	{	return NULL;	}
+
+	for(i = 0; i < nLen; i++)
+	{
+		pData[i * 2] = (byte)(psz[i] == '^' ? '\n' : psz[i]);
+		pData[i * 2 + 1] = 0;
+	}
+	*pdwSize = (uint32)(nLen * 2);
+	return pData;
+}
+
+//the entry for an opaque pixel, -1 when the palette does not have it
+static int Pack_FindColor(const PackPalette* pPalette, const png_byte* pPixel)
+{
+	uint32 dwColor = PACK_RGBA(pPixel);
+	int i;
+
+	for(i = 1; i < pPalette->nColors; i++)
+	{
+		if(pPalette->dwColors[i] == dwColor)
+		{	return i;	}
+	}
+	return -1;
+}
+
+//pixels under half alpha are transparent, as the host and the handset's color key treat them
+static int Pack_Index(const PackPalette* pPalette, const png_byte* pPixel)
+{
+	return pPixel[3] < 0x80 ? 0 : Pack_FindColor(pPalette, pPixel);
+}
+
+//adds the image's colors to the palette; FALSE, and the palette as it was, when they do not all fit
+static boolean Pack_AddColors(PackPalette* pPalette, const png_byte* pRGBA, uint32 nPixels)
+{
+	PackPalette grown = *pPalette;
+	uint32 i;
+
+	for(i = 0; i < nPixels; i++, pRGBA += 4)
+	{
+		if(Pack_Index(&grown, pRGBA) >= 0)
+		{	continue;	}
+		if(grown.nColors == PACK_MAX_COLORS)
+		{	return FALSE;	}
+		grown.dwColors[grown.nColors++] = PACK_RGBA(pRGBA);
+	}
+	*pPalette = grown;
+	return TRUE;
+}
+
+//the PNG as 8-bit RGBA, NULL if libpng cannot read it
+static png_bytep Pack_ReadRGBA(const byte* pData, uint32 dwSize, png_imagep pImage)
+{
+	png_bytep pRGBA;
+
+	memset(pImage, 0, sizeof(png_image));
+	pImage->version = PNG_IMAGE_VERSION;
+	if(!png_image_begin_read_from_memory(pImage, pData, dwSize))
+	{	return NULL;	}
+
+	pImage->format = PNG_FORMAT_RGBA;
+	pRGBA = (png_bytep)malloc(PNG_IMAGE_SIZE(*pImage));
+	if(pRGBA && !png_image_finish_read(pImage, NULL, pRGBA, 0, NULL))
+	{
+		free(pRGBA);
+		pRGBA = NULL;
+	}
+	png_image_free(pImage);
+	return pRGBA;
+}
+
+//encodes the pixels the image describes; NULL if libpng cannot
+static byte* Pack_WritePNG(png_imagep pImage, const void* pBuffer, const png_byte* pColormap, uint32* pdwSize)
+{
+	png_alloc_size_t nSize = 0;
+	byte* pPNG = NULL;
+
+	//first pass sizes it, the second writes it
+	if(png_image_write_to_memory(pImage, NULL, &nSize, 0, pBuffer, 0, pColormap))
+	{	pPNG = (byte*)malloc(nSize);	}
+	if(pPNG && !png_image_write_to_memory(pImage, pPNG, &nSize, 0, pBuffer, 0, pColormap))
+	{
+		free(pPNG);
+		pPNG = NULL;
+	}
+	*pdwSize = (uint32)nSize;
+	return pPNG;
+}
+
+//the image item with the ID, -1 when there is none
+static int Pack_FindImage(const PackItem* pItems, int nItems, uint16 wResID)
+{
+	int i;
+
+	for(i = 0; i < nItems; i++)
+	{
+		if(pItems[i].entry.wResID == wResID && pItems[i].entry.wType == RESTYPE_IMAGE)
+		{	return i;	}
+	}
+	return -1;
+}
+
+//stacks the frames into one image that takes their place among the items; FALSE leaves the items alone
+static boolean Pack_BuildAtlas(PackItem* pItems, int* pnItems, uint16 wAtlasID, const uint16* pwFrameIDs,
+							   HamletPakFrame* pFrames, int* pnFrames)
+{
+	png_image frames[HOST_ATLAS_FRAMES];
+	png_bytep pRGBA[HOST_ATLAS_FRAMES];
+	png_image atlas;
+	png_bytep pAtlas = NULL;
+	byte* pPNG = NULL;
+	uint32 cxSum = 0;
+	uint32 cySum = 0;
+	uint32 cxMax = 0;
+	uint32 cyMax = 0;
+	uint32 dwSize = 0;
+	uint32 dwStride;
+	uint32 x;
+	uint32 y;
+	uint32 row;
+	boolean bAcross;
+	int nFrames = 0;
+	int nItem;
+	int i;
+
+	memset(pRGBA, 0, sizeof(pRGBA));
+	memset(&atlas, 0, sizeof(atlas));
+	atlas.version = PNG_IMAGE_VERSION;
+	atlas.format = PNG_FORMAT_RGBA;
+	while(nFrames < HOST_ATLAS_FRAMES && pwFrameIDs[nFrames])
+	{
+		nItem = Pack_FindImage(pItems, *pnItems, pwFrameIDs[nFrames]);
+		if(nItem < 0 || (pRGBA[nFrames] = Pack_ReadRGBA(pItems[nItem].pData, pItems[nItem].entry.dwSize, &frames[nFrames])) == NULL)
+		{	break;	}
+
+		cxSum += frames[nFrames].width;
+		cySum += frames[nFrames].height;
+		cxMax = MAX(cxMax, frames[nFrames].width);
+		cyMax = MAX(cyMax, frames[nFrames].height);
+		nFrames++;
+	}
+	bAcross = cxSum * cyMax <= cxMax * cySum;
+	atlas.width = bAcross ? cxSum : cxMax;
+	atlas.height = bAcross ? cyMax : cySum;
+
+	//whatever is not a frame stays transparent
+	if(nFrames > 0 && (nFrames == HOST_ATLAS_FRAMES || pwFrameIDs[nFrames] == 0) && *pnFrames + nFrames <= PACK_MAX_FRAMES)
+	{	pAtlas = (png_bytep)calloc(1, PNG_IMAGE_SIZE(atlas));	}
+	if(pAtlas)
+	{
+		for(i = 0, x = 0, y = 0; i < nFrames; i++)
+		{
+			dwStride = PNG_IMAGE_ROW_STRIDE(frames[i]);
+			for(row = 0; row < frames[i].height; row++)
+			{	memcpy(pAtlas + PNG_IMAGE_ROW_STRIDE(atlas) * (y + row) + x * 4, pRGBA[i] + dwStride * row, dwStride);	}
+			x += bAcross ? frames[i].width : 0;
+			y += bAcross ? 0 : frames[i].height;
+		}
+		pPNG = Pack_WritePNG(&atlas, pAtlas, NULL, &dwSize);
+		free(pAtlas);
+	}
+	for(i = 0; i < nFrames; i++)
+	{	free(pRGBA[i]);	}
+	if(pPNG == NULL)
+	{	return FALSE;	}
+
+	//the frames give up their items to the atlas and keep only their place in it
+	for(i = 0, x = 0, y = 0; i < nFrames; i++)
+	{
+		pFrames[*pnFrames].wResID = pwFrameIDs[i];
+		pFrames[*pnFrames].wAtlasID = wAtlasID;
+		pFrames[*pnFrames].x = (int16)x;
+		pFrames[*pnFrames].y = (int16)y;
+		pFrames[*pnFrames].cx = (uint16)frames[i].width;
+		pFrames[*pnFrames].cy = (uint16)frames[i].height;
+		(*pnFrames)++;
+		x += bAcross ? frames[i].width : 0;
+		y += bAcross ? 0 : frames[i].height;
+
+		nItem = Pack_FindImage(pItems, *pnItems, pwFrameIDs[i]);
+		free(pItems[nItem].pData);
+		pItems[nItem] = pItems[--(*pnItems)];
+	}
+	pItems[*pnItems].entry.wResID = wAtlasID;
+	pItems[*pnItems].entry.wType = RESTYPE_IMAGE;
+	pItems[*pnItems].entry.dwSize = dwSize;
+	pItems[*pnItems].pData = pPNG;
+	(*pnItems)++;
+	return TRUE;
+}
+
+//the image's PNG over the shared palette in place of its own bytes, when all its colors are in it
+static boolean Pack_Reencode(PackItem* pItem, const PackPalette* pPalette)
+{
+	png_image image;
+	png_bytep pRGBA;
+	png_bytep pIndices;
+	png_byte colormap[PACK_MAX_COLORS * 4];
+	byte* pPNG;
+	uint32 dwSize;
+	uint32 nPixels;
+	uint32 i;
+	int n;
+
+	pRGBA = Pack_ReadRGBA(pItem->pData, pItem->entry.dwSize, &image);
+	if(pRGBA == NULL)
+	{	return FALSE;	}
+
+	nPixels = image.width * image.height;
+	pIndices = (png_bytep)malloc(nPixels);
+	for(i = 0; pIndices && i < nPixels; i++)
+	{
+		n = Pack_Index(pPalette, pRGBA + i * 4);
+		if(n < 0)
+		{	break;	}
+		pIndices[i] = (png_byte)n;
+	}
+	free(pRGBA);
+	if(pIndices == NULL || i < nPixels)
+	{
+		free(pIndices);
+		return FALSE;
+	}
+
+	for(n = 0; n < pPalette->nColors; n++)
+	{
+		colormap[n * 4] = (png_byte)(pPalette->dwColors[n] >> 24);
+		colormap[n * 4 + 1] = (png_byte)(pPalette->dwColors[n] >> 16);
+		colormap[n * 4 + 2] = (png_byte)(pPalette->dwColors[n] >> 8);
+		colormap[n * 4 + 3] = (png_byte)pPalette->dwColors[n];
+	}
+
+	image.format = PNG_FORMAT_RGBA_COLORMAP;
+	image.flags = 0;
+	image.colormap_entries = (png_uint_32)pPalette->nColors;
+	pPNG = Pack_WritePNG(&image, pIndices, colormap, &dwSize);
+	free(pIndices);
+	if(pPNG == NULL)
+	{	return FALSE;	}
+
+	free(pItem->pData);
+	pItem->pData = pPNG;
+	pItem->entry.dwSize = dwSize;
+	return TRUE;
+}
+
+int main(int argc, char* argv[])
+{
+	const char* pszAssets = "../Assets.xcassets";
+	const char* pszOut = NULL;
+	static const byte pad[4] = { 0, 0, 0, 0 };
+	PackItem items[PACK_MAX_ENTRIES];
+	HamletPakFrame frames[PACK_MAX_FRAMES];
+	PackPalette palette;
+	boolean bFits[PACK_MAX_ENTRIES];
+	png_image image;
+	png_bytep pRGBA;
+	HamletPakHeader header;
+	char szPath[512];
+	const char* psz;
+	const uint16* pwFrameIDs;
+	uint16 wAtlasID;
+	uint32 dwOffset;
+	FILE* pOut;
+	int nItems = 0;
+	int nFrames = 0;
+	int nAtlases = 0;
+	int nIndexed = 0;
+	int i;
+
+	for(i = 1; i < argc; i++)
+	{
+		if(strcmp(argv[i], "-a") == 0 && i + 1 < argc)
+		{	pszAssets = argv[++i];	}
+		else if(strcmp(argv[i], "-o") == 0 && i + 1 < argc)
+		{	pszOut = argv[++i];		}
+		else
+		{	pszOut = NULL;	break;	}
+	}
+	if(pszOut == NULL)
+	{
+		fprintf(stderr, "usage: %s [-a assetdir] -o hamlet.pak\n", argv[0]);
+		return 2;
+	}
+
+	while(nItems < PACK_MAX_ENTRIES
+		  && HostRes_Entry(nItems, &items[nItems].entry.wResID, &items[nItems].entry.wType, &psz))
+	{
+		if(items[nItems].entry.wType == RESTYPE_IMAGE)
+		{
+			snprintf(szPath, sizeof(szPath), "%s/%s", pszAssets, psz);
+			items[nItems].pData = Pack_ReadFile(szPath, &items[nItems].entry.dwSize);
+		}
+		else
+		{
+			items[nItems].pData = Pack_WideString(HostRes_String(items[nItems].entry.wResID), &items[nItems].entry.dwSize);
+		}
+		if(items[nItems].pData == NULL)
+		{
+			fprintf(stderr, "cannot read %s\n", psz);
+			return 1;
+		}
+		nItems++;
+	}
+
+	//an animation that cannot be stacked keeps its frames as images of their own
+	for(i = 0; HostRes_Atlas(i, &wAtlasID, &pwFrameIDs); i++)
+	{
+		if(Pack_BuildAtlas(items, &nItems, wAtlasID, pwFrameIDs, frames, &nFrames))
+		{	nAtlases++;		}
+		else
+		{	fprintf(stderr, "cannot build atlas %u, its frames stay apart\n", wAtlasID);	}
+	}
+	if(nFrames > 0)
+	{
+		//the atlases are no use without it
+		if(nItems == PACK_MAX_ENTRIES)
+		{
+			fprintf(stderr, "no room for the frame table\n");
+			return 1;
+		}
+		items[nItems].entry.wResID = 0;
+		items[nItems].entry.wType = RESTYPE_HAMLET_FRAMES;
+		items[nItems].entry.dwSize = (uint32)(nFrames * sizeof(HamletPakFrame));
+		items[nItems].pData = (byte*)malloc(items[nItems].entry.dwSize);
+		memcpy(items[nItems].pData, frames, items[nItems].entry.dwSize);
+		nItems++;
+	}
+	qsort(items, (size_t)nItems, sizeof(PackItem), Pack_Compare);
+
+	//every image's colors go into the palette before any image is written over it
+	memset(&palette, 0, sizeof(palette));
+	palette.dwColors[0] = 0xFF00FF00;	// magenta, fully transparent
+	palette.nColors = 1;
+	for(i = 0; i < nItems; i++)
+	{
+		bFits[i] = FALSE;
+		if(items[i].entry.wType != RESTYPE_IMAGE)
+		{	continue;	}
+
+		pRGBA = Pack_ReadRGBA(items[i].pData, items[i].entry.dwSize, &image);
+		if(pRGBA)
+		{	bFits[i] = Pack_AddColors(&palette, pRGBA, image.width * image.height);	}
+		free(pRGBA);
+	}
+	for(i = 0; i < nItems; i++)
+	{
+		if(bFits[i] && Pack_Reencode(&items[i], &palette))
+		{	nIndexed++;		}
+	}
+
+	//data starts after the directory; every item is 4-byte aligned
+	dwOffset = (uint32)(sizeof(HamletPakHeader) + nItems * sizeof(HamletPakEntry));
+	for(i = 0; i < nItems; i++)
+	{
+		dwOffset = (dwOffset + 3) & ~3u;
+		items[i].entry.dwOffset = dwOffset;
+		dwOffset += items[i].entry.dwSize;
+	}
+
+	pOut = fopen(pszOut, "wb");
+	if(pOut == NULL)
+	{
+		fprintf(stderr, "cannot write %s\n", pszOut);
+		return 1;
+	}
+	header.dwMagic = HAMLET_PAK_MAGIC;
+	header.wVersion = HAMLET_PAK_VERSION;
+	header.nEntries = (uint16)nItems;
+	fwrite(&header, sizeof(header), 1, pOut);
+	for(i = 0; i < nItems; i++)
+	{	fwrite(&items[i].entry, sizeof(HamletPakEntry), 1, pOut);	}
+
+	dwOffset = (uint32)(sizeof(HamletPakHeader) + nItems * sizeof(HamletPakEntry));
+	for(i = 0; i < nItems; i++)
+	{
+		fwrite(pad, 1, items[i].entry.dwOffset - dwOffset, pOut);
+		fwrite(items[i].pData, 1, items[i].entry.dwSize, pOut);
+		dwOffset = items[i].entry.dwOffset + items[i].entry.dwSize;
+		free(items[i].pData);
+	}
+	fclose(pOut);
+	printf("%s: %d resources, %u bytes, %d images on one %d-color palette, %d frames in %d atlases\n",
+		   pszOut, nItems, dwOffset, nIndexed, palette.nColors, nFrames, nAtlases);
+	return 0;
+}
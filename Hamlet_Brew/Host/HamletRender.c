@@ -0,0 +1,278 @@
+/*===========================================================================
+
+FILE: HamletRender.c
+
+Renders every frame of the story offline, for every combination of kill
+branch, background (IMG_BACK0-3) and wall (IMG_WALL0-3): the 48 stories
+a person would otherwise replay on the simulator to take screenshots.
+
+	hamlet_render [-a assetdir] [-d appdir] [-o outdir] [-n repeat] [-g cxXcy]
+
+The stories run one after the other, each with a fresh start of
+Hamlet.c in the same host. The PNGs are decoded once up front through
+Host_SharePNGs, so no story after the first three pays for a decode.
+
+With -o each frame that changed the screen is written to outdir as
+<branch>_back<n>_wall<n>_<frame>.png. -n renders the whole set that
+many times over, for steadier frame rates. The digest folds every
+story's frames together in order. -g renders on a screen of another size than the
+handset's, for checking the applet's layout on it.
+===========================================================================*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <png.h>
+
+#include "HostRuntime.h"
+#include "AEEMenu.h"
+#include "Hamlet.bid"
+
+#define RENDER_BRANCHES		3
+#define RENDER_BACKS		4		// IMG_BACK0 and the three the 1-3 keys pick
+#define RENDER_WALLS		4		// IMG_WALL0 and the three the 4-6 keys pick
+#define RENDER_STORIES		(RENDER_BRANCHES * RENDER_BACKS * RENDER_WALLS)
+#define RENDER_STATE_FILE	"hamlet.sav"	// HAMLET_STATE_FILE
+
+typedef struct _RenderJob {
+	int			nBranch;
+	int			nBack;
+	int			nWall;
+	uint32		nFrames;
+	uint32		dwDigest;		// every new screen of the story, folded together
+	uint32		dwScreen;		// the screen last counted as a frame
+} RenderJob;
+
+typedef struct _Render {
+	const char*		pszAssets;
+	const char*		pszAppDir;
+	const char*		pszOutDir;	// NULL renders without writing
+	int				cxScreen;
+	int				cyScreen;
+	IShell*			pIShell;
+	png_byte*		pRGB;		// the frame being written, 8 bits a channel
+} Render;
+
+static const char* gBranchNames[RENDER_BRANCHES] = { "polonius", "kenny", "splinter" };
+
+static boolean Render_Open(Render* pRender)
+{
+	pRender->pIShell = Host_Create(pRender->pszAssets, pRender->cxScreen, pRender->cyScreen);
+	if(pRender->pIShell == NULL)
+	{	return FALSE;	}
+
+	Host_SetAppDir(pRender->pIShell, pRender->pszAppDir);
+	Host_SetQuiet(pRender->pIShell, TRUE);
+	Host_SetVirtualClock(pRender->pIShell);
+	pRender->pRGB = (png_byte*)malloc(pRender->cxScreen * pRender->cyScreen * 3);
+	return pRender->pRGB != NULL;
+}
+
+static void Render_Close(Render* pRender)
+{
+	if(pRender->pIShell)
+	{	Host_Destroy(pRender->pIShell);	}
+	free(pRender->pRGB);
+	pRender->pIShell = NULL;
+	pRender->pRGB = NULL;
+}
+
+static boolean Render_WritePNG(Render* pRender, const RenderJob* pJob, const uint16* pPixels, int cx, int cy)
+{
+	char szPath[512];
+	png_image image;
+	png_byte* pOut = pRender->pRGB;
+	int i;
+
+	for(i = 0; i < cx * cy; i++)
+	{
+		*pOut++ = (png_byte)(((pPixels[i] >> 11) << 3) | (pPixels[i] >> 13));
+		*pOut++ = (png_byte)((((pPixels[i] >> 5) & 0x3F) << 2) | ((pPixels[i] >> 9) & 0x03));
+		*pOut++ = (png_byte)(((pPixels[i] & 0x1F) << 3) | ((pPixels[i] >> 2) & 0x07));
+	}
+
+	snprintf(szPath, sizeof(szPath), "%s/%s_back%d_wall%d_%02u.png", pRender->pszOutDir,
+			 gBranchNames[pJob->nBranch], pJob->nBack, pJob->nWall, pJob->nFrames);
+	memset(&image, 0, sizeof(image));
+	image.version = PNG_IMAGE_VERSION;
+	image.width = (png_uint_32)cx;
+	image.height = (png_uint_32)cy;
+	image.format = PNG_FORMAT_RGB;
+	return png_image_write_to_file(&image, szPath, 0, pRender->pRGB, cx * 3, NULL) != 0;
+}
+
+//counts the screen as a frame when it differs from the last one
+static boolean Render_Frame(Render* pRender, RenderJob* pJob)
+{
+	const uint16* pPixels;
+	uint32 dwScreen = 2166136261u;
+	int cx;
+	int cy;
+	int i;
+
+	pPixels = (const uint16*)Host_GetFramebuffer(pRender->pIShell, &cx, &cy, NULL);	//the host's default RGB565
+	for(i = 0; i < cx * cy; i++)
+	{
+		dwScreen = (dwScreen ^ (pPixels[i] & 0xFF)) * 16777619u;
+		dwScreen = (dwScreen ^ (pPixels[i] >> 8)) * 16777619u;
+	}
+	if(pJob->nFrames > 0 && dwScreen == pJob->dwScreen)
+	{	return TRUE;	}
+
+	pJob->dwScreen = dwScreen;
+	pJob->dwDigest = (pJob->dwDigest ^ dwScreen) * 16777619u;
+	if(pRender->pszOutDir && !Render_WritePNG(pRender, pJob, pPixels, cx, cy))
+	{	return FALSE;	}
+	pJob->nFrames++;
+	return TRUE;
+}
+
+//one story from EVT_APP_START to its last timer
+static boolean Render_Story(Render* pRender, RenderJob* pJob)
+{
+	IShell* pIShell = pRender->pIShell;
+	boolean bPicked = FALSE;
+	boolean bOk;
+	int i;
+
+	pJob->nFrames = 0;
+	pJob->dwDigest = 2166136261u;
+	if(!Host_StartApplet(pIShell, AEECLSID_HAMLET_BID))
+	{	return FALSE;	}
+
+	//the set pieces first; before level 4 the keys swap the pictures without drawing
+	if(pJob->nBack)
+	{	Host_SendEvent(pIShell, EVT_KEY, (uint16)(AVK_1 + pJob->nBack - 1), 0);	}
+	if(pJob->nWall)
+	{	Host_SendEvent(pIShell, EVT_KEY, (uint16)(AVK_4 + pJob->nWall - 1), 0);	}
+
+	bOk = Render_Frame(pRender, pJob);
+	while(bOk)
+	{
+		if(!Host_RunNextTimer(pIShell))
+		{
+			if(bPicked)
+			{	break;	}
+			for(i = 0; i < pJob->nBranch; i++)
+			{	Host_SendEvent(pIShell, EVT_KEY, AVK_DOWN, 0);	}
+			Host_SendEvent(pIShell, EVT_KEY, AVK_SELECT, 0);
+
+			//a pick starts the next level, with nothing scheduled there was no menu to pick from
+			bPicked = (Host_PendingTimers(pIShell) > 0);
+			if(!bPicked)
+			{	break;	}
+		}
+		bOk = Render_Frame(pRender, pJob);
+	}
+	Host_StopApplet(pIShell);
+	return bOk && bPicked;
+}
+
+//one story per branch, so every PNG the stories use is in the shared table
+static boolean Render_Warm(Render* pRender)
+{
+	RenderJob job;
+	boolean bOk = TRUE;
+	int i;
+
+	Host_SharePNGs(TRUE);
+	for(i = 0; bOk && i < RENDER_BRANCHES; i++)
+	{
+		memset(&job, 0, sizeof(job));
+		job.nBranch = i;
+		bOk = Render_Story(pRender, &job);
+	}
+	Host_SharePNGs(FALSE);
+	return bOk;
+}
+
+int main(int argc, char* argv[])
+{
+	Render render;
+	RenderJob* pJobs;
+	char szState[512];
+	uint64_t qwStart;
+	uint64_t qwUs;
+	uint32 nFrames = 0;
+	uint32 dwDigest = 2166136261u;
+	boolean bFailed = FALSE;
+	int nRepeat = 1;
+	int nJobs;
+	int i;
+
+	memset(&render, 0, sizeof(render));
+	render.pszAssets = "../Assets.xcassets";
+	render.pszAppDir = "build";
+	render.cxScreen = HOST_SCREEN_CX;
+	render.cyScreen = HOST_SCREEN_CY;
+
+	for(i = 1; i < argc; i++)
+	{
+		if(strcmp(argv[i], "-a") == 0 && i + 1 < argc)
+		{	render.pszAssets = argv[++i];	}
+		else if(strcmp(argv[i], "-d") == 0 && i + 1 < argc)
+		{	render.pszAppDir = argv[++i];	}
+		else if(strcmp(argv[i], "-o") == 0 && i + 1 < argc)
+		{	render.pszOutDir = argv[++i];	}
+		else if(strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+		{	nRepeat = atoi(argv[++i]);	}
+		else if(strcmp(argv[i], "-g") == 0 && i + 1 < argc && sscanf(argv[++i], "%dx%d", &render.cxScreen, &render.cyScreen) == 2
+				&& render.cxScreen > 0 && render.cyScreen > 0)
+		{	;	}
+		else
+		{
+			fprintf(stderr, "usage: %s [-a assetdir] [-d appdir] [-o outdir] [-n repeat] [-g cxXcy]\n", argv[0]);
+			return 2;
+		}
+	}
+	nRepeat = MAX(1, nRepeat);
+	nJobs = RENDER_STORIES * nRepeat;
+
+	//a suspend snapshot left in the applet directory would start every story in the middle
+	snprintf(szState, sizeof(szState), "%s/%s", render.pszAppDir, RENDER_STATE_FILE);
+	remove(szState);
+
+	pJobs = (RenderJob*)calloc(nJobs, sizeof(RenderJob));
+	if(pJobs == NULL)
+	{	return 1;	}
+	for(i = 0; i < nJobs; i++)
+	{
+		pJobs[i].nBranch = (i / (RENDER_BACKS * RENDER_WALLS)) % RENDER_BRANCHES;
+		pJobs[i].nBack = (i / RENDER_WALLS) % RENDER_BACKS;
+		pJobs[i].nWall = i % RENDER_WALLS;
+	}
+
+	qwStart = Host_NowUs();
+	if(!Render_Open(&render) || !Render_Warm(&render))
+	{
+		fprintf(stderr, "could not run the story (assets in %s, hamlet.pak in %s?)\n", render.pszAssets, render.pszAppDir);
+		Render_Close(&render);
+		free(pJobs);
+		return 1;
+	}
+	printf("PNGs decoded once in %.3f ms\n", (Host_NowUs() - qwStart) / 1000.0);
+
+	qwStart = Host_NowUs();
+	for(i = 0; i < nJobs; i++)
+	{
+		if(!Render_Story(&render, &pJobs[i]))
+		{
+			fprintf(stderr, "story %d (%s, back %d, wall %d) failed\n", i, gBranchNames[pJobs[i].nBranch], pJobs[i].nBack, pJobs[i].nWall);
+			bFailed = TRUE;
+		}
+	}
+	qwUs = Host_NowUs() - qwStart;
+	Render_Close(&render);
+
+	for(i = 0; i < nJobs; i++)
+	{
+		nFrames += pJobs[i].nFrames;
+		dwDigest = (dwDigest ^ pJobs[i].dwDigest) * 16777619u;
+	}
+
+	printf("%d stories, %u frames in %.3f s: %.0f frames/s, %.1f stories/s\n",
+		   nJobs, nFrames, qwUs / 1e6, nFrames / (qwUs / 1e6), nJobs / (qwUs / 1e6));
+	printf("frames digest %08x%s%s\n", dwDigest, render.pszOutDir ? ", written to " : "", render.pszOutDir ? render.pszOutDir : "");
+
+	free(pJobs);
+	return bFailed ? 1 : 0;
+}
@@ -0,0 +1,539 @@
+/*===========================================================================
+
+FILE: HamletStress.c
+
+Drives the Hamlet.c applet with long streams of events, as fast as the
+host can hand them over, and reports what each kind of event cost and
+whether any of them left something behind.
+
+	hamlet_stress [-a assetdir] [-d appdir] [-c sword|suspend|command|random|all] [-n events] [-S seed] [-v]
+
+The applet directory is where it finds hamlet.pak (build/ by default).
+
+Timers run on the virtual clock and the story is in replay mode, so it
+never ends: whenever nothing is scheduled and the applet is not
+suspended the story waits at the menu, and it gets a pick of a random
+branch there. Every case runs until it has sent -n events (a million
+by default); a timer dispatch and each key of a pick count as one.
+
+	sword	key repeat on the 1-6 keys between the dispatches of level 5,
+			the 500 ms sword frames, up to STRESS_KEY_REPEAT presses each
+	suspend	EVT_APP_SUSPEND and EVT_APP_RESUME at random, so many of them
+			come unpaired, with the story moved on now and then
+	command	EVT_COMMAND with any wParam, valid branch or not, while the
+			story has a timer pending, so never as the menu's own pick
+	random	all of the above and any key, with the rare restart: the
+			applet is stopped and a new one started, which finds the
+			snapshot file when the last lifecycle event was a suspend
+
+Levels are told apart by IDISPLAY_ClearScreen as in HamletBench.c; only
+the sword case needs them, and it sends nothing else that clears.
+
+Each event is timed on its own, from the call into the host runtime to
+its return, with whatever the applet posted to itself along with it.
+Per kind of event the report gives the rate, latency percentiles out of
+a log2 histogram with 16 steps per power of two (so within 1/16 of the
+real figure), the net change of live objects and heap bytes over all of
+that kind's events, and the calls made through IImages already released.
+The host keeps the husks of released images for that, until the applet
+is stopped (Host_KeepDeadImages); a device would read freed memory.
+
+A run fails when it leaves bytes or objects behind after EVT_APP_STOP,
+a restart finds them left by the applet before it, or any event
+touched a released image.
+
+Only the sword case gets to millions of events a second (about 5 M/s);
+its presses redraw one small layer. The suspend, command and random
+cases run at 0.2-0.3 M/s. An EVT_APP_RESUME after an EVT_APP_SUSPEND,
+and every EVT_COMMAND or timer that moves the story on to a frame that
+clears the screen, puts a whole frame up again, some 10 us on the host;
+an unpaired EVT_APP_RESUME changes nothing and costs a fraction of a us.
+EVT_APP_SUSPEND costs about 4 us when the snapshot file already holds
+the same snapshot and tens of us when it has to be written.
+===========================================================================*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "HostRuntime.h"
+#include "Hamlet.bid"
+
+#define STRESS_LEVELS		7
+#define STRESS_REPLAY_LEVEL	3			// where a replaying story goes after level 7
+#define STRESS_SWORD_LEVEL	5
+#define STRESS_KEY_REPEAT	256			// sword presses between two dispatches
+#define EVT_HAMLET_REPLAY	(EVT_USER + 1)	// as in Hamlet.c
+#define STRESS_STATE_FILE	"hamlet.sav"	// HAMLET_STATE_FILE
+#define STRESS_STEPS		16			// histogram buckets per power of two
+#define STRESS_BUCKETS		(64 * STRESS_STEPS)
+
+enum
+{
+	STRESS_KEY,
+	STRESS_COMMAND,
+	STRESS_SUSPEND,
+	STRESS_RESUME,
+	STRESS_TIMER,
+	STRESS_RESTART,
+	STRESS_TYPES
+};
+
+enum
+{
+	CASE_SWORD,
+	CASE_SUSPEND,
+	CASE_COMMAND,
+	CASE_RANDOM,
+	STRESS_CASES
+};
+
+typedef struct _StressType {
+	uint32		nEvents;
+	uint64_t	qwNs;
+	uint64_t	qwMaxNs;
+	uint32		nBuckets[STRESS_BUCKETS];
+	int32		nObjects;		// net change over this kind's events
+	int32		nBytes;
+	uint32		nDeadCalls;
+} StressType;
+
+// the host's counters as an event found them
+typedef struct _StressMark {
+	uint32		nObjects;
+	uint32		dwBytes;
+	uint32		nDeadCalls;
+	uint64_t	qwNs;
+} StressMark;
+
+typedef struct _Stress {
+	IShell*		pIShell;
+	HostStats*	pStats;
+	uint32		dwSeed;
+	StressType	types[STRESS_TYPES];
+	uint32		nEvents;
+	boolean		bSuspended;		// the last lifecycle event was EVT_APP_SUSPEND
+	uint32		dwBaseBytes;	// with no applet running
+	uint32		nBaseObjects;
+	uint32		nPicks;
+	uint32		nRestarts;
+	uint32		nStalls;		// no timer, no menu: the story was stuck and got a restart
+	uint32		nRestartLeaks;	// stops that left something behind
+} Stress;
+
+static const char* gCaseNames[STRESS_CASES] = { "sword", "suspend", "command", "random" };
+static const char* gTypeNames[STRESS_TYPES] = { "key", "command", "suspend", "resume", "timer", "restart" };
+
+static uint64_t Stress_NowNs(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+//xorshift32, the same stream for the same -S on every host
+static uint32 Stress_Rand(Stress* pStress)
+{
+	uint32 x = pStress->dwSeed;
+
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	pStress->dwSeed = x;
+	return x;
+}
+
+//levels 3-7 clear once each, so past level 7 a replaying story is back at level 3
+static int Stress_Level(uint32 nClears)
+{
+	uint32 nPass = STRESS_LEVELS - STRESS_REPLAY_LEVEL + 1;
+
+	if(nClears <= STRESS_LEVELS)
+	{	return (int)nClears;	}
+	return STRESS_REPLAY_LEVEL + (int)((nClears - STRESS_REPLAY_LEVEL) % nPass);
+}
+
+static uint32 Stress_Objects(const HostStats* pStats)
+{
+	return pStats->nLiveImages + pStats->nLiveBitmaps + pStats->nLiveStatics + pStats->nLiveMenus;
+}
+
+//exact below 16 ns, then STRESS_STEPS buckets for every power of two
+static int Stress_Bucket(uint64_t qwNs)
+{
+	int nLog = 0;
+
+	if(qwNs < STRESS_STEPS)
+	{	return (int)qwNs;	}
+	while((qwNs >> nLog) >= 2 * STRESS_STEPS)
+	{	nLog++;		}
+	return (nLog + 1) * STRESS_STEPS + (int)((qwNs >> nLog) - STRESS_STEPS);
+}
+
+//the most a bucket holds
+static uint64_t Stress_BucketTop(int nBucket)
+{
+	int nLog = nBucket / STRESS_STEPS - 1;
+
+	if(nLog < 0)
+	{	return (uint64_t)nBucket;	}
+	return ((uint64_t)(STRESS_STEPS + nBucket % STRESS_STEPS + 1) << nLog) - 1;
+}
+
+//the latency dPart of nType's events came in under
+static double Stress_PercentileUs(const StressType* pType, double dPart)
+{
+	uint64_t qwWant = (uint64_t)(dPart * pType->nEvents + 0.5);
+	uint64_t qwSeen = 0;
+	int i;
+
+	qwWant = MAX(qwWant, 1);
+	for(i = 0; i < STRESS_BUCKETS; i++)
+	{
+		qwSeen += pType->nBuckets[i];
+		if(qwSeen >= qwWant)
+		{	return MIN(Stress_BucketTop(i), pType->qwMaxNs) / 1000.0;	}
+	}
+	return pType->qwMaxNs / 1000.0;
+}
+
+//the counters first, so the clock is read as close to the call as it gets
+static void Stress_Begin(Stress* pStress, StressMark* pMark)
+{
+	pMark->nObjects = Stress_Objects(pStress->pStats);
+	pMark->dwBytes = pStress->pStats->dwLiveBytes;
+	pMark->nDeadCalls = pStress->pStats->nDeadImageCalls;
+	pMark->qwNs = Stress_NowNs();
+}
+
+static void Stress_End(Stress* pStress, int nType, const StressMark* pMark)
+{
+	uint64_t qwNs = Stress_NowNs() - pMark->qwNs;
+	StressType* pType = &pStress->types[nType];
+
+	pType->nEvents++;
+	pType->qwNs += qwNs;
+	pType->qwMaxNs = MAX(pType->qwMaxNs, qwNs);
+	pType->nBuckets[Stress_Bucket(qwNs)]++;
+	pType->nObjects += (int32)(Stress_Objects(pStress->pStats) - pMark->nObjects);
+	pType->nBytes += (int32)(pStress->pStats->dwLiveBytes - pMark->dwBytes);
+	pType->nDeadCalls += pStress->pStats->nDeadImageCalls - pMark->nDeadCalls;
+	pStress->nEvents++;
+}
+
+static void Stress_Send(Stress* pStress, int nType, AEEEvent eCode, uint16 wParam)
+{
+	StressMark mark;
+
+	Stress_Begin(pStress, &mark);
+	Host_SendEvent(pStress->pIShell, eCode, wParam, 0);
+	Stress_End(pStress, nType, &mark);
+}
+
+static void Stress_Suspend(Stress* pStress)
+{
+	StressMark mark;
+
+	Stress_Begin(pStress, &mark);
+	Host_SuspendApplet(pStress->pIShell);
+	Stress_End(pStress, STRESS_SUSPEND, &mark);
+	pStress->bSuspended = TRUE;
+}
+
+static void Stress_Resume(Stress* pStress)
+{
+	StressMark mark;
+
+	Stress_Begin(pStress, &mark);
+	Host_ResumeApplet(pStress->pIShell);
+	Stress_End(pStress, STRESS_RESUME, &mark);
+	pStress->bSuspended = FALSE;
+}
+
+//starts the applet and puts it in replay mode; the replay event is setup, it is not counted
+static boolean Stress_Start(Stress* pStress)
+{
+	if(!Host_StartApplet(pStress->pIShell, AEECLSID_HAMLET_BID))
+	{	return FALSE;	}
+	Host_SendEvent(pStress->pIShell, EVT_HAMLET_REPLAY, TRUE, 0);
+	pStress->bSuspended = FALSE;
+	return TRUE;
+}
+
+//a new applet in place of the old one; whatever the old one left allocated is counted against it
+static boolean Stress_Restart(Stress* pStress)
+{
+	StressMark mark;
+	boolean bOk;
+
+	Stress_Begin(pStress, &mark);
+	Host_StopApplet(pStress->pIShell);
+	if(pStress->pStats->dwLiveBytes != pStress->dwBaseBytes || Stress_Objects(pStress->pStats) != pStress->nBaseObjects)
+	{	pStress->nRestartLeaks++;	}
+	bOk = Stress_Start(pStress);
+	Stress_End(pStress, STRESS_RESTART, &mark);
+	pStress->nRestarts++;
+	return bOk;
+}
+
+//moves the story on: its next timer, the resume it waits for, or the pick at the menu
+static boolean Stress_Advance(Stress* pStress)
+{
+	StressMark mark;
+	int nDown;
+	int i;
+
+	if(Host_PendingTimers(pStress->pIShell) > 0)
+	{
+		Stress_Begin(pStress, &mark);
+		Host_RunNextTimer(pStress->pIShell);
+		Stress_End(pStress, STRESS_TIMER, &mark);
+		return TRUE;
+	}
+	if(pStress->bSuspended)
+	{
+		Stress_Resume(pStress);
+		return TRUE;
+	}
+
+	nDown = (int)(Stress_Rand(pStress) % 3);
+	for(i = 0; i < nDown; i++)
+	{	Stress_Send(pStress, STRESS_KEY, EVT_KEY, AVK_DOWN);	}
+	Stress_Send(pStress, STRESS_KEY, EVT_KEY, AVK_SELECT);
+	if(Host_PendingTimers(pStress->pIShell) > 0)
+	{
+		pStress->nPicks++;
+		return TRUE;
+	}
+
+	//the keys started nothing, there was no menu up
+	pStress->nStalls++;
+	return Stress_Restart(pStress);
+}
+
+//any wParam, though mostly near the menu's ids so the valid branches come up too
+static uint16 Stress_Command(Stress* pStress)
+{
+	uint32 dwRand = Stress_Rand(pStress);
+
+	return (dwRand & 0x700) ? (uint16)(dwRand % 8) : (uint16)(dwRand >> 16);
+}
+
+//one step of nCase; nRepeat counts the sword presses since the last dispatch
+static boolean Stress_Step(Stress* pStress, int nCase, int* pnRepeat)
+{
+	uint32 dwRand = Stress_Rand(pStress);
+
+	switch(nCase)
+	{
+		case CASE_SWORD:
+			if(Stress_Level(pStress->pStats->nClears) == STRESS_SWORD_LEVEL && *pnRepeat < STRESS_KEY_REPEAT)
+			{
+				Stress_Send(pStress, STRESS_KEY, EVT_KEY, (uint16)(AVK_1 + dwRand % 6));
+				(*pnRepeat)++;
+				return TRUE;
+			}
+			*pnRepeat = 0;
+			return Stress_Advance(pStress);
+
+		case CASE_SUSPEND:
+			if(dwRand % 16 == 0)
+			{	return Stress_Advance(pStress);		}
+			if(dwRand & 0x100)
+			{	Stress_Suspend(pStress);	}
+			else
+			{	Stress_Resume(pStress);		}
+			return TRUE;
+
+		case CASE_COMMAND:
+			if(dwRand % 4 == 0 && Host_PendingTimers(pStress->pIShell) > 0)
+			{
+				Stress_Send(pStress, STRESS_COMMAND, EVT_COMMAND, Stress_Command(pStress));
+				return TRUE;
+			}
+			return Stress_Advance(pStress);
+
+		default:
+			dwRand %= 4096;
+			if(dwRand == 0)
+			{	return Stress_Restart(pStress);	}
+			if(dwRand < 2048)
+			{	Stress_Send(pStress, STRESS_KEY, EVT_KEY, (uint16)(AVK_0 + Stress_Rand(pStress) % (AVK_SELECT - AVK_0 + 1)));	}
+			else if(dwRand < 3072)
+			{	return Stress_Advance(pStress);		}
+			else if(dwRand < 3520)
+			{	Stress_Send(pStress, STRESS_COMMAND, EVT_COMMAND, Stress_Command(pStress));	}
+			else if(dwRand < 3776)
+			{	Stress_Suspend(pStress);	}
+			else
+			{	Stress_Resume(pStress);		}
+			return TRUE;
+	}
+}
+
+static void Stress_Report(const char* pszCase, const Stress* pStress, uint64_t qwWallNs, uint32 dwPeakBytes,
+						  uint32 dwLeakBytes, uint32 nLeakObjects, uint32 dwStoryMs)
+{
+	const StressType* pType;
+	uint64_t qwAppletNs = 0;
+	int i;
+
+	for(i = 0; i < STRESS_TYPES; i++)
+	{	qwAppletNs += pStress->types[i].qwNs;	}
+
+	printf("case %s, %u events in %.3f s: %.2f M/s, %.2f M/s of them in the applet\n", pszCase, pStress->nEvents,
+		   qwWallNs / 1e9, pStress->nEvents * 1e3 / qwWallNs, pStress->nEvents * 1e3 / MAX(qwAppletNs, 1));
+	printf("  event      count     M/s   avg us   p50 us   p90 us   p99 us p99.9 us   max us  objects      bytes  dead\n");
+	for(i = 0; i < STRESS_TYPES; i++)
+	{
+		pType = &pStress->types[i];
+		if(pType->nEvents == 0)
+		{	continue;	}
+
+		printf("  %-8s %7u %7.2f %8.3f %8.3f %8.3f %8.3f %8.3f %8.3f %+8d %+10d %5u\n", gTypeNames[i], pType->nEvents,
+			   pType->nEvents * 1e3 / MAX(pType->qwNs, 1),
+			   pType->qwNs / 1000.0 / pType->nEvents,
+			   Stress_PercentileUs(pType, 0.5),
+			   Stress_PercentileUs(pType, 0.9),
+			   Stress_PercentileUs(pType, 0.99),
+			   Stress_PercentileUs(pType, 0.999),
+			   pType->qwMaxNs / 1000.0,
+			   pType->nObjects,
+			   pType->nBytes,
+			   pType->nDeadCalls);
+	}
+	printf("  %u ms of story, %u picks at the menu, %u restarts, %u of them for a stuck story\n",
+		   dwStoryMs, pStress->nPicks, pStress->nRestarts, pStress->nStalls);
+	if(pStress->nRestartLeaks)
+	{	printf("  %u restarts found the old applet's objects still alive\n", pStress->nRestartLeaks);	}
+	printf("  peak heap %u bytes, %u bytes and %u objects left after EVT_APP_STOP\n\n", dwPeakBytes, dwLeakBytes, nLeakObjects);
+}
+
+//nEvents of nCase against a new applet, then the report
+static boolean Stress_Run(const char* pszAssets, const char* pszAppDir, int nCase, uint32 nEvents, uint32 dwSeed, boolean bVerbose)
+{
+	Stress* pStress = (Stress*)calloc(1, sizeof(Stress));
+	IShell* pIShell = Host_Create(pszAssets, HOST_SCREEN_CX, HOST_SCREEN_CY);
+	char szState[512];
+	uint64_t qwStart;
+	uint64_t qwWallNs;
+	uint32 dwStoryMs;
+	uint32 dwPeakBytes;
+	uint32 dwLeakBytes;
+	uint32 nLeakObjects;
+	uint32 nDeadCalls = 0;
+	int nRepeat = 0;
+	boolean bOk = TRUE;
+	int i;
+
+	if(pStress == NULL || pIShell == NULL)
+	{
+		if(pIShell)
+		{	Host_Destroy(pIShell);	}
+		free(pStress);
+		return FALSE;
+	}
+
+	//a snapshot left by an earlier run would start the story in the middle
+	snprintf(szState, sizeof(szState), "%s/%s", pszAppDir, STRESS_STATE_FILE);
+	remove(szState);
+
+	Host_SetAppDir(pIShell, pszAppDir);
+	Host_SetQuiet(pIShell, !bVerbose);
+	Host_SetVirtualClock(pIShell);
+	Host_KeepDeadImages(pIShell, TRUE);
+
+	pStress->pIShell = pIShell;
+	pStress->pStats = Host_GetStats(pIShell);
+	pStress->dwSeed = dwSeed ? dwSeed : 1;
+	pStress->dwBaseBytes = pStress->pStats->dwLiveBytes;	// the display
+	pStress->nBaseObjects = Stress_Objects(pStress->pStats);
+	if(!Stress_Start(pStress))
+	{	bOk = FALSE;	}
+
+	qwStart = Stress_NowNs();
+	while(bOk && pStress->nEvents < nEvents)
+	{
+		if(!Stress_Step(pStress, nCase, &nRepeat))
+		{	bOk = FALSE;	}
+	}
+	qwWallNs = Stress_NowNs() - qwStart;
+
+	dwStoryMs = (uint32)(Host_ClockUs(pIShell) / 1000);
+	dwPeakBytes = pStress->pStats->dwPeakBytes;
+	Host_StopApplet(pIShell);
+	dwLeakBytes = pStress->pStats->dwLiveBytes - pStress->dwBaseBytes;
+	nLeakObjects = Stress_Objects(pStress->pStats) - pStress->nBaseObjects;
+	remove(szState);
+
+	Stress_Report(gCaseNames[nCase], pStress, qwWallNs, dwPeakBytes, dwLeakBytes, nLeakObjects, dwStoryMs);
+	for(i = 0; i < STRESS_TYPES; i++)
+	{	nDeadCalls += pStress->types[i].nDeadCalls;		}
+	if(!bOk)
+	{	fprintf(stderr, "the applet did not start (assets in %s?)\n", pszAssets);	}
+	if(dwLeakBytes || nLeakObjects || pStress->nRestartLeaks)
+	{
+		fprintf(stderr, "case %s left memory behind\n", gCaseNames[nCase]);
+		bOk = FALSE;
+	}
+	if(nDeadCalls)
+	{
+		fprintf(stderr, "case %s made %u calls through released images\n", gCaseNames[nCase], nDeadCalls);
+		bOk = FALSE;
+	}
+	Host_Destroy(pIShell);
+	free(pStress);
+	return bOk;
+}
+
+int main(int argc, char* argv[])
+{
+	const char* pszAssets = "../Assets.xcassets";
+	const char* pszAppDir = "build";
+	const char* pszCase = "all";
+	uint32 nEvents = 1000000;
+	uint32 dwSeed = 1;
+	boolean bVerbose = FALSE;
+	boolean bOk = TRUE;
+	boolean bRan = FALSE;
+	int nCase;
+	int i;
+
+	for(i = 1; i < argc; i++)
+	{
+		if(strcmp(argv[i], "-a") == 0 && i + 1 < argc)
+		{	pszAssets = argv[++i];	}
+		else if(strcmp(argv[i], "-d") == 0 && i + 1 < argc)
+		{	pszAppDir = argv[++i];	}
+		else if(strcmp(argv[i], "-c") == 0 && i + 1 < argc)
+		{	pszCase = argv[++i];	}
+		else if(strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+		{	nEvents = (uint32)strtoul(argv[++i], NULL, 10);	}
+		else if(strcmp(argv[i], "-S") == 0 && i + 1 < argc)
+		{	dwSeed = (uint32)strtoul(argv[++i], NULL, 10);	}
+		else if(strcmp(argv[i], "-v") == 0)
+		{	bVerbose = TRUE;	}
+		else
+		{
+			fprintf(stderr, "usage: %s [-a assetdir] [-d appdir] [-c sword|suspend|command|random|all] [-n events] [-S seed] [-v]\n", argv[0]);
+			return 2;
+		}
+	}
+
+	for(nCase = 0; nCase < STRESS_CASES; nCase++)
+	{
+		if(strcmp(pszCase, "all") != 0 && strcmp(pszCase, gCaseNames[nCase]) != 0)
+		{	continue;	}
+
+		if(!Stress_Run(pszAssets, pszAppDir, nCase, nEvents, dwSeed, bVerbose))
+		{	bOk = FALSE;	}
+		bRan = TRUE;
+	}
+	if(!bRan)
+	{
+		fprintf(stderr, "no case %s\n", pszCase);
+		return 2;
+	}
+	return bOk ? 0 : 1;
+}
@@ -0,0 +1,367 @@
+/*===========================================================================
+
+FILE: HostBlit.c
+
+The software display's pixel kernels: opaque copy, color-keyed copy and
+fill, for RGB332, RGB565 and RGB888 (one pixel per 32-bit word)
+destinations, plus the expansion of palette-indexed images into each
+of them. Each depth has a scalar set and, where the compiler can
+target them, SSE2, AVX2 and NEON sets; HostBlit_Init picks the widest
+one the CPU runs. Opaque rows go through memcpy on every path, since
+the C library already picks its own vector code for that.
+===========================================================================*/
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HOST_BLIT_X86	1
+#endif
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#define HOST_BLIT_NEON	1
+#endif
+
+#include "HostInternal.h"
+
+#define HOST_BLIT_DEPTHS	3		// 8, 16 and 32 bits per pixel
+#define HOST_BLIT_PATHS		4		// scalar and up to three vector sets
+
+static int HostBlit_DepthIndex(int nDepth);
+
+/*===============================================================================
+SCALAR
+=============================================================================== */
+
+//one copy kernel serves every depth: cx is already in bytes by the time it gets here
+static void HostBlit_CopyRows(byte* pDst, int nDstPitch, const byte* pSrc, int nSrcPitch, int cbRow, int cy)
+{
+	int row;
+
+	for(row = 0; row < cy; row++)
+	{	memcpy(pDst + row * nDstPitch, pSrc + row * nSrcPitch, (size_t)cbRow);	}
+}
+
+#define HOST_BLIT_SCALAR(bits, T)																		\
+static void HostBlit_Copy##bits(byte* pDst, int nDstPitch, const byte* pSrc, int nSrcPitch, int cx, int cy)	\
+{																										\
+	HostBlit_CopyRows(pDst, nDstPitch, pSrc, nSrcPitch, cx * (int)sizeof(T), cy);						\
+}																										\
+static void HostBlit_Keyed##bits(byte* pDst, int nDstPitch, const byte* pSrc, int nSrcPitch,			\
+								 int cx, int cy, uint32 dwKey)											\
+{																										\
+	const T* pIn;																						\
+	T* pOut;																							\
+	int row;																							\
+	int col;																							\
+																										\
+	for(row = 0; row < cy; row++)																		\
+	{																									\
+		pIn = (const T*)(pSrc + row * nSrcPitch);														\
+		pOut = (T*)(pDst + row * nDstPitch);															\
+		for(col = 0; col < cx; col++)																	\
+		{																								\
+			if(pIn[col] != (T)dwKey)																	\
+			{	pOut[col] = pIn[col];	}																\
+		}																								\
+	}																									\
+}																										\
+static void HostBlit_Fill##bits(byte* pDst, int nDstPitch, int cx, int cy, uint32 dwColor)				\
+{																										\
+	T* pOut;																							\
+	int row;																							\
+	int col;																							\
+																										\
+	for(row = 0; row < cy; row++)																		\
+	{																									\
+		pOut = (T*)(pDst + row * nDstPitch);															\
+		for(col = 0; col < cx; col++)																	\
+		{	pOut[col] = (T)dwColor;	}																	\
+	}																									\
+}
+
+HOST_BLIT_SCALAR(8, uint8)
+HOST_BLIT_SCALAR(16, uint16)
+HOST_BLIT_SCALAR(32, uint32)
+
+/*===============================================================================
+INDEXED
+=============================================================================== */
+
+//one palette lookup a pixel, out of a palette in the destination's format, so there is no vector set;
+//the keyed one leaves the destination alone wherever the palette has the key
+#define HOST_BLIT_EXPAND(bits, T)																		\
+void HostBlit_Expand##bits(byte* pDst, int nDstPitch, const byte* pSrc, int nSrcPitch, int cx, int cy,	\
+						   const T* pPalette)															\
+{																										\
+	const byte* pIn;																					\
+	T* pOut;																							\
+	int row;																							\
+	int col;																							\
+																										\
+	for(row = 0; row < cy; row++)																		\
+	{																									\
+		pIn = pSrc + row * nSrcPitch;																	\
+		pOut = (T*)(pDst + row * nDstPitch);															\
+		for(col = 0; col < cx; col++)																	\
+		{	pOut[col] = pPalette[pIn[col]];	}															\
+	}																									\
+}																										\
+void HostBlit_ExpandKeyed##bits(byte* pDst, int nDstPitch, const byte* pSrc, int nSrcPitch, int cx, int cy,	\
+								const T* pPalette, uint32 dwKey)										\
+{																										\
+	const byte* pIn;																					\
+	T* pOut;																							\
+	T color;																							\
+	int row;																							\
+	int col;																							\
+																										\
+	for(row = 0; row < cy; row++)																		\
+	{																									\
+		pIn = pSrc + row * nSrcPitch;																	\
+		pOut = (T*)(pDst + row * nDstPitch);															\
+		for(col = 0; col < cx; col++)																	\
+		{																								\
+			color = pPalette[pIn[col]];																	\
+			if(color != (T)dwKey)																		\
+			{	pOut[col] = color;	}																	\
+		}																								\
+	}																									\
+}
+
+HOST_BLIT_EXPAND(8, uint8)
+HOST_BLIT_EXPAND(16, uint16)
+HOST_BLIT_EXPAND(32, uint32)
+
+/*===============================================================================
+SSE2 AND AVX2
+=============================================================================== */
+#if HOST_BLIT_X86
+
+//the vector loop covers whole registers, the scalar kernel finishes each row's tail
+#define HOST_BLIT_VECTOR(isa, attr, bits, T, V, load, store, set1, cmpeq, select, alltrue, nonetrue)	\
+attr static void HostBlit_Keyed##bits##_##isa(byte* pDst, int nDstPitch, const byte* pSrc, int nSrcPitch,	\
+											  int cx, int cy, uint32 dwKey)								\
+{																										\
+	const int nLanes = (int)(sizeof(V) / sizeof(T));													\
+	const V vKey = set1((T)dwKey);																		\
+	const T* pIn;																						\
+	T* pOut;																							\
+	V vSrc;																								\
+	V vMask;																							\
+	int row;																							\
+	int col;																							\
+																										\
+	for(row = 0; row < cy; row++)																		\
+	{																									\
+		pIn = (const T*)(pSrc + row * nSrcPitch);														\
+		pOut = (T*)(pDst + row * nDstPitch);															\
+		for(col = 0; col + nLanes <= cx; col += nLanes)													\
+		{																								\
+			vSrc = load((const V*)(pIn + col));															\
+			vMask = cmpeq(vSrc, vKey);																	\
+			if(alltrue(vMask))																			\
+			{	continue;	}																			\
+			if(nonetrue(vMask))																			\
+			{	store((V*)(pOut + col), vSrc);	}														\
+			else																						\
+			{	store((V*)(pOut + col), select(vMask, load((const V*)(pOut + col)), vSrc));	}			\
+		}																								\
+		HostBlit_Keyed##bits((byte*)(pOut + col), 0, (const byte*)(pIn + col), 0, cx - col, 1, dwKey);	\
+	}																									\
+}																										\
+attr static void HostBlit_Fill##bits##_##isa(byte* pDst, int nDstPitch, int cx, int cy, uint32 dwColor)	\
+{																										\
+	const int nLanes = (int)(sizeof(V) / sizeof(T));													\
+	const V vColor = set1((T)dwColor);																	\
+	T* pOut;																							\
+	int row;																							\
+	int col;																							\
+																										\
+	for(row = 0; row < cy; row++)																		\
+	{																									\
+		pOut = (T*)(pDst + row * nDstPitch);															\
+		for(col = 0; col + nLanes <= cx; col += nLanes)													\
+		{	store((V*)(pOut + col), vColor);	}														\
+		HostBlit_Fill##bits((byte*)(pOut + col), 0, cx - col, 1, dwColor);								\
+	}																									\
+}
+
+//SSE2 has no blend: keep the destination where the mask is set, the source elsewhere
+#define SSE2_SELECT(m, d, s)	_mm_or_si128(_mm_and_si128((m), (d)), _mm_andnot_si128((m), (s)))
+#define SSE2_ALL(m)				(_mm_movemask_epi8(m) == 0xFFFF)
+#define SSE2_NONE(m)			(_mm_movemask_epi8(m) == 0)
+#define SSE2_SET1_8(c)			_mm_set1_epi8((char)(c))
+#define SSE2_SET1_16(c)			_mm_set1_epi16((short)(c))
+#define SSE2_SET1_32(c)			_mm_set1_epi32((int)(c))
+
+HOST_BLIT_VECTOR(sse2, __attribute__((target("sse2"))), 8, uint8, __m128i, _mm_loadu_si128, _mm_storeu_si128,
+				 SSE2_SET1_8, _mm_cmpeq_epi8, SSE2_SELECT, SSE2_ALL, SSE2_NONE)
+HOST_BLIT_VECTOR(sse2, __attribute__((target("sse2"))), 16, uint16, __m128i, _mm_loadu_si128, _mm_storeu_si128,
+				 SSE2_SET1_16, _mm_cmpeq_epi16, SSE2_SELECT, SSE2_ALL, SSE2_NONE)
+HOST_BLIT_VECTOR(sse2, __attribute__((target("sse2"))), 32, uint32, __m128i, _mm_loadu_si128, _mm_storeu_si128,
+				 SSE2_SET1_32, _mm_cmpeq_epi32, SSE2_SELECT, SSE2_ALL, SSE2_NONE)
+
+#define AVX2_SELECT(m, d, s)	_mm256_blendv_epi8((s), (d), (m))
+#define AVX2_ALL(m)				(_mm256_movemask_epi8(m) == -1)
+#define AVX2_NONE(m)			(_mm256_movemask_epi8(m) == 0)
+#define AVX2_SET1_8(c)			_mm256_set1_epi8((char)(c))
+#define AVX2_SET1_16(c)			_mm256_set1_epi16((short)(c))
+#define AVX2_SET1_32(c)			_mm256_set1_epi32((int)(c))
+
+HOST_BLIT_VECTOR(avx2, __attribute__((target("avx2"))), 8, uint8, __m256i, _mm256_loadu_si256, _mm256_storeu_si256,
+				 AVX2_SET1_8, _mm256_cmpeq_epi8, AVX2_SELECT, AVX2_ALL, AVX2_NONE)
+HOST_BLIT_VECTOR(avx2, __attribute__((target("avx2"))), 16, uint16, __m256i, _mm256_loadu_si256, _mm256_storeu_si256,
+				 AVX2_SET1_16, _mm256_cmpeq_epi16, AVX2_SELECT, AVX2_ALL, AVX2_NONE)
+HOST_BLIT_VECTOR(avx2, __attribute__((target("avx2"))), 32, uint32, __m256i, _mm256_loadu_si256, _mm256_storeu_si256,
+				 AVX2_SET1_32, _mm256_cmpeq_epi32, AVX2_SELECT, AVX2_ALL, AVX2_NONE)
+
+#endif // HOST_BLIT_X86
+
+/*===============================================================================
+NEON
+=============================================================================== */
+#if HOST_BLIT_NEON
+
+#define NEON_KERNELS(bits, T, V, sfx)																	\
+static void HostBlit_Keyed##bits##_neon(byte* pDst, int nDstPitch, const byte* pSrc, int nSrcPitch,	\
+										int cx, int cy, uint32 dwKey)									\
+{																										\
+	const int nLanes = (int)(sizeof(V) / sizeof(T));													\
+	const V vKey = vdupq_n_##sfx((T)dwKey);																\
+	const T* pIn;																						\
+	T* pOut;																							\
+	V vSrc;																								\
+	int row;																							\
+	int col;																							\
+																										\
+	for(row = 0; row < cy; row++)																		\
+	{																									\
+		pIn = (const T*)(pSrc + row * nSrcPitch);														\
+		pOut = (T*)(pDst + row * nDstPitch);															\
+		for(col = 0; col + nLanes <= cx; col += nLanes)													\
+		{																								\
+			vSrc = vld1q_##sfx(pIn + col);																\
+			vst1q_##sfx(pOut + col, vbslq_##sfx(vceqq_##sfx(vSrc, vKey), vld1q_##sfx(pOut + col), vSrc));	\
+		}																								\
+		HostBlit_Keyed##bits((byte*)(pOut + col), 0, (const byte*)(pIn + col), 0, cx - col, 1, dwKey);	\
+	}																									\
+}																										\
+static void HostBlit_Fill##bits##_neon(byte* pDst, int nDstPitch, int cx, int cy, uint32 dwColor)		\
+{																										\
+	const int nLanes = (int)(sizeof(V) / sizeof(T));													\
+	const V vColor = vdupq_n_##sfx((T)dwColor);															\
+	T* pOut;																							\
+	int row;																							\
+	int col;																							\
+																										\
+	for(row = 0; row < cy; row++)																		\
+	{																									\
+		pOut = (T*)(pDst + row * nDstPitch);															\
+		for(col = 0; col + nLanes <= cx; col += nLanes)													\
+		{	vst1q_##sfx(pOut + col, vColor);	}														\
+		HostBlit_Fill##bits((byte*)(pOut + col), 0, cx - col, 1, dwColor);								\
+	}																									\
+}
+
+NEON_KERNELS(8, uint8, uint8x16_t, u8)
+NEON_KERNELS(16, uint16, uint16x8_t, u16)
+NEON_KERNELS(32, uint32, uint32x4_t, u32)
+
+#endif // HOST_BLIT_NEON
+
+/*===============================================================================
+SELECTION
+=============================================================================== */
+
+//[depth][path], scalar first; a path this build or this CPU lacks has a NULL name
+static HostBlitKernels gKernels[HOST_BLIT_DEPTHS][HOST_BLIT_PATHS] =
+{
+	{
+		{ "scalar",	8,	HostBlit_Copy8,		HostBlit_Keyed8,		HostBlit_Fill8 },
+#if HOST_BLIT_X86
+		{ "sse2",	8,	HostBlit_Copy8,		HostBlit_Keyed8_sse2,	HostBlit_Fill8_sse2 },
+		{ "avx2",	8,	HostBlit_Copy8,		HostBlit_Keyed8_avx2,	HostBlit_Fill8_avx2 },
+#endif
+#if HOST_BLIT_NEON
+		{ "neon",	8,	HostBlit_Copy8,		HostBlit_Keyed8_neon,	HostBlit_Fill8_neon },
+#endif
+	},
+	{
+		{ "scalar",	16,	HostBlit_Copy16,	HostBlit_Keyed16,		HostBlit_Fill16 },
+#if HOST_BLIT_X86
+		{ "sse2",	16,	HostBlit_Copy16,	HostBlit_Keyed16_sse2,	HostBlit_Fill16_sse2 },
+		{ "avx2",	16,	HostBlit_Copy16,	HostBlit_Keyed16_avx2,	HostBlit_Fill16_avx2 },
+#endif
+#if HOST_BLIT_NEON
+		{ "neon",	16,	HostBlit_Copy16,	HostBlit_Keyed16_neon,	HostBlit_Fill16_neon },
+#endif
+	},
+	{
+		{ "scalar",	32,	HostBlit_Copy32,	HostBlit_Keyed32,		HostBlit_Fill32 },
+#if HOST_BLIT_X86
+		{ "sse2",	32,	HostBlit_Copy32,	HostBlit_Keyed32_sse2,	HostBlit_Fill32_sse2 },
+		{ "avx2",	32,	HostBlit_Copy32,	HostBlit_Keyed32_avx2,	HostBlit_Fill32_avx2 },
+#endif
+#if HOST_BLIT_NEON
+		{ "neon",	32,	HostBlit_Copy32,	HostBlit_Keyed32_neon,	HostBlit_Fill32_neon },
+#endif
+	},
+};
+
+static const HostBlitKernels* gpSelected[HOST_BLIT_DEPTHS];
+
+//drops the paths the CPU cannot run, then takes the last one left for each depth
+void HostBlit_Init(void)
+{
+	int nDepth;
+	int nPath;
+
+	if(gpSelected[0])
+	{	return;		}
+
+	for(nDepth = 0; nDepth < HOST_BLIT_DEPTHS; nDepth++)
+	{
+		for(nPath = 0; nPath < HOST_BLIT_PATHS && gKernels[nDepth][nPath].pszPath; nPath++)
+		{
+#if HOST_BLIT_X86
+			if(strcmp(gKernels[nDepth][nPath].pszPath, "avx2") == 0 && !__builtin_cpu_supports("avx2"))
+			{
+				gKernels[nDepth][nPath].pszPath = NULL;
+				break;
+			}
+#endif
+			gpSelected[nDepth] = &gKernels[nDepth][nPath];
+		}
+	}
+}
+
+//the kernels bitmaps of nDepth bits per pixel draw with, NULL for a depth there are none for
+const HostBlitKernels* HostBlit_Get(int nDepth)
+{
+	int nIndex = HostBlit_DepthIndex(nDepth);
+
+	HostBlit_Init();
+	return nIndex < 0 ? NULL : gpSelected[nIndex];
+}
+
+//every path this CPU can run for nDepth, scalar at nPath 0; NULL past the last one
+const HostBlitKernels* HostBlit_GetPath(int nDepth, int nPath)
+{
+	int nIndex = HostBlit_DepthIndex(nDepth);
+
+	HostBlit_Init();
+	if(nIndex < 0 || nPath < 0 || nPath >= HOST_BLIT_PATHS || gKernels[nIndex][nPath].pszPath == NULL)
+	{	return NULL;	}
+	return &gKernels[nIndex][nPath];
+}
+
+static int HostBlit_DepthIndex(int nDepth)
+{
+	switch(nDepth)
+	{
+		case 8:		return 0;
+		case 16:	return 1;
+		case 32:	return 2;
+		default:	return -1;
+	}
+}
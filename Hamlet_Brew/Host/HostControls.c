@@ -0,0 +1,314 @@
+/*===========================================================================
+
+FILE: HostControls.c
+
+IStatic and IMenuCtl on the host. Both draw through the shell's IDisplay
+with the greeked fonts of HostDisplay.c and update the display when they
+redraw, like the handset's controls. The menu posts EVT_COMMAND with the
+selected item's ID.
+===========================================================================*/
+#include "HostInternal.h"
+
+#define HOST_MENU_ITEM_CY	14		// BrewMenu.swift's itemHeight
+#define HOST_MENU_FRAME		MAKE_RGB(0, 0, 255)
+
+static int	HostStatic_DrawLine(IDisplay* pIDisplay, AEEFont nFont, const AECHAR* pText, int nChars,
+								const AEERect* prc, int y);
+static void	HostMenu_DrawFrame(IDisplay* pIDisplay, const AEERect* prc);
+
+/*===============================================================================
+ISTATIC
+=============================================================================== */
+
+IStatic* HostStatic_New(IShell* pIShell)
+{
+	IStatic* pStatic = (IStatic*)MALLOC(sizeof(IStatic));
+
+	if(pStatic == NULL)
+	{	return NULL;	}
+
+	pStatic->nRefs = 1;
+	pStatic->pIShell = pIShell;
+	pStatic->fntTitle = AEE_FONT_BOLD;
+	pStatic->fntText = AEE_FONT_NORMAL;
+	pIShell->stats.nLiveStatics++;
+	return pStatic;
+}
+
+uint32 ISTATIC_Release(IStatic* po)
+{
+	if(--po->nRefs)
+	{	return po->nRefs;	}
+
+	po->pIShell->stats.nLiveStatics--;
+	FREE(po);
+	return 0;
+}
+
+void ISTATIC_SetRect(IStatic* po, const AEERect* prc)
+{
+	po->rc = *prc;
+}
+
+void ISTATIC_GetRect(IStatic* po, AEERect* prc)
+{
+	*prc = po->rc;
+}
+
+boolean ISTATIC_SetText(IStatic* po, AECHAR* pTitle, AECHAR* pText, AEEFont fntTitle, AEEFont fntText)
+{
+	po->szTitle[0] = 0;
+	po->szText[0] = 0;
+	if(pTitle && WSTRLEN(pTitle) < HOST_TEXT_MAX)
+	{	WSTRCPY(po->szTitle, pTitle);	}
+	if(pText && WSTRLEN(pText) < HOST_TEXT_MAX)
+	{	WSTRCPY(po->szText, pText);	}
+	po->fntTitle = fntTitle;
+	po->fntText = fntText;
+	return TRUE;
+}
+
+//title on the first line, then the text word-wrapped to the rect; '\n' breaks a line
+boolean ISTATIC_Redraw(IStatic* po)
+{
+	IDisplay* pIDisplay = po->pIShell->pIDisplay;
+	const AECHAR* pText = po->szText;
+	int nWidth = po->rc.dx - 2;
+	int y = po->rc.y;
+	int nFits;
+	int nBreak;
+	int i;
+
+	IDISPLAY_SetClipRect(pIDisplay, &po->rc);
+	IDISPLAY_EraseRect(pIDisplay, &po->rc);
+	if(po->szTitle[0])
+	{	y = HostStatic_DrawLine(pIDisplay, po->fntTitle, po->szTitle, WSTRLEN(po->szTitle), &po->rc, y);	}
+
+	while(*pText && y < po->rc.y + po->rc.dy)
+	{
+		IDISPLAY_MeasureTextEx(pIDisplay, po->fntText, pText, -1, nWidth, &nFits);
+		nBreak = -1;
+		for(i = 0; pText[i] && i <= nFits; i++)
+		{
+			if(pText[i] == '\n')
+			{
+				nBreak = i;
+				break;
+			}
+			if(pText[i] == ' ')
+			{	nBreak = i;	}
+		}
+		if(pText[i] == 0 && i <= nFits)
+		{	nBreak = i;		}
+		else if(nBreak < 0)
+		{	nBreak = MAX(1, nFits);	}
+
+		y = HostStatic_DrawLine(pIDisplay, po->fntText, pText, nBreak, &po->rc, y);
+		pText += nBreak;
+		if(*pText == ' ' || *pText == '\n')
+		{	pText++;	}
+	}
+	IDISPLAY_SetClipRect(pIDisplay, NULL);
+	IDISPLAY_Update(pIDisplay);
+	return TRUE;
+}
+
+static int HostStatic_DrawLine(IDisplay* pIDisplay, AEEFont nFont, const AECHAR* pText, int nChars,
+							   const AEERect* prc, int y)
+{
+	IDISPLAY_DrawText(pIDisplay, nFont, pText, nChars, prc->x + 1, y, NULL, IDF_ALIGN_NONE);
+	return y + HostDisplay_FontHeight(nFont);
+}
+
+/*===============================================================================
+IMENUCTL
+=============================================================================== */
+
+IMenuCtl* HostMenu_New(IShell* pIShell)
+{
+	IMenuCtl* pMenu = (IMenuCtl*)MALLOC(sizeof(IMenuCtl));
+
+	if(pMenu == NULL)
+	{	return NULL;	}
+
+	pMenu->nRefs = 1;
+	pMenu->pIShell = pIShell;
+	pIShell->stats.nLiveMenus++;
+	return pMenu;
+}
+
+uint32 IMENUCTL_Release(IMenuCtl* po)
+{
+	if(--po->nRefs)
+	{	return po->nRefs;	}
+
+	if(po->pIShell->pActiveMenu == po)
+	{	po->pIShell->pActiveMenu = NULL;	}
+	po->pIShell->stats.nLiveMenus--;
+	po->pIShell->stats.nLiveMenuItems -= po->nItems;
+	FREE(po);
+	return 0;
+}
+
+//up and down move the selection, select posts EVT_COMMAND with the item ID
+boolean IMENUCTL_HandleEvent(IMenuCtl* po, AEEEvent evt, uint16 wParam, uint32 dwParam)
+{
+	(void)dwParam;
+	if(!po->bActive || evt != EVT_KEY || po->nItems == 0)
+	{	return FALSE;	}
+
+	switch(wParam)
+	{
+		case AVK_UP:
+			if(po->nSel > 0)
+			{
+				po->nSel--;
+				IMENUCTL_Redraw(po);
+			}
+			return TRUE;
+		case AVK_DOWN:
+			if(po->nSel < po->nItems - 1)
+			{
+				po->nSel++;
+				IMENUCTL_Redraw(po);
+			}
+			return TRUE;
+		case AVK_SELECT:
+			return ISHELL_PostEvent(po->pIShell, 0, EVT_COMMAND, po->items[po->nSel].nItemID, 0);
+		default:
+			return FALSE;
+	}
+}
+
+//centered title and items, one row each, with a frame around the selection
+boolean IMENUCTL_Redraw(IMenuCtl* po)
+{
+	IDisplay* pIDisplay = po->pIShell->pIDisplay;
+	AEERect rcRow;
+	const AECHAR* pText;
+	AEEFont nFont;
+	int nWidth;
+	int i;
+
+	IDISPLAY_SetClipRect(pIDisplay, &po->rc);
+	IDISPLAY_EraseRect(pIDisplay, &po->rc);
+
+	rcRow = po->rc;
+	rcRow.dy = HOST_MENU_ITEM_CY;
+	for(i = -1; i < po->nItems; i++)
+	{
+		pText = (i < 0) ? po->szTitle : po->items[i].szText;
+		nFont = (i < 0) ? AEE_FONT_BOLD : AEE_FONT_NORMAL;
+		nWidth = IDISPLAY_MeasureText(pIDisplay, nFont, pText);
+		IDISPLAY_DrawText(pIDisplay, nFont, pText, -1, rcRow.x + (rcRow.dx - nWidth) / 2,
+						  rcRow.y + (HOST_MENU_ITEM_CY - HostDisplay_FontHeight(nFont)) / 2, NULL, IDF_ALIGN_NONE);
+		if(i == po->nSel)
+		{	HostMenu_DrawFrame(pIDisplay, &rcRow);	}
+		rcRow.y += HOST_MENU_ITEM_CY;
+	}
+	IDISPLAY_SetClipRect(pIDisplay, NULL);
+	IDISPLAY_Update(pIDisplay);
+	return TRUE;
+}
+
+void IMENUCTL_SetActive(IMenuCtl* po, boolean bActive)
+{
+	po->bActive = bActive;
+	if(bActive)
+	{
+		po->pIShell->pActiveMenu = po;
+		IMENUCTL_Redraw(po);
+	}
+	else if(po->pIShell->pActiveMenu == po)
+	{
+		po->pIShell->pActiveMenu = NULL;
+	}
+}
+
+boolean IMENUCTL_IsActive(IMenuCtl* po)
+{
+	return po->bActive;
+}
+
+void IMENUCTL_SetRect(IMenuCtl* po, const AEERect* prc)
+{
+	po->rc = *prc;
+}
+
+void IMENUCTL_GetRect(IMenuCtl* po, AEERect* prc)
+{
+	*prc = po->rc;
+}
+
+boolean IMENUCTL_SetTitle(IMenuCtl* po, const char* pszResFile, uint16 wResID, AECHAR* pText)
+{
+	if(pText)
+	{	WSTRCPY(po->szTitle, pText);	}
+	else
+	{	ISHELL_LoadResString(po->pIShell, pszResFile, wResID, po->szTitle, sizeof(po->szTitle));	}
+	return TRUE;
+}
+
+boolean IMENUCTL_AddItem(IMenuCtl* po, const char* pszResFile, uint16 wResID, uint16 nItemID,
+						 AECHAR* pText, uint32 lData)
+{
+	HostMenuItem* pItem;
+
+	(void)lData;
+	if(po->nItems == HOST_MAX_MENUITEMS)
+	{	return FALSE;	}
+
+	pItem = &po->items[po->nItems++];
+	po->pIShell->stats.nLiveMenuItems++;
+	pItem->nItemID = nItemID;
+	if(pText)
+	{	WSTRCPY(pItem->szText, pText);	}
+	else
+	{	ISHELL_LoadResString(po->pIShell, pszResFile, wResID, pItem->szText, sizeof(pItem->szText));	}
+	return TRUE;
+}
+
+boolean IMENUCTL_DeleteAll(IMenuCtl* po)
+{
+	po->pIShell->stats.nLiveMenuItems -= po->nItems;
+	po->nItems = 0;
+	po->nSel = 0;
+	return TRUE;
+}
+
+uint16 IMENUCTL_GetSel(IMenuCtl* po)
+{
+	return po->nItems ? po->items[po->nSel].nItemID : 0;
+}
+
+void IMENUCTL_SetSel(IMenuCtl* po, uint16 nItemID)
+{
+	int i;
+
+	for(i = 0; i < po->nItems; i++)
+	{
+		if(po->items[i].nItemID == nItemID)
+		{	po->nSel = i;	}
+	}
+}
+
+int IMENUCTL_GetItemCount(IMenuCtl* po)
+{
+	return po->nItems;
+}
+
+static void HostMenu_DrawFrame(IDisplay* pIDisplay, const AEERect* prc)
+{
+	AEERect rcEdge;
+
+	rcEdge = *prc;
+	rcEdge.dy = 1;
+	IDISPLAY_FillRect(pIDisplay, &rcEdge, HOST_MENU_FRAME);
+	rcEdge.y = (int16)(prc->y + prc->dy - 1);
+	IDISPLAY_FillRect(pIDisplay, &rcEdge, HOST_MENU_FRAME);
+	rcEdge = *prc;
+	rcEdge.dx = 1;
+	IDISPLAY_FillRect(pIDisplay, &rcEdge, HOST_MENU_FRAME);
+	rcEdge.x = (int16)(prc->x + prc->dx - 1);
+	IDISPLAY_FillRect(pIDisplay, &rcEdge, HOST_MENU_FRAME);
+}
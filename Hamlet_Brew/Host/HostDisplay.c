@@ -0,0 +1,585 @@
+/*===========================================================================
+
+FILE: HostDisplay.c
+
+IDisplay and IBitmap on the host. The device bitmap is an in-memory
+framebuffer of the host's color depth: RGB565 unless Host_SetColorDepth
+asks for RGB332 or for RGB888 in 32-bit words. Images stay in RGB565,
+or indexed over an RGB565 palette, and are converted as they are drawn
+into a bitmap of another depth. Every draw widens its dirty rect and
+IDISPLAY_Update "pushes" that rect, which is what gets counted. Like a
+handset's, it sends whatever was drawn, even the same pixels over
+again; keeping redundant draws off the screen is the applet's job.
+The pixels themselves are moved by the kernels in HostBlit.c, picked by
+the destination's depth. Text is greeked: each glyph is a solid cell of the font's size.
+===========================================================================*/
+#include "HostInternal.h"
+
+typedef struct _HostFont {
+	AEEFont	nFont;
+	int		nAscent;
+	int		nDescent;
+	int		nAdvance;
+} HostFont;
+
+static const HostFont gFonts[] =
+{
+	{ AEE_FONT_NORMAL,	8,	2,	5 },
+	{ AEE_FONT_BOLD,	9,	2,	6 },
+	{ AEE_FONT_LARGE,	11,	3,	7 },
+};
+
+static const HostFont*	HostDisplay_Font(AEEFont nFont);
+static boolean			HostRect_Clip(AEERect* prc, const AEERect* prcClip);
+static void				HostBitmap_Touch(IBitmap* pBmp, const AEERect* prc);
+static NativeColor		HostDisplay_ToNative(int nDepth, RGBVAL clr);
+static NativeColor		HostDisplay_From565(int nDepth, uint16 wColor);
+
+/*===============================================================================
+BITMAPS
+=============================================================================== */
+
+IBitmap* HostBitmap_New(IShell* pIShell, int cx, int cy, int nDepth)
+{
+	IBitmap* pBmp = (IBitmap*)MALLOC(sizeof(IBitmap));
+
+	if(pBmp == NULL)
+	{	return NULL;	}
+
+	pBmp->dib.pBmp = (byte*)MALLOC((uint32)(cx * cy * (nDepth / 8)));
+	if(pBmp->dib.pBmp == NULL)
+	{
+		FREE(pBmp);
+		return NULL;
+	}
+	pBmp->dib.cx = (uint16)cx;
+	pBmp->dib.cy = (uint16)cy;
+	pBmp->dib.nPitch = (int16)(cx * (nDepth / 8));
+	pBmp->dib.nDepth = (uint8)nDepth;
+	pBmp->dib.nColorScheme = (nDepth == 8) ? IDIB_COLORSCHEME_332 : (nDepth == 16) ? IDIB_COLORSCHEME_565 : IDIB_COLORSCHEME_888;
+	pBmp->dib.ncTransparent = HostDisplay_ToNative(nDepth, HOST_KEY_RGB);
+	pBmp->nRefs = 1;
+	pBmp->pIShell = pIShell;
+	pIShell->stats.nLiveBitmaps++;
+	return pBmp;
+}
+
+uint32 IBITMAP_AddRef(IBitmap* po)
+{
+	return ++po->nRefs;
+}
+
+uint32 IBITMAP_Release(IBitmap* po)
+{
+	if(--po->nRefs)
+	{	return po->nRefs;	}
+
+	po->pIShell->stats.nLiveBitmaps--;
+	FREE(po->dib.pBmp);
+	FREE(po);
+	return 0;
+}
+
+int IBITMAP_QueryInterface(IBitmap* po, AEECLSID cls, void** ppo)
+{
+	if(cls != AEECLSID_DIB)
+	{
+		*ppo = NULL;
+		return ECLASSNOTSUPPORT;
+	}
+	IBITMAP_AddRef(po);
+	*ppo = &po->dib;
+	return SUCCESS;
+}
+
+int IBITMAP_CreateCompatibleBitmap(IBitmap* po, IBitmap** ppIBitmap, uint16 w, uint16 h)
+{
+	*ppIBitmap = HostBitmap_New(po->pIShell, w, h, po->dib.nDepth);
+	return *ppIBitmap ? SUCCESS : ENOMEMORY;
+}
+
+int IBITMAP_BltIn(IBitmap* po, int xDst, int yDst, int dx, int dy, IBitmap* pSrc, int xSrc, int ySrc, AEERasterOp rop)
+{
+	AEERect rcAll;
+
+	rcAll.x = 0;
+	rcAll.y = 0;
+	rcAll.dx = (int16)po->dib.cx;
+	rcAll.dy = (int16)po->dib.cy;
+	HostBitmap_Blit(po, &rcAll, xDst, yDst, pSrc->dib.pBmp, pSrc->dib.nPitch,
+					xSrc, ySrc, MIN(dx, pSrc->dib.cx - xSrc), MIN(dy, pSrc->dib.cy - ySrc), rop);
+	return SUCCESS;
+}
+
+NativeColor IBITMAP_RGBToNative(IBitmap* po, RGBVAL rgb)
+{
+	return HostDisplay_ToNative(po->dib.nDepth, rgb);
+}
+
+int IBITMAP_Invalidate(IBitmap* po, const AEERect* prc)
+{
+	AEERect rc;
+
+	if(prc == NULL)
+	{
+		rc.x = 0;
+		rc.y = 0;
+		rc.dx = (int16)po->dib.cx;
+		rc.dy = (int16)po->dib.cy;
+		prc = &rc;
+	}
+	HostBitmap_Touch(po, prc);
+	return SUCCESS;
+}
+
+//copies a cx*cy block of pixels in pDst's format, nSrcPitch in bytes; AEE_RO_TRANSPARENT skips the key color
+void HostBitmap_Blit(IBitmap* pDst, const AEERect* prcClip, int x, int y,
+					 const byte* pSrc, int nSrcPitch, int xSrc, int ySrc, int cx, int cy, int nRop)
+{
+	const HostBlitKernels* pKernels = HostBlit_Get(pDst->dib.nDepth);
+	int nBytes = pDst->dib.nDepth / 8;
+	AEERect rc;
+	byte* pOut;
+	const byte* pIn;
+
+	rc.x = (int16)x;
+	rc.y = (int16)y;
+	rc.dx = (int16)cx;
+	rc.dy = (int16)cy;
+	if(pKernels == NULL || cx <= 0 || cy <= 0 || !HostRect_Clip(&rc, prcClip))
+	{	return;		}
+
+	xSrc += rc.x - x;
+	ySrc += rc.y - y;
+	pIn = pSrc + ySrc * nSrcPitch + xSrc * nBytes;
+	pOut = pDst->dib.pBmp + rc.y * pDst->dib.nPitch + rc.x * nBytes;
+	if(nRop == AEE_RO_TRANSPARENT)
+	{	pKernels->pfnKeyed(pOut, pDst->dib.nPitch, pIn, nSrcPitch, rc.dx, rc.dy, pDst->dib.ncTransparent);	}
+	else
+	{	pKernels->pfnCopy(pOut, pDst->dib.nPitch, pIn, nSrcPitch, rc.dx, rc.dy);	}
+
+	pDst->pIShell->stats.dwPixelsDrawn += (uint32)(rc.dx * rc.dy);
+	HostBitmap_Touch(pDst, &rc);
+}
+
+//the same for RGB565 pixels, converted one by one when pDst has another depth
+void HostBitmap_Blit565(IBitmap* pDst, const AEERect* prcClip, int x, int y,
+						const uint16* pSrc, int nSrcPitch, int xSrc, int ySrc, int cx, int cy, int nRop)
+{
+	AEERect rc;
+	const uint16* pIn;
+	byte* pOut;
+	int row;
+	int col;
+
+	if(pDst->dib.nDepth == 16)
+	{
+		HostBitmap_Blit(pDst, prcClip, x, y, (const byte*)pSrc, nSrcPitch, xSrc, ySrc, cx, cy, nRop);
+		return;
+	}
+
+	rc.x = (int16)x;
+	rc.y = (int16)y;
+	rc.dx = (int16)cx;
+	rc.dy = (int16)cy;
+	if(cx <= 0 || cy <= 0 || !HostRect_Clip(&rc, prcClip))
+	{	return;		}
+
+	xSrc += rc.x - x;
+	ySrc += rc.y - y;
+	for(row = 0; row < rc.dy; row++)
+	{
+		pIn = (const uint16*)((const byte*)pSrc + (ySrc + row) * nSrcPitch) + xSrc;
+		pOut = pDst->dib.pBmp + (rc.y + row) * pDst->dib.nPitch;
+		for(col = 0; col < rc.dx; col++)
+		{
+			if(nRop == AEE_RO_TRANSPARENT && pIn[col] == HOST_KEY_565)
+			{	continue;	}
+			if(pDst->dib.nDepth == 8)
+			{	pOut[rc.x + col] = (uint8)HostDisplay_From565(8, pIn[col]);	}
+			else
+			{	((uint32*)pOut)[rc.x + col] = HostDisplay_From565(32, pIn[col]);	}
+		}
+	}
+
+	pDst->pIShell->stats.dwPixelsDrawn += (uint32)(rc.dx * rc.dy);
+	HostBitmap_Touch(pDst, &rc);
+}
+
+//the same for an image of one byte a pixel, each byte looked up in pPalette, an RGB565 one, on the way
+void HostBitmap_BlitIndexed(IBitmap* pDst, const AEERect* prcClip, int x, int y, const byte* pSrc, int nSrcPitch,
+							int xSrc, int ySrc, int cx, int cy, int nRop, const uint16* pPalette)
+{
+	AEERect rc;
+	byte* pOut;
+	const byte* pIn;
+	uint8 nColors8[256];
+	uint32 dwColors32[256];
+	int i;
+
+	rc.x = (int16)x;
+	rc.y = (int16)y;
+	rc.dx = (int16)cx;
+	rc.dy = (int16)cy;
+	if(cx <= 0 || cy <= 0 || !HostRect_Clip(&rc, prcClip))
+	{	return;		}
+
+	xSrc += rc.x - x;
+	ySrc += rc.y - y;
+	pIn = pSrc + ySrc * nSrcPitch + xSrc;
+	pOut = pDst->dib.pBmp + rc.y * pDst->dib.nPitch + rc.x * (pDst->dib.nDepth / 8);
+	switch(pDst->dib.nDepth)
+	{
+		case 16:
+			if(nRop == AEE_RO_TRANSPARENT)
+			{	HostBlit_ExpandKeyed16(pOut, pDst->dib.nPitch, pIn, nSrcPitch, rc.dx, rc.dy, pPalette, pDst->dib.ncTransparent);	}
+			else
+			{	HostBlit_Expand16(pOut, pDst->dib.nPitch, pIn, nSrcPitch, rc.dx, rc.dy, pPalette);	}
+			break;
+
+		//the palette goes over to the destination's format first, 256 colors instead of every pixel
+		case 8:
+			for(i = 0; i < 256; i++)
+			{	nColors8[i] = (uint8)HostDisplay_From565(8, pPalette[i]);	}
+			if(nRop == AEE_RO_TRANSPARENT)
+			{	HostBlit_ExpandKeyed8(pOut, pDst->dib.nPitch, pIn, nSrcPitch, rc.dx, rc.dy, nColors8, pDst->dib.ncTransparent);	}
+			else
+			{	HostBlit_Expand8(pOut, pDst->dib.nPitch, pIn, nSrcPitch, rc.dx, rc.dy, nColors8);	}
+			break;
+
+		case 32:
+			for(i = 0; i < 256; i++)
+			{	dwColors32[i] = HostDisplay_From565(32, pPalette[i]);	}
+			if(nRop == AEE_RO_TRANSPARENT)
+			{	HostBlit_ExpandKeyed32(pOut, pDst->dib.nPitch, pIn, nSrcPitch, rc.dx, rc.dy, dwColors32, pDst->dib.ncTransparent);	}
+			else
+			{	HostBlit_Expand32(pOut, pDst->dib.nPitch, pIn, nSrcPitch, rc.dx, rc.dy, dwColors32);	}
+			break;
+
+		default:
+			return;
+	}
+
+	pDst->pIShell->stats.dwPixelsDrawn += (uint32)(rc.dx * rc.dy);
+	HostBitmap_Touch(pDst, &rc);
+}
+
+void HostBitmap_Fill(IBitmap* pDst, const AEERect* prcClip, const AEERect* prc, NativeColor nc)
+{
+	const HostBlitKernels* pKernels = HostBlit_Get(pDst->dib.nDepth);
+	AEERect rc = *prc;
+
+	if(pKernels == NULL || !HostRect_Clip(&rc, prcClip))
+	{	return;		}
+
+	pKernels->pfnFill(pDst->dib.pBmp + rc.y * pDst->dib.nPitch + rc.x * (pDst->dib.nDepth / 8),
+					  pDst->dib.nPitch, rc.dx, rc.dy, nc);
+	pDst->pIShell->stats.dwPixelsDrawn += (uint32)(rc.dx * rc.dy);
+	HostBitmap_Touch(pDst, &rc);
+}
+
+static void HostBitmap_Touch(IBitmap* pBmp, const AEERect* prc)
+{
+	int x1;
+	int y1;
+
+	if(!pBmp->bDirty)
+	{
+		pBmp->rcDirty = *prc;
+		pBmp->bDirty = TRUE;
+		return;
+	}
+	x1 = MAX(pBmp->rcDirty.x + pBmp->rcDirty.dx, prc->x + prc->dx);
+	y1 = MAX(pBmp->rcDirty.y + pBmp->rcDirty.dy, prc->y + prc->dy);
+	pBmp->rcDirty.x = MIN(pBmp->rcDirty.x, prc->x);
+	pBmp->rcDirty.y = MIN(pBmp->rcDirty.y, prc->y);
+	pBmp->rcDirty.dx = (int16)(x1 - pBmp->rcDirty.x);
+	pBmp->rcDirty.dy = (int16)(y1 - pBmp->rcDirty.y);
+}
+
+/*===============================================================================
+DISPLAY
+=============================================================================== */
+
+IDisplay* HostDisplay_New(IShell* pIShell, int cx, int cy, int nDepth)
+{
+	IDisplay* pIDisplay = (IDisplay*)MALLOC(sizeof(IDisplay));
+
+	if(pIDisplay == NULL)
+	{	return NULL;	}
+
+	pIDisplay->pIShell = pIShell;
+	pIDisplay->pDevice = HostBitmap_New(pIShell, cx, cy, nDepth);
+	if(pIDisplay->pDevice == NULL)
+	{
+		FREE(pIDisplay);
+		return NULL;
+	}
+	pIDisplay->pDevice->bDevice = TRUE;
+	pIDisplay->pDest = pIDisplay->pDevice;
+	IBITMAP_AddRef(pIDisplay->pDest);
+	pIDisplay->ncBackground = HostDisplay_ToNative(nDepth, MAKE_RGB(0xFF, 0xFF, 0xFF));
+	pIDisplay->ncText = HostDisplay_ToNative(nDepth, MAKE_RGB(0x00, 0x00, 0x00));
+	return pIDisplay;
+}
+
+void HostDisplay_Delete(IDisplay* pIDisplay)
+{
+	IBITMAP_Release(pIDisplay->pDest);
+	IBITMAP_Release(pIDisplay->pDevice);
+	FREE(pIDisplay);
+}
+
+//the clip rect in destination coordinates, the whole destination when none is set
+void HostDisplay_GetClip(IDisplay* pIDisplay, AEERect* prc)
+{
+	AEERect rcAll;
+
+	rcAll.x = 0;
+	rcAll.y = 0;
+	rcAll.dx = (int16)pIDisplay->pDest->dib.cx;
+	rcAll.dy = (int16)pIDisplay->pDest->dib.cy;
+	if(pIDisplay->bClip)
+	{
+		*prc = pIDisplay->rcClip;
+		if(!HostRect_Clip(prc, &rcAll))
+		{	prc->dx = prc->dy = 0;	}
+	}
+	else
+	{
+		*prc = rcAll;
+	}
+}
+
+int HostDisplay_FontHeight(AEEFont nFont)
+{
+	const HostFont* pFont = HostDisplay_Font(nFont);
+
+	return pFont->nAscent + pFont->nDescent;
+}
+
+const byte* Host_GetFramebuffer(IShell* pIShell, int* pcx, int* pcy, int* pnDepth)
+{
+	IBitmap* pDevice = pIShell->pIDisplay->pDevice;
+
+	if(pcx)	{	*pcx = pDevice->dib.cx;	}
+	if(pcy)	{	*pcy = pDevice->dib.cy;	}
+	if(pnDepth)	{	*pnDepth = pDevice->dib.nDepth;	}
+	return pDevice->dib.pBmp;
+}
+
+void IDISPLAY_ClearScreen(IDisplay* po)
+{
+	AEERect rc;
+
+	rc.x = 0;
+	rc.y = 0;
+	rc.dx = (int16)po->pDest->dib.cx;
+	rc.dy = (int16)po->pDest->dib.cy;
+	IDISPLAY_EraseRect(po, &rc);
+	po->pIShell->stats.nClears++;
+}
+
+//pushes the device bitmap's dirty rect to the (imaginary) panel
+void IDISPLAY_Update(IDisplay* po)
+{
+	IBitmap* pDevice = po->pDevice;
+	HostStats* pStats = &po->pIShell->stats;
+
+	pStats->nUpdates++;
+	if(!pDevice->bDirty)
+	{
+		pStats->nEmptyUpdates++;	//nothing drawn since the last one, so nothing keeps the panel busy
+		return;
+	}
+
+	if(po->pIShell->qwStartUs)
+	{
+		pStats->dwFirstPixelUs = (uint32)(Host_NowUs() - po->pIShell->qwStartUs);
+		po->pIShell->qwStartUs = 0;
+	}
+	pStats->dwPixelsPushed += (uint32)(pDevice->rcDirty.dx * pDevice->rcDirty.dy);
+	HostClock_ChargeUpdate(po->pIShell);
+	pDevice->bDirty = FALSE;
+}
+
+void IDISPLAY_UpdateEx(IDisplay* po, boolean bDefer)
+{
+	(void)bDefer;
+	IDISPLAY_Update(po);
+}
+
+void IDISPLAY_FillRect(IDisplay* po, const AEERect* prc, RGBVAL clr)
+{
+	AEERect rcClip;
+
+	HostDisplay_GetClip(po, &rcClip);
+	HostBitmap_Fill(po->pDest, &rcClip, prc, HostDisplay_ToNative(po->pDest->dib.nDepth, clr));
+}
+
+void IDISPLAY_EraseRect(IDisplay* po, const AEERect* prc)
+{
+	AEERect rcClip;
+
+	HostDisplay_GetClip(po, &rcClip);
+	HostBitmap_Fill(po->pDest, &rcClip, prc, po->ncBackground);
+}
+
+void IDISPLAY_SetClipRect(IDisplay* po, const AEERect* prc)
+{
+	po->bClip = (prc != NULL);
+	if(prc)
+	{	po->rcClip = *prc;	}
+}
+
+void IDISPLAY_GetClipRect(IDisplay* po, AEERect* prc)
+{
+	HostDisplay_GetClip(po, prc);
+}
+
+//greeked text: a solid cell per visible character, starting at the top of the line
+int IDISPLAY_DrawText(IDisplay* po, AEEFont nFont, const AECHAR* pcText, int nChars,
+					  int x, int y, const AEERect* prcBackground, uint32 dwFlags)
+{
+	const HostFont* pFont = HostDisplay_Font(nFont);
+	AEERect rcClip;
+	AEERect rcGlyph;
+	int i;
+
+	if(nChars < 0)
+	{	nChars = WSTRLEN(pcText);	}
+
+	HostDisplay_GetClip(po, &rcClip);
+	if(prcBackground && (dwFlags & IDF_RECT_FILL))
+	{	HostBitmap_Fill(po->pDest, &rcClip, prcBackground, po->ncBackground);	}
+
+	rcGlyph.y = (int16)(y + 2);
+	rcGlyph.dx = (int16)(pFont->nAdvance - 1);
+	rcGlyph.dy = (int16)(pFont->nAscent - 2);
+	for(i = 0; i < nChars; i++)
+	{
+		if(pcText[i] > ' ')
+		{
+			rcGlyph.x = (int16)(x + i * pFont->nAdvance);
+			HostBitmap_Fill(po->pDest, &rcClip, &rcGlyph, po->ncText);
+		}
+	}
+	return SUCCESS;
+}
+
+//width of the first nChars characters; *pnFits gets how many fit in nMaxWidth
+int IDISPLAY_MeasureTextEx(IDisplay* po, AEEFont nFont, const AECHAR* pcText, int nChars,
+						   int nMaxWidth, int* pnFits)
+{
+	const HostFont* pFont = HostDisplay_Font(nFont);
+
+	(void)po;
+	if(nChars < 0)
+	{	nChars = WSTRLEN(pcText);	}
+	if(pnFits)
+	{	*pnFits = (nMaxWidth < 0) ? nChars : MIN(nChars, nMaxWidth / pFont->nAdvance);	}
+	return nChars * pFont->nAdvance;
+}
+
+int IDISPLAY_GetFontMetrics(IDisplay* po, AEEFont nFont, int* pnAscent, int* pnDescent)
+{
+	const HostFont* pFont = HostDisplay_Font(nFont);
+
+	(void)po;
+	if(pnAscent)	{	*pnAscent = pFont->nAscent;		}
+	if(pnDescent)	{	*pnDescent = pFont->nDescent;	}
+	return pFont->nAscent + pFont->nDescent;
+}
+
+//pbmSource is an IBitmap, as on BREW 3.x
+void IDISPLAY_BitBlt(IDisplay* po, int xDest, int yDest, int cxDest, int cyDest,
+					 const void* pbmSource, int xSrc, int ySrc, AEERasterOp dwRopCode)
+{
+	const IBitmap* pSrc = (const IBitmap*)pbmSource;
+	AEERect rcClip;
+
+	HostDisplay_GetClip(po, &rcClip);
+	HostBitmap_Blit(po->pDest, &rcClip, xDest, yDest, pSrc->dib.pBmp, pSrc->dib.nPitch,
+					xSrc, ySrc, MIN(cxDest, pSrc->dib.cx - xSrc), MIN(cyDest, pSrc->dib.cy - ySrc), dwRopCode);
+}
+
+int IDISPLAY_GetDeviceBitmap(IDisplay* po, IBitmap** ppIBitmap)
+{
+	IBITMAP_AddRef(po->pDevice);
+	*ppIBitmap = po->pDevice;
+	return SUCCESS;
+}
+
+//NULL goes back to the device bitmap
+int IDISPLAY_SetDestination(IDisplay* po, IBitmap* pDest)
+{
+	if(pDest == NULL)
+	{	pDest = po->pDevice;	}
+
+	IBITMAP_AddRef(pDest);
+	IBITMAP_Release(po->pDest);
+	po->pDest = pDest;
+	return SUCCESS;
+}
+
+int IDISPLAY_GetDestination(IDisplay* po, IBitmap** ppDest)
+{
+	IBITMAP_AddRef(po->pDest);
+	*ppDest = po->pDest;
+	return SUCCESS;
+}
+
+static const HostFont* HostDisplay_Font(AEEFont nFont)
+{
+	int i;
+
+	for(i = 0; i < (int)(sizeof(gFonts)/sizeof(gFonts[0])); i++)
+	{
+		if(gFonts[i].nFont == nFont)
+		{	return &gFonts[i];	}
+	}
+	return &gFonts[0];
+}
+
+//FALSE when nothing of prc is left inside prcClip
+static boolean HostRect_Clip(AEERect* prc, const AEERect* prcClip)
+{
+	int x0 = MAX(prc->x, prcClip->x);
+	int y0 = MAX(prc->y, prcClip->y);
+	int x1 = MIN(prc->x + prc->dx, prcClip->x + prcClip->dx);
+	int y1 = MIN(prc->y + prc->dy, prcClip->y + prcClip->dy);
+
+	if(x1 <= x0 || y1 <= y0)
+	{	return FALSE;	}
+
+	prc->x = (int16)x0;
+	prc->y = (int16)y0;
+	prc->dx = (int16)(x1 - x0);
+	prc->dy = (int16)(y1 - y0);
+	return TRUE;
+}
+
+//RGBVAL is 0xBBGGRR00; 32 bits is 0x00RRGGBB
+static NativeColor HostDisplay_ToNative(int nDepth, RGBVAL clr)
+{
+	uint32 r = (clr >> 8) & 0xFF;
+	uint32 g = (clr >> 16) & 0xFF;
+	uint32 b = (clr >> 24) & 0xFF;
+
+	switch(nDepth)
+	{
+		case 8:		return ((r >> 5) << 5) | ((g >> 5) << 2) | (b >> 6);
+		case 32:	return (r << 16) | (g << 8) | b;
+		default:	return ((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3);
+	}
+}
+
+//an image's pixel in another depth, its channels widened by repeating their top bits
+static NativeColor HostDisplay_From565(int nDepth, uint16 wColor)
+{
+	uint32 r = ((wColor >> 11) << 3) | (wColor >> 13);
+	uint32 g = (((wColor >> 5) & 0x3F) << 2) | ((wColor >> 9) & 0x03);
+	uint32 b = ((wColor & 0x1F) << 3) | ((wColor >> 2) & 0x07);
+
+	return HostDisplay_ToNative(nDepth, MAKE_RGB(r, g, b));
+}
@@ -0,0 +1,219 @@
+/*===========================================================================
+
+FILE: HostFile.c
+
+IFileMgr and IFile on the host, over stdio in the applet's directory
+(Host_SetAppDir), and IMemAStream over a caller's block of memory.
+===========================================================================*/
+#include <stdio.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "HostInternal.h"
+
+static const char* HostFile_Path(IShell* pIShell, const char* pszName, char* pszPath, int nSize);
+
+/*===============================================================================
+IFILEMGR
+=============================================================================== */
+
+IFileMgr* HostFileMgr_New(IShell* pIShell)
+{
+	IFileMgr* pIFileMgr = (IFileMgr*)MALLOC(sizeof(IFileMgr));
+
+	if(pIFileMgr == NULL)
+	{	return NULL;	}
+
+	pIFileMgr->nRefs = 1;
+	pIFileMgr->pIShell = pIShell;
+	return pIFileMgr;
+}
+
+uint32 IFILEMGR_Release(IFileMgr* po)
+{
+	if(--po->nRefs)
+	{	return po->nRefs;	}
+
+	FREE(po);
+	return 0;
+}
+
+IFile* IFILEMGR_OpenFile(IFileMgr* po, const char* pszFile, OpenFileMode mode)
+{
+	char szPath[512];
+	const char* pszMode;
+	IFile* pIFile;
+	FILE* pStream;
+
+	switch(mode)
+	{
+		case _OFM_CREATE:		pszMode = "w+bx";	break;	// fails on a file that is there, as on the handset
+		case _OFM_READWRITE:	pszMode = "r+b";	break;
+		case _OFM_APPEND:		pszMode = "a+b";	break;
+		default:				pszMode = "rb";		break;
+	}
+	pStream = fopen(HostFile_Path(po->pIShell, pszFile, szPath, sizeof(szPath)), pszMode);
+	if(pStream == NULL)
+	{	return NULL;	}
+
+	pIFile = (IFile*)MALLOC(sizeof(IFile));
+	if(pIFile == NULL)
+	{
+		fclose(pStream);
+		return NULL;
+	}
+	pIFile->nRefs = 1;
+	pIFile->pIShell = po->pIShell;
+	pIFile->pStream = pStream;
+	return pIFile;
+}
+
+int IFILEMGR_Remove(IFileMgr* po, const char* pszName)
+{
+	char szPath[512];
+
+	return remove(HostFile_Path(po->pIShell, pszName, szPath, sizeof(szPath))) == 0 ? SUCCESS : EFAILED;
+}
+
+int IFILEMGR_Test(IFileMgr* po, const char* pszName)
+{
+	char szPath[512];
+	struct stat st;
+
+	return stat(HostFile_Path(po->pIShell, pszName, szPath, sizeof(szPath)), &st) == 0 ? SUCCESS : EFAILED;
+}
+
+/*===============================================================================
+IFILE
+=============================================================================== */
+
+uint32 IFILE_Release(IFile* po)
+{
+	if(--po->nRefs)
+	{	return po->nRefs;	}
+
+	if(po->pMap)
+	{	munmap(po->pMap, po->dwMapSize);	}
+	fclose((FILE*)po->pStream);
+	FREE(po);
+	return 0;
+}
+
+int32 IFILE_Read(IFile* po, void* pDest, uint32 nWant)
+{
+	return (int32)fread(pDest, 1, nWant, (FILE*)po->pStream);
+}
+
+uint32 IFILE_Write(IFile* po, const void* pBuffer, uint32 dwCount)
+{
+	return (uint32)fwrite(pBuffer, 1, dwCount, (FILE*)po->pStream);
+}
+
+int IFILE_Seek(IFile* po, FileSeekType seek, int32 position)
+{
+	int nWhence = (seek == _SEEK_END) ? SEEK_END : (seek == _SEEK_CURRENT) ? SEEK_CUR : SEEK_SET;
+
+	return fseek((FILE*)po->pStream, position, nWhence) == 0 ? SUCCESS : EFAILED;
+}
+
+int IFILE_Truncate(IFile* po, uint32 truncate_pos)
+{
+	(void)po;
+	(void)truncate_pos;
+	return EUNSUPPORTED;
+}
+
+int IFILE_GetInfo(IFile* po, FileInfo* pInfo)
+{
+	FILE* pStream = (FILE*)po->pStream;
+	long nPos = ftell(pStream);
+
+	MEMSET(pInfo, 0, sizeof(FileInfo));
+	fseek(pStream, 0, SEEK_END);
+	pInfo->dwSize = (uint32)ftell(pStream);
+	fseek(pStream, nPos, SEEK_SET);
+	return SUCCESS;
+}
+
+//read-only views only, and one per file; dwSize 0 maps from dwOffset to the end
+void* IFILE_Map(IFile* po, void* pStart, uint32 dwSize, int protections, int flags, uint32 dwOffset)
+{
+	FILE* pStream = (FILE*)po->pStream;
+	struct stat st;
+	void* pMap;
+
+	(void)pStart;
+	(void)flags;
+	if(po->pMap || protections != AEE_FMAP_PROT_READ || fstat(fileno(pStream), &st) != 0
+		|| dwOffset >= (uint32)st.st_size || (dwOffset & 4095))
+	{	return NULL;	}
+
+	if(dwSize == 0 || dwSize > (uint32)st.st_size - dwOffset)
+	{	dwSize = (uint32)st.st_size - dwOffset;	}
+
+	pMap = mmap(NULL, dwSize, PROT_READ, MAP_SHARED, fileno(pStream), (off_t)dwOffset);
+	if(pMap == MAP_FAILED)
+	{	return NULL;	}
+
+	po->pMap = pMap;
+	po->dwMapSize = dwSize;
+	return pMap;
+}
+
+/*===============================================================================
+IMEMASTREAM
+=============================================================================== */
+
+IMemAStream* HostMemAStream_New(IShell* pIShell)
+{
+	IMemAStream* pStream = (IMemAStream*)MALLOC(sizeof(IMemAStream));
+
+	if(pStream == NULL)
+	{	return NULL;	}
+
+	pStream->nRefs = 1;
+	pStream->pIShell = pIShell;
+	return pStream;
+}
+
+uint32 IMEMASTREAM_AddRef(IMemAStream* po)
+{
+	return ++po->nRefs;
+}
+
+uint32 IMEMASTREAM_Release(IMemAStream* po)
+{
+	if(--po->nRefs)
+	{	return po->nRefs;	}
+
+	IMEMASTREAM_SetEx(po, NULL, 0, 0, NULL, NULL);
+	FREE(po);
+	return 0;
+}
+
+//the stream owns pBuff and FREEs it when done
+void IMEMASTREAM_Set(IMemAStream* po, byte* pBuff, uint32 dwSize, uint32 dwOffset, boolean bSysMem)
+{
+	(void)bSysMem;
+	IMEMASTREAM_SetEx(po, pBuff, dwSize, dwOffset, FREE, pBuff);
+}
+
+void IMEMASTREAM_SetEx(IMemAStream* po, byte* pBuff, uint32 dwSize, uint32 dwOffset,
+					   PFNNOTIFY pfnFree, void* pUser)
+{
+	if(po->pfnFree)
+	{	po->pfnFree(po->pUser);	}
+
+	po->pBuff = pBuff;
+	po->dwSize = dwSize;
+	po->dwOffset = dwOffset;
+	po->pfnFree = pfnFree;
+	po->pUser = pUser;
+}
+
+//pszName under the applet's directory
+static const char* HostFile_Path(IShell* pIShell, const char* pszName, char* pszPath, int nSize)
+{
+	snprintf(pszPath, (size_t)nSize, "%s/%s", pIShell->szAppDir, pszName);
+	return pszPath;
+}
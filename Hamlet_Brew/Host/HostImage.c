@@ -0,0 +1,855 @@
+/*===========================================================================
+
+FILE: HostImage.c
+
+IImage on the host: PNGs, from a resource or a memory stream, decoded
+with libpng into RGB565. Pixels under half alpha become HOST_KEY_565,
+so AEE_RO_TRANSPARENT behaves like the handset's color-keyed BMPs.
+
+Palette-indexed PNGs stay indexed: one byte a pixel, looked up in the
+palette by the blitter as the image is drawn. Images whose palettes are
+the same share one HostPalette on each host.
+
+Decoded pixels can be shared between hosts. While Host_SharePNGs(TRUE)
+is on, every decode is also kept in one process-wide table keyed by a
+hash of the PNG bytes. After Host_SharePNGs(FALSE) the table is frozen,
+and a host on any thread that decodes the same bytes again gets the
+table's pixels, read-only, instead. Recording is not thread safe: it is
+done before the threads that use the table start.
+
+An image with an IIMAGE_Notify callback decodes its stream in the
+background instead, the way a handset's decoder does: every host timer
+step gives libpng's progressive reader HOST_DECODE_CHUNK more bytes of
+it, and the callback comes after the last. The steps are 0 ms timers,
+so they run between the applet's own dispatches and take no virtual
+time. Those decodes never use the shared table, which needs every byte
+up front to hash.
+===========================================================================*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <png.h>
+
+#include "HostInternal.h"
+
+#define HOST_DECODE_CHUNK	4096	// stream bytes a background decode takes per step
+
+typedef struct _HostPNGSource {
+	const byte*	pData;
+	uint32		dwSize;
+	uint32		dwPos;
+} HostPNGSource;
+
+typedef struct _HostSharedPNG {
+	uint32		dwHash;			// FNV-1a of the PNG bytes
+	uint32		dwSize;
+	uint16		cx;
+	uint16		cy;
+	uint16*		pPixels;		// malloc'd, kept for the life of the process
+	byte*		pIndices;		// the same for an indexed PNG, with its palette here
+	HostPalette	palette;
+} HostSharedPNG;
+
+//a progressive decode, for as long as the image is waiting for bytes
+typedef struct _HostPNGStream {
+	png_structp		png;
+	png_infop		info;
+	IMemAStream*	pStream;		// AddRef'd
+	uint32			dwFed;			// offset into the stream of the first byte libpng has not had
+	png_bytep		pRGBA;			// the image as libpng fills it in, 8 bits a channel
+	uint16*			pPixels;
+	byte*			pIndices;		// an indexed PNG goes straight in here instead
+	HostPalette*	pPalette;
+	uint16			cx;
+	uint16			cy;
+	boolean			bInterlaced;	// rows are only final after the last pass
+	boolean			bDone;
+	uint32			dwUs;			// decode time so far, over every feed
+} HostPNGStream;
+
+static HostSharedPNG	gShared[HOST_MAX_SHARED_PNGS];
+static int				gnShared;
+static boolean			gbRecording;
+
+static boolean	HostImage_Decode(IImage* pImage, const byte* pData, uint32 dwSize);
+static boolean	HostImage_FindShared(IImage* pImage, uint32 dwHash, uint32 dwSize);
+static void		HostImage_Record(const IImage* pImage, uint32 dwHash, uint32 dwSize);
+static void		HostImage_SetPixels(IImage* pImage, uint16* pPixels, byte* pIndices, HostPalette* pPalette, boolean bShared);
+static void		HostImage_FreePixels(IImage* pImage);
+static HostPalette*	HostImage_ReadPalette(IShell* pIShell, png_structp png, png_infop info);
+static void		HostPalette_Release(IShell* pIShell, HostPalette* pPalette);
+static void		HostImage_Read(png_structp png, png_bytep pOut, png_size_t nWant);
+static void		HostImage_Convert(IImage* pImage, png_bytep* ppRows);
+static void		HostImage_ConvertRow(uint16* pOut, png_const_bytep pIn, int cx);
+static boolean	HostImage_StartStream(IImage* pImage, IMemAStream* pMem);
+static void		HostImage_DecodeStep(IImage* pImage);
+static void		HostImage_EndStream(IImage* pImage, int nErr);
+static void		HostImage_StreamInfo(png_structp png, png_infop info);
+static void		HostImage_StreamRow(png_structp png, png_bytep pRow, png_uint_32 nRow, int nPass);
+static void		HostImage_StreamEnd(png_structp png, png_infop info);
+static void		HostImage_DrawScaled(IImage* pImage, int nFrame, int x, int y);
+static void		HostImage_DrawScaledIndexed(IImage* pImage, int nFrame, int x, int y);
+static boolean	HostImage_IsDead(IImage* pImage);
+
+//an image with nothing in it yet, what ISHELL_CreateInstance(AEECLSID_PNG) hands out
+IImage* HostImage_New(IShell* pIShell)
+{
+	IImage* pImage = (IImage*)MALLOC(sizeof(IImage));
+
+	if(pImage == NULL)
+	{	return NULL;	}
+
+	pImage->nRefs = 1;
+	pImage->pIShell = pIShell;
+	pImage->nRop = AEE_RO_COPY;
+	pImage->nFrames = 1;
+	pIShell->stats.nLiveImages++;
+	return pImage;
+}
+
+//reads the whole file and decodes it, the way ISHELL_LoadResImage does every time
+IImage* HostImage_LoadPNG(IShell* pIShell, const char* pszPath)
+{
+	IImage* pImage = NULL;
+	byte* pData = NULL;
+	FILE* pFile;
+	long nLen;
+
+	pFile = fopen(pszPath, "rb");
+	if(pFile == NULL)
+	{	return NULL;	}
+
+	fseek(pFile, 0, SEEK_END);
+	nLen = ftell(pFile);
+	fseek(pFile, 0, SEEK_SET);
+	if(nLen > 0)
+	{	pData = (byte*)MALLOC((uint32)nLen);	}
+	if(pData && fread(pData, 1, (size_t)nLen, pFile) == (size_t)nLen)
+	{
+		pImage = HostImage_New(pIShell);
+		if(pImage && !HostImage_Decode(pImage, pData, (uint32)nLen))
+		{
+			IIMAGE_Release(pImage);
+			pImage = NULL;
+		}
+	}
+	if(pData)
+	{	FREE(pData);	}
+	fclose(pFile);
+	return pImage;
+}
+
+//PNG bytes to RGB565 pixels, or to indices for an indexed PNG; FALSE leaves the image empty
+static boolean HostImage_Decode(IImage* pImage, const byte* pData, uint32 dwSize)
+{
+	uint64_t qwStart = Host_NowUs();
+	HostPNGSource src;
+	png_structp png = NULL;
+	png_infop info = NULL;
+	png_bytep* volatile ppRows = NULL;
+	png_bytep volatile pRGBA = NULL;
+	uint16* volatile pPixels = NULL;
+	byte* volatile pIndices = NULL;
+	HostPalette* volatile pPalette = NULL;
+	boolean bIndexed;
+	uint32 dwHash = 2166136261u;
+	uint32 cx;
+	uint32 cy;
+	uint32 row;
+	uint32 i;
+
+	if(gnShared > 0 || gbRecording)
+	{
+		for(i = 0; i < dwSize; i++)
+		{	dwHash = (dwHash ^ pData[i]) * 16777619u;	}
+		if(HostImage_FindShared(pImage, dwHash, dwSize))
+		{	return TRUE;	}
+	}
+
+	src.pData = pData;
+	src.dwSize = dwSize;
+	src.dwPos = 0;
+
+	png = png_create_read_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
+	if(png)
+	{	info = png_create_info_struct(png);	}
+	if(info == NULL || setjmp(png_jmpbuf(png)))
+	{
+		FREE(pPixels);
+		FREE(pIndices);
+		if(pPalette)
+		{	HostPalette_Release(pImage->pIShell, pPalette);	}
+		pPixels = NULL;
+		pIndices = NULL;
+		goto done;
+	}
+
+	png_set_read_fn(png, &src, HostImage_Read);
+	png_read_info(png, info);
+
+	//an indexed file is read as one byte an index, whatever else it holds as 8-bit RGBA
+	bIndexed = (png_get_color_type(png, info) == PNG_COLOR_TYPE_PALETTE);
+	if(bIndexed)
+	{	png_set_packing(png);	}
+	else
+	{
+		png_set_expand(png);
+		png_set_strip_16(png);
+		png_set_gray_to_rgb(png);
+		png_set_add_alpha(png, 0xFF, PNG_FILLER_AFTER);
+	}
+	png_read_update_info(png, info);
+
+	cx = png_get_image_width(png, info);
+	cy = png_get_image_height(png, info);
+	if(cx == 0 || cy == 0 || cx > 0xFFFF || cy > 0xFFFF)
+	{	goto done;	}
+
+	ppRows = (png_bytep*)MALLOC(cy * sizeof(png_bytep));
+	if(bIndexed)
+	{
+		pPalette = HostImage_ReadPalette(pImage->pIShell, png, info);
+		pIndices = (byte*)MALLOC(cx * cy);
+	}
+	else
+	{
+		pRGBA = (png_bytep)MALLOC(cx * cy * 4);
+		pPixels = (uint16*)MALLOC(cx * cy * 2);
+	}
+	if(ppRows == NULL || (bIndexed ? (pPalette == NULL || pIndices == NULL) : (pRGBA == NULL || pPixels == NULL)))
+	{	png_error(png, "out of memory");	}
+
+	for(row = 0; row < cy; row++)
+	{	ppRows[row] = bIndexed ? pIndices + row * cx : pRGBA + row * cx * 4;	}
+	png_read_image(png, ppRows);
+
+	HostImage_SetPixels(pImage, pPixels, pIndices, pPalette, FALSE);
+	pImage->cx = (uint16)cx;
+	pImage->cy = (uint16)cy;
+	pImage->nFrames = 1;
+	pImage->cxFrame = (int)cx;
+	if(!bIndexed)
+	{	HostImage_Convert(pImage, ppRows);	}
+
+	pImage->pIShell->stats.nImageDecodes++;
+	pImage->pIShell->stats.dwDecodeUs += (uint32)(Host_NowUs() - qwStart);
+	if(gbRecording)
+	{	HostImage_Record(pImage, dwHash, dwSize);	}
+
+done:
+	if(ppRows)	{	FREE(ppRows);	}
+	if(pRGBA)	{	FREE(pRGBA);	}
+	png_destroy_read_struct(&png, info ? &info : NULL, NULL);
+	return pPixels != NULL || pIndices != NULL;
+}
+
+//the table's pixels for these bytes, when they have been decoded before
+static boolean HostImage_FindShared(IImage* pImage, uint32 dwHash, uint32 dwSize)
+{
+	const HostSharedPNG* pShared;
+	int i;
+
+	for(i = 0; i < gnShared; i++)
+	{
+		pShared = &gShared[i];
+		if(pShared->dwHash == dwHash && pShared->dwSize == dwSize)
+		{
+			HostImage_SetPixels(pImage, pShared->pPixels, pShared->pIndices, pShared->pIndices ? (HostPalette*)&pShared->palette : NULL, TRUE);
+			pImage->cx = pShared->cx;
+			pImage->cy = pShared->cy;
+			pImage->nFrames = 1;
+			pImage->cxFrame = pShared->cx;
+			pImage->pIShell->stats.nSharedDecodes++;
+			return TRUE;
+		}
+	}
+	return FALSE;
+}
+
+//a copy outside every host's heap, so no host sees it as its own or as a leak
+static void HostImage_Record(const IImage* pImage, uint32 dwHash, uint32 dwSize)
+{
+	HostSharedPNG* pShared;
+	uint32 dwBytes = (uint32)pImage->cx * pImage->cy * (pImage->pIndices ? 1 : 2);
+	int i;
+
+	for(i = 0; i < gnShared; i++)
+	{
+		if(gShared[i].dwHash == dwHash && gShared[i].dwSize == dwSize)
+		{	return;		}
+	}
+	if(gnShared == HOST_MAX_SHARED_PNGS)
+	{	return;		}
+
+	pShared = &gShared[gnShared];
+	if(pImage->pIndices)
+	{
+		pShared->pIndices = (byte*)malloc(dwBytes);
+		if(pShared->pIndices == NULL)
+		{	return;		}
+		memcpy(pShared->pIndices, pImage->pIndices, dwBytes);
+		pShared->palette = *pImage->pPalette;
+		pShared->palette.pNext = NULL;
+	}
+	else
+	{
+		pShared->pPixels = (uint16*)malloc(dwBytes);
+		if(pShared->pPixels == NULL)
+		{	return;		}
+		memcpy(pShared->pPixels, pImage->pPixels, dwBytes);
+	}
+	pShared->dwHash = dwHash;
+	pShared->dwSize = dwSize;
+	pShared->cx = pImage->cx;
+	pShared->cy = pImage->cy;
+	gnShared++;
+}
+
+static void HostImage_SetPixels(IImage* pImage, uint16* pPixels, byte* pIndices, HostPalette* pPalette, boolean bShared)
+{
+	HostImage_FreePixels(pImage);
+	pImage->pPixels = pPixels;
+	pImage->pIndices = pIndices;
+	pImage->pPalette = pPalette;
+	pImage->bSharedPixels = bShared;
+}
+
+static void HostImage_FreePixels(IImage* pImage)
+{
+	if(!pImage->bSharedPixels)
+	{
+		FREE(pImage->pPixels);
+		FREE(pImage->pIndices);
+		if(pImage->pPalette)
+		{	HostPalette_Release(pImage->pIShell, pImage->pPalette);	}
+	}
+	pImage->pPixels = NULL;
+	pImage->pIndices = NULL;
+	pImage->pPalette = NULL;
+}
+
+//PLTE and tRNS in RGB565; a host's images with the same colors get the same palette, NULL without memory for it
+static HostPalette* HostImage_ReadPalette(IShell* pIShell, png_structp png, png_infop info)
+{
+	HostPalette* pPalette;
+	png_colorp pColors = NULL;
+	png_bytep pAlpha = NULL;
+	int nColors = 0;
+	int nAlpha = 0;
+	uint16 wColors[256];
+	int i;
+
+	png_get_PLTE(png, info, &pColors, &nColors);
+	png_get_tRNS(png, info, &pAlpha, &nAlpha, NULL);
+	nColors = MIN(nColors, 256);
+	for(i = 0; i < 256; i++)
+	{
+		if(i >= nColors || (i < nAlpha && pAlpha[i] < 0x80))
+		{	wColors[i] = HOST_KEY_565;	}
+		else
+		{	wColors[i] = (uint16)(((pColors[i].red >> 3) << 11) | ((pColors[i].green >> 2) << 5) | (pColors[i].blue >> 3));	}
+	}
+
+	for(pPalette = pIShell->pPalettes; pPalette; pPalette = pPalette->pNext)
+	{
+		if(pPalette->nColors == nColors && memcmp(pPalette->wColors, wColors, sizeof(wColors)) == 0)
+		{
+			pPalette->nRefs++;
+			return pPalette;
+		}
+	}
+
+	pPalette = (HostPalette*)MALLOC(sizeof(HostPalette));
+	if(pPalette == NULL)
+	{	return NULL;	}
+	pPalette->nRefs = 1;
+	pPalette->nColors = (uint16)nColors;
+	memcpy(pPalette->wColors, wColors, sizeof(wColors));
+	pPalette->pNext = pIShell->pPalettes;
+	pIShell->pPalettes = pPalette;
+	return pPalette;
+}
+
+static void HostPalette_Release(IShell* pIShell, HostPalette* pPalette)
+{
+	HostPalette** ppLink;
+
+	if(--pPalette->nRefs)
+	{	return;		}
+
+	for(ppLink = &pIShell->pPalettes; *ppLink; ppLink = &(*ppLink)->pNext)
+	{
+		if(*ppLink == pPalette)
+		{
+			*ppLink = pPalette->pNext;
+			break;
+		}
+	}
+	FREE(pPalette);
+}
+
+void Host_SharePNGs(boolean bRecord)
+{
+	gbRecording = bRecord;
+}
+
+static void HostImage_Read(png_structp png, png_bytep pOut, png_size_t nWant)
+{
+	HostPNGSource* pSrc = (HostPNGSource*)png_get_io_ptr(png);
+
+	if(nWant > pSrc->dwSize - pSrc->dwPos)
+	{	png_error(png, "truncated PNG");	}
+
+	memcpy(pOut, pSrc->pData + pSrc->dwPos, nWant);
+	pSrc->dwPos += (uint32)nWant;
+}
+
+static void HostImage_Convert(IImage* pImage, png_bytep* ppRows)
+{
+	int y;
+
+	for(y = 0; y < pImage->cy; y++)
+	{	HostImage_ConvertRow(pImage->pPixels + y * pImage->cx, ppRows[y], pImage->cx);	}
+}
+
+static void HostImage_ConvertRow(uint16* pOut, png_const_bytep pIn, int cx)
+{
+	int x;
+
+	for(x = 0; x < cx; x++, pIn += 4)
+	{
+		if(pIn[3] < 0x80)
+		{	*pOut++ = HOST_KEY_565;	}
+		else
+		{	*pOut++ = (uint16)(((pIn[0] >> 3) << 11) | ((pIn[1] >> 2) << 5) | (pIn[2] >> 3));	}
+	}
+}
+
+//sets up libpng's progressive reader on the stream; the bytes come in through HostImage_DecodeStep
+static boolean HostImage_StartStream(IImage* pImage, IMemAStream* pMem)
+{
+	HostPNGStream* pPending = (HostPNGStream*)MALLOC(sizeof(HostPNGStream));
+
+	if(pPending == NULL)
+	{	return FALSE;	}
+
+	pPending->png = png_create_read_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
+	if(pPending->png)
+	{	pPending->info = png_create_info_struct(pPending->png);	}
+	if(pPending->info == NULL)
+	{
+		png_destroy_read_struct(&pPending->png, NULL, NULL);
+		FREE(pPending);
+		return FALSE;
+	}
+	png_set_progressive_read_fn(pPending->png, pImage, HostImage_StreamInfo, HostImage_StreamRow, HostImage_StreamEnd);
+
+	IMEMASTREAM_AddRef(pMem);
+	pPending->pStream = pMem;
+	pPending->dwFed = pMem->dwOffset;
+	pImage->pPending = pPending;
+	return TRUE;
+}
+
+//hands libpng the next chunk of the stream; the image may be done, or dropped, after this
+static void HostImage_DecodeStep(IImage* pImage)
+{
+	HostPNGStream* pPending = pImage->pPending;
+	IMemAStream* pMem = pPending->pStream;
+	uint64_t qwStart = Host_NowUs();
+	uint32 dwEnd = MIN(pMem->dwSize, pPending->dwFed + HOST_DECODE_CHUNK);
+
+	if(setjmp(png_jmpbuf(pPending->png)))
+	{
+		HostImage_EndStream(pImage, EFAILED);
+		return;
+	}
+	if(dwEnd > pPending->dwFed)
+	{
+		png_process_data(pPending->png, pPending->info, pMem->pBuff + pPending->dwFed, dwEnd - pPending->dwFed);
+		pPending->dwFed = dwEnd;
+	}
+	pPending->dwUs += (uint32)(Host_NowUs() - qwStart);
+
+	if(pPending->bDone)
+	{	HostImage_EndStream(pImage, SUCCESS);	}
+	else if(pPending->dwFed >= pMem->dwSize)
+	{	HostImage_EndStream(pImage, EFAILED);	}	//the stream ended before the image did
+	else
+	{	ISHELL_SetTimer(pImage->pIShell, 0, (PFNNOTIFY)HostImage_DecodeStep, pImage);	}
+}
+
+//lets go of the decoder and the stream, then tells the owner; nErr SUCCESS gives the image its pixels
+static void HostImage_EndStream(IImage* pImage, int nErr)
+{
+	HostPNGStream* pPending = pImage->pPending;
+	AEEImageInfo info;
+	int y;
+
+	if(nErr == SUCCESS)
+	{
+		if(pPending->bInterlaced)
+		{
+			for(y = 0; y < pPending->cy; y++)
+			{	HostImage_ConvertRow(pPending->pPixels + y * pPending->cx, pPending->pRGBA + y * pPending->cx * 4, pPending->cx);	}
+		}
+		HostImage_SetPixels(pImage, pPending->pPixels, pPending->pIndices, pPending->pPalette, FALSE);
+		pImage->cx = pPending->cx;
+		pImage->cy = pPending->cy;
+		pImage->nFrames = 1;
+		pImage->cxFrame = pPending->cx;
+		pImage->pIShell->stats.nImageDecodes++;
+		pImage->pIShell->stats.dwDecodeUs += pPending->dwUs;
+	}
+	else
+	{
+		FREE(pPending->pPixels);
+		FREE(pPending->pIndices);
+		if(pPending->pPalette)
+		{	HostPalette_Release(pImage->pIShell, pPending->pPalette);	}
+	}
+
+	png_destroy_read_struct(&pPending->png, &pPending->info, NULL);
+	FREE(pPending->pRGBA);
+	IMEMASTREAM_Release(pPending->pStream);
+	FREE(pPending);
+	pImage->pPending = NULL;
+
+	if(pImage->pfnNotify)
+	{
+		IIMAGE_GetInfo(pImage, &info);
+		pImage->pfnNotify(pImage->pNotifyUser, pImage, &info, nErr);
+	}
+}
+
+//the header is in: same transforms as HostImage_Decode, and room for the pixels
+static void HostImage_StreamInfo(png_structp png, png_infop info)
+{
+	IImage* pImage = (IImage*)png_get_progressive_ptr(png);
+	HostPNGStream* pPending = pImage->pPending;
+	boolean bIndexed = (png_get_color_type(png, info) == PNG_COLOR_TYPE_PALETTE);
+	uint32 cx;
+	uint32 cy;
+
+	if(bIndexed)
+	{	png_set_packing(png);	}
+	else
+	{
+		png_set_expand(png);
+		png_set_strip_16(png);
+		png_set_gray_to_rgb(png);
+		png_set_add_alpha(png, 0xFF, PNG_FILLER_AFTER);
+	}
+	pPending->bInterlaced = (png_set_interlace_handling(png) > 1);
+	png_read_update_info(png, info);
+
+	cx = png_get_image_width(png, info);
+	cy = png_get_image_height(png, info);
+	if(cx == 0 || cy == 0 || cx > 0xFFFF || cy > 0xFFFF)
+	{	png_error(png, "bad PNG size");	}
+
+	pPending->cx = (uint16)cx;
+	pPending->cy = (uint16)cy;
+	if(bIndexed)
+	{
+		pPending->pPalette = HostImage_ReadPalette(pImage->pIShell, png, info);
+		pPending->pIndices = (byte*)MALLOC(cx * cy);
+		if(pPending->pPalette == NULL || pPending->pIndices == NULL)
+		{	png_error(png, "out of memory");	}
+		return;
+	}
+
+	pPending->pRGBA = (png_bytep)MALLOC(cx * cy * 4);
+	pPending->pPixels = (uint16*)MALLOC(cx * cy * 2);
+	if(pPending->pRGBA == NULL || pPending->pPixels == NULL)
+	{	png_error(png, "out of memory");	}
+}
+
+//a row, or an interlace pass over one; rows of a plain PNG are final the first time
+static void HostImage_StreamRow(png_structp png, png_bytep pRow, png_uint_32 nRow, int nPass)
+{
+	IImage* pImage = (IImage*)png_get_progressive_ptr(png);
+	HostPNGStream* pPending = pImage->pPending;
+	png_bytep pRGBA;
+
+	(void)nPass;
+	if(pRow == NULL || nRow >= pPending->cy)
+	{	return;		}
+
+	//indices need no converting, interlaced or not
+	if(pPending->pIndices)
+	{
+		png_progressive_combine_row(png, pPending->pIndices + nRow * pPending->cx, pRow);
+		return;
+	}
+
+	pRGBA = pPending->pRGBA + nRow * pPending->cx * 4;
+	png_progressive_combine_row(png, pRGBA, pRow);
+	if(!pPending->bInterlaced)
+	{	HostImage_ConvertRow(pPending->pPixels + nRow * pPending->cx, pRGBA, pPending->cx);	}
+}
+
+static void HostImage_StreamEnd(png_structp png, png_infop info)
+{
+	IImage* pImage = (IImage*)png_get_progressive_ptr(png);
+
+	(void)info;
+	pImage->pPending->bDone = TRUE;
+}
+
+/*===============================================================================
+IIMAGE
+=============================================================================== */
+
+//the husks of Host_KeepDeadImages, let go once the applet that held them is gone
+void HostImage_FreeDead(IShell* pIShell)
+{
+	IImage* pNext;
+
+	while(pIShell->pDeadImages)
+	{
+		pNext = pIShell->pDeadImages->pNextDead;
+		HostStdLib_FreeDisowned(pIShell->pDeadImages);
+		pIShell->pDeadImages = pNext;
+	}
+}
+
+//a call through a pointer the applet already released; a device would read freed memory here
+static boolean HostImage_IsDead(IImage* pImage)
+{
+	if(!pImage->bDead)
+	{	return FALSE;	}
+
+	pImage->pIShell->stats.nDeadImageCalls++;
+	return TRUE;
+}
+
+uint32 IIMAGE_AddRef(IImage* po)
+{
+	if(HostImage_IsDead(po))
+	{	return 0;	}
+
+	return ++po->nRefs;
+}
+
+uint32 IIMAGE_Release(IImage* po)
+{
+	if(HostImage_IsDead(po))
+	{	return 0;	}
+	if(--po->nRefs)
+	{	return po->nRefs;	}
+
+	po->pIShell->stats.nLiveImages--;
+	if(po->pPending)
+	{
+		ISHELL_CancelTimer(po->pIShell, (PFNNOTIFY)HostImage_DecodeStep, po);
+		po->pfnNotify = NULL;	//dropped half way, nobody is waiting for it any more
+		HostImage_EndStream(po, EFAILED);
+	}
+	HostImage_FreePixels(po);
+	if(po->pIShell->bKeepDeadImages)
+	{
+		po->bDead = TRUE;
+		HostStdLib_Disown(po);
+		po->pNextDead = po->pIShell->pDeadImages;
+		po->pIShell->pDeadImages = po;
+		return 0;
+	}
+	FREE(po);
+	return 0;
+}
+
+void IIMAGE_GetInfo(IImage* po, AEEImageInfo* pi)
+{
+	if(HostImage_IsDead(po))
+	{
+		MEMSET(pi, 0, sizeof(AEEImageInfo));
+		return;
+	}
+
+	pi->cx = po->cx;
+	pi->cy = po->cy;
+	pi->nColors = po->pPalette ? po->pPalette->nColors : 0xFFFF;
+	pi->bAnimated = (po->nFrames > 1);
+	pi->cxFrame = (uint16)po->cxFrame;
+}
+
+void IIMAGE_SetParm(IImage* po, int nParm, int n1, int n2)
+{
+	if(HostImage_IsDead(po))
+	{	return;		}
+
+	switch(nParm)
+	{
+		case IPARM_ROP:
+			po->nRop = n1;
+			break;
+		case IPARM_NFRAMES:
+			if(n1 > 0)
+			{
+				po->nFrames = n1;
+				po->cxFrame = po->cx / n1;
+			}
+			break;
+		case IPARM_CXFRAME:
+			if(n1 > 0)
+			{
+				po->cxFrame = n1;
+				po->nFrames = MAX(1, po->cx / n1);
+			}
+			break;
+		case IPARM_OFFSET:
+			po->xOffset = n1;
+			po->yOffset = n2;
+			break;
+		case IPARM_SIZE:
+			po->cxDraw = n1;
+			po->cyDraw = n2;
+			break;
+		case IPARM_SCALE:
+			po->cxScale = n1;
+			po->cyScale = n2;
+			break;
+		default:
+			break;
+	}
+}
+
+//only memory streams exist on the host; the bytes are decoded here and then let go, unless someone waits on IIMAGE_Notify,
+//then they are decoded in the background from the next step on
+void IIMAGE_SetStream(IImage* po, IAStream* pStream)
+{
+	IMemAStream* pMem = (IMemAStream*)pStream;
+
+	if(HostImage_IsDead(po))
+	{	return;		}
+	if(pMem && po->pfnNotify && po->pPending == NULL)
+	{
+		if(HostImage_StartStream(po, pMem))
+		{	ISHELL_SetTimer(po->pIShell, 0, (PFNNOTIFY)HostImage_DecodeStep, po);	}
+		else
+		{	po->pfnNotify(po->pNotifyUser, po, NULL, ENOMEMORY);	}
+		return;
+	}
+
+	if(pMem && pMem->dwOffset < pMem->dwSize)
+	{	HostImage_Decode(po, pMem->pBuff + pMem->dwOffset, pMem->dwSize - pMem->dwOffset);	}
+}
+
+void IIMAGE_Notify(IImage* po, PFNIMAGEINFO pfn, void* pUser)
+{
+	if(HostImage_IsDead(po))
+	{	return;		}
+
+	po->pfnNotify = pfn;
+	po->pNotifyUser = pUser;
+}
+
+void IIMAGE_Draw(IImage* po, int x, int y)
+{
+	IIMAGE_DrawFrame(po, 0, x, y);
+}
+
+//draws frame nFrame, shifted by the offset and cut to the draw size
+void IIMAGE_DrawFrame(IImage* po, int nFrame, int x, int y)
+{
+	IDisplay* pIDisplay = po->pIShell->pIDisplay;
+	AEERect rcClip;
+	int xSrc;
+	int cx;
+	int cy;
+
+	if(HostImage_IsDead(po))
+	{	return;		}
+	if(nFrame < 0 || nFrame >= po->nFrames)
+	{	return;		}
+	if(po->cxScale > 0 && po->cyScale > 0 && (po->cxScale != po->cxFrame || po->cyScale != po->cy))
+	{
+		HostImage_DrawScaled(po, nFrame, x, y);
+		return;
+	}
+
+	xSrc = nFrame * po->cxFrame + po->xOffset;
+	cx = po->cxDraw > 0 ? po->cxDraw : po->cxFrame - po->xOffset;
+	cy = po->cyDraw > 0 ? po->cyDraw : po->cy - po->yOffset;
+	cx = MIN(cx, (nFrame + 1) * po->cxFrame - xSrc);
+	cy = MIN(cy, po->cy - po->yOffset);
+
+	HostDisplay_GetClip(pIDisplay, &rcClip);
+	if(po->pIndices)
+	{
+		HostBitmap_BlitIndexed(pIDisplay->pDest, &rcClip, x, y, po->pIndices, po->cx,
+							   xSrc, po->yOffset, cx, cy, po->nRop, po->pPalette->wColors);
+	}
+	else if(po->pPixels)
+	{
+		HostBitmap_Blit565(pIDisplay->pDest, &rcClip, x, y, po->pPixels, po->cx * 2,
+						   xSrc, po->yOffset, cx, cy, po->nRop);
+	}
+}
+
+//nearest-neighbour resize of the whole frame into a scratch buffer on every draw, as slow as a handset doing it
+static void HostImage_DrawScaled(IImage* pImage, int nFrame, int x, int y)
+{
+	IDisplay* pIDisplay = pImage->pIShell->pIDisplay;
+	AEERect rcClip;
+	const uint16* pIn;
+	uint16* pPixels;
+	uint16* pOut;
+	int cx = pImage->cxScale;
+	int cy = pImage->cyScale;
+	int row;
+	int col;
+
+	if(pImage->pIndices)
+	{
+		HostImage_DrawScaledIndexed(pImage, nFrame, x, y);
+		return;
+	}
+
+	pPixels = (uint16*)MALLOC((uint32)(cx * cy) * sizeof(uint16));
+	if(pPixels == NULL)
+	{	return;		}
+
+	pOut = pPixels;
+	for(row = 0; row < cy; row++)
+	{
+		pIn = pImage->pPixels + (row * pImage->cy / cy) * pImage->cx + nFrame * pImage->cxFrame;
+		for(col = 0; col < cx; col++)
+		{	*pOut++ = pIn[col * pImage->cxFrame / cx];	}
+	}
+
+	HostDisplay_GetClip(pIDisplay, &rcClip);
+	HostBitmap_Blit565(pIDisplay->pDest, &rcClip, x, y, pPixels, cx * 2, 0, 0, cx, cy, pImage->nRop);
+	FREE(pPixels);
+}
+
+//the same resize on the indices, expanded only as the scratch copy is drawn
+static void HostImage_DrawScaledIndexed(IImage* pImage, int nFrame, int x, int y)
+{
+	IDisplay* pIDisplay = pImage->pIShell->pIDisplay;
+	AEERect rcClip;
+	const byte* pIn;
+	byte* pIndices;
+	byte* pOut;
+	int cx = pImage->cxScale;
+	int cy = pImage->cyScale;
+	int row;
+	int col;
+
+	pIndices = (byte*)MALLOC((uint32)(cx * cy));
+	if(pIndices == NULL)
+	{	return;		}
+
+	pOut = pIndices;
+	for(row = 0; row < cy; row++)
+	{
+		pIn = pImage->pIndices + (row * pImage->cy / cy) * pImage->cx + nFrame * pImage->cxFrame;
+		for(col = 0; col < cx; col++)
+		{	*pOut++ = pIn[col * pImage->cxFrame / cx];	}
+	}
+
+	HostDisplay_GetClip(pIDisplay, &rcClip);
+	HostBitmap_BlitIndexed(pIDisplay->pDest, &rcClip, x, y, pIndices, cx, 0, 0, cx, cy, pImage->nRop, pImage->pPalette->wColors);
+	FREE(pIndices);
+}
@@ -0,0 +1,237 @@
+/*===========================================================================
+
+FILE: HostInternal.h
+
+Object layouts shared by the host runtime's translation units.
+===========================================================================*/
+#ifndef HOSTINTERNAL_H
+#define HOSTINTERNAL_H
+
+#include "AEEStdLib.h"
+#include "AEEModGen.h"
+#include "AEEAppGen.h"
+#include "AEEMenu.h"
+#include "AEEText.h"
+#include "AEEFile.h"
+#include "AEEMemAStream.h"
+
+#include "HostRuntime.h"
+
+#define HOST_MAX_TIMERS		32
+#define HOST_MAX_EVENTS		32
+#define HOST_MAX_MENUITEMS	16
+#define HOST_MAX_SHARED_PNGS	64
+#define HOST_TEXT_MAX		256
+#define HOST_ATLAS_FRAMES	4
+
+#define HOST_KEY_565		0xF81F		// magenta, the transparent color of every host image
+#define HOST_KEY_RGB		MAKE_RGB(0xFF, 0x00, 0xFF)	// the same, for bitmaps of other depths
+
+typedef struct _HostTimer {
+	PFNNOTIFY	pfn;
+	void*		pUser;
+	uint64_t	qwDeadlineUs;
+	uint32		dwSeq;			// breaks ties between equal deadlines
+} HostTimer;
+
+// one depth's pixel kernels; pitches are in bytes, widths in pixels
+typedef struct _HostBlitKernels {
+	const char*	pszPath;		// "scalar", "sse2", "avx2" or "neon"
+	int			nDepth;
+	void		(*pfnCopy)(byte* pDst, int nDstPitch, const byte* pSrc, int nSrcPitch, int cx, int cy);
+	void		(*pfnKeyed)(byte* pDst, int nDstPitch, const byte* pSrc, int nSrcPitch, int cx, int cy, uint32 dwKey);
+	void		(*pfnFill)(byte* pDst, int nDstPitch, int cx, int cy, uint32 dwColor);
+} HostBlitKernels;
+
+typedef struct _HostEvent {
+	AEEEvent	eCode;
+	uint16		wParam;
+	uint32		dwParam;
+} HostEvent;
+
+struct IBitmap {
+	IDIB		dib;			// first, so an IBitmap* is also its IDIB*
+	uint32		nRefs;
+	IShell*		pIShell;
+	boolean		bDevice;
+	boolean		bDirty;
+	AEERect		rcDirty;		// union of everything drawn since the last update
+};
+
+struct IDisplay {
+	IShell*		pIShell;
+	IBitmap*	pDevice;
+	IBitmap*	pDest;
+	AEERect		rcClip;
+	boolean		bClip;
+	NativeColor	ncBackground;	// in the device bitmap's format
+	NativeColor	ncText;
+};
+
+// an indexed PNG's colors in RGB565, HOST_KEY_565 for the transparent ones; on each host,
+// images whose PNGs carry the same palette share one
+typedef struct _HostPalette {
+	uint32		nRefs;
+	uint16		nColors;
+	uint16		wColors[256];	// past nColors, HOST_KEY_565
+	struct _HostPalette*	pNext;	// the host's live palettes
+} HostPalette;
+
+struct IImage {
+	uint32		nRefs;
+	IShell*		pIShell;
+	uint16*		pPixels;		// RGB565, HOST_KEY_565 where the PNG was transparent
+	byte*		pIndices;		// indexed PNGs instead: one byte a pixel into pPalette, pPixels is NULL
+	HostPalette*	pPalette;
+	boolean		bSharedPixels;	// the pixels and palette belong to the Host_SharePNGs table, not to the image
+	uint16		cx;
+	uint16		cy;
+	int			nRop;
+	int			nFrames;
+	int			cxFrame;
+	int			xOffset;
+	int			yOffset;
+	int			cxDraw;			// 0 draws the whole frame
+	int			cyDraw;
+	int			cxScale;		// IPARM_SCALE, 0 draws at the decoded size
+	int			cyScale;
+	PFNIMAGEINFO	pfnNotify;		// IIMAGE_Notify, streams are then decoded as they fill
+	void*		pNotifyUser;
+	struct _HostPNGStream*	pPending;	// the decode under way, NULL when there is none
+	boolean		bDead;			// released while Host_KeepDeadImages was on, only the husk is left
+	IImage*		pNextDead;
+};
+
+struct IStatic {
+	uint32		nRefs;
+	IShell*		pIShell;
+	AEERect		rc;
+	AECHAR		szTitle[HOST_TEXT_MAX];
+	AECHAR		szText[HOST_TEXT_MAX];
+	AEEFont		fntTitle;
+	AEEFont		fntText;
+};
+
+typedef struct _HostMenuItem {
+	uint16		nItemID;
+	AECHAR		szText[64];
+} HostMenuItem;
+
+struct IMenuCtl {
+	uint32			nRefs;
+	IShell*			pIShell;
+	AEERect			rc;
+	AECHAR			szTitle[64];
+	HostMenuItem	items[HOST_MAX_MENUITEMS];
+	int				nItems;
+	int				nSel;
+	boolean			bActive;
+};
+
+struct IFileMgr {
+	uint32		nRefs;
+	IShell*		pIShell;
+};
+
+struct IFile {
+	uint32		nRefs;
+	IShell*		pIShell;
+	void*		pStream;		// FILE*
+	void*		pMap;			// IFILE_Map's view, unmapped on release
+	uint32		dwMapSize;
+};
+
+struct IMemAStream {
+	uint32		nRefs;
+	IShell*		pIShell;
+	byte*		pBuff;
+	uint32		dwSize;
+	uint32		dwOffset;
+	PFNNOTIFY	pfnFree;		// how pBuff is let go, NULL leaves it to the caller
+	void*		pUser;
+};
+
+struct IShell {
+	char			szAssetDir[256];
+	char			szAppDir[256];	// where IFileMgr names are relative to
+	AEEDeviceInfo	di;
+	IDisplay*		pIDisplay;
+	IApplet*		pApplet;
+	IMenuCtl*		pActiveMenu;
+
+	HostClock		clock;
+	uint64_t		qwVirtualUs;	// the virtual clock's time
+	uint32			dwUpdateCostUs;	// what a screen update costs on the virtual clock
+	HostTimer		timers[HOST_MAX_TIMERS];
+	int				nTimers;
+	uint32			dwTimerSeq;
+	HostEvent		events[HOST_MAX_EVENTS];
+	int				nEvents;
+	uint64_t		qwStartUs;		// Host_NowUs at the applet's creation, 0 once its first pixels are out
+
+	HostStats		stats;
+	boolean			bQuiet;
+	HostPalette*	pPalettes;		// shared by the images decoded on this host
+	boolean			bKeepDeadImages;
+	IImage*			pDeadImages;	// husks of the applet's released images, until it stops
+};
+
+// HostShell.c
+IShell*		Host_Current(void);
+
+// HostStdLib.c
+void		HostStdLib_Disown(void* p);		// a MALLOC block stops counting against the heap, and stays allocated
+void		HostStdLib_FreeDisowned(void* p);
+
+// HostTimer.c
+boolean		HostTimer_PopNext(IShell* pIShell, HostTimer* pTimer);
+void		HostClock_ChargeUpdate(IShell* pIShell);
+
+// HostDisplay.c
+IDisplay*	HostDisplay_New(IShell* pIShell, int cx, int cy, int nDepth);
+void		HostDisplay_Delete(IDisplay* pIDisplay);
+IBitmap*	HostBitmap_New(IShell* pIShell, int cx, int cy, int nDepth);	// 8, 16 or 32 bits per pixel
+void		HostBitmap_Blit(IBitmap* pDst, const AEERect* prcClip, int x, int y,
+							const byte* pSrc, int nSrcPitch, int xSrc, int ySrc, int cx, int cy, int nRop);
+void		HostBitmap_Blit565(IBitmap* pDst, const AEERect* prcClip, int x, int y,
+							   const uint16* pSrc, int nSrcPitch, int xSrc, int ySrc, int cx, int cy, int nRop);
+void		HostBitmap_BlitIndexed(IBitmap* pDst, const AEERect* prcClip, int x, int y, const byte* pSrc, int nSrcPitch,
+								   int xSrc, int ySrc, int cx, int cy, int nRop, const uint16* pPalette);
+void		HostBitmap_Fill(IBitmap* pDst, const AEERect* prcClip, const AEERect* prc, NativeColor nc);
+void		HostDisplay_GetClip(IDisplay* pIDisplay, AEERect* prc);
+int			HostDisplay_FontHeight(AEEFont nFont);
+
+// HostBlit.c
+void		HostBlit_Init(void);
+const HostBlitKernels* HostBlit_Get(int nDepth);
+const HostBlitKernels* HostBlit_GetPath(int nDepth, int nPath);
+void		HostBlit_Expand8(byte* pDst, int nDstPitch, const byte* pSrc, int nSrcPitch, int cx, int cy, const uint8* pPalette);
+void		HostBlit_Expand16(byte* pDst, int nDstPitch, const byte* pSrc, int nSrcPitch, int cx, int cy, const uint16* pPalette);
+void		HostBlit_Expand32(byte* pDst, int nDstPitch, const byte* pSrc, int nSrcPitch, int cx, int cy, const uint32* pPalette);
+void		HostBlit_ExpandKeyed8(byte* pDst, int nDstPitch, const byte* pSrc, int nSrcPitch, int cx, int cy,
+								  const uint8* pPalette, uint32 dwKey);
+void		HostBlit_ExpandKeyed16(byte* pDst, int nDstPitch, const byte* pSrc, int nSrcPitch, int cx, int cy,
+								   const uint16* pPalette, uint32 dwKey);
+void		HostBlit_ExpandKeyed32(byte* pDst, int nDstPitch, const byte* pSrc, int nSrcPitch, int cx, int cy,
+								   const uint32* pPalette, uint32 dwKey);
+
+// HostImage.c
+IImage*		HostImage_New(IShell* pIShell);
+IImage*		HostImage_LoadPNG(IShell* pIShell, const char* pszPath);
+void		HostImage_FreeDead(IShell* pIShell);
+
+// HostResources.c
+const char*	HostRes_ImagePath(uint16 nResID);
+const char*	HostRes_String(uint16 nResID);
+boolean		HostRes_Entry(int nIndex, uint16* pnResID, uint16* pnType, const char** ppsz);
+boolean		HostRes_Atlas(int nIndex, uint16* pnAtlasID, const uint16** ppnFrameIDs);	//HOST_ATLAS_FRAMES IDs, 0 past the last
+
+// HostControls.c
+IStatic*	HostStatic_New(IShell* pIShell);
+IMenuCtl*	HostMenu_New(IShell* pIShell);
+
+// HostFile.c
+IFileMgr*	HostFileMgr_New(IShell* pIShell);
+IMemAStream* HostMemAStream_New(IShell* pIShell);
+
+#endif // HOSTINTERNAL_H
@@ -0,0 +1,133 @@
+/*===========================================================================
+
+FILE: HostResources.c
+
+What hamlet.bar holds, for the host: every IMG_ ID names a PNG under the
+asset directory (Hamlet_Brew/Assets.xcassets) and every string ID carries
+the text GameLogic.swift shows for the same beat of the story, with '^'
+for the line breaks EndlinizeString turns into '\n'. The atlases have no
+PNG of their own; hamlet_pack stacks their frames into one.
+===========================================================================*/
+#include "HostInternal.h"
+#include "Hamlet.brh"
+
+typedef struct _HostResource {
+	uint16		nResID;
+	const char*	psz;
+} HostResource;
+
+static const HostResource gImages[] =
+{
+	{ IMG_LOGO,			"CutScenes/logo.imageset/logo.png" },
+	{ IMG_BACK0,		"SetPieces/back0.imageset/back0.png" },
+	{ IMG_BACK1,		"SetPieces/back1.imageset/back1.png" },
+	{ IMG_BACK2,		"SetPieces/back2.imageset/back2.png" },
+	{ IMG_BACK3,		"SetPieces/back3.imageset/back3.png" },
+	{ IMG_WALL0,		"SetPieces/wall0.imageset/wall0.png" },
+	{ IMG_WALL1,		"SetPieces/wall1.imageset/wall1.png" },
+	{ IMG_WALL2,		"SetPieces/wall2.imageset/wall2.png" },
+	{ IMG_WALL3,		"SetPieces/wall3.imageset/wall3.png" },
+	{ IMG_HAMLET,		"Characters/hamlet.imageset/hamlet.png" },
+	{ IMG_GERTRUDE,		"Characters/gertrude.imageset/gertrude.png" },
+	{ IMG_SWORD1,		"Props/sword1.imageset/sword1.png" },
+	{ IMG_SWORD2,		"Props/sword2.imageset/sword2.png" },
+	{ IMG_SWORD3,		"Props/sword3.imageset/sword3.png" },
+	{ IMG_POLONIUS1,	"Characters/polonius1.imageset/polonius1.png" },
+	{ IMG_POLONIUS2,	"Characters/polonius2.imageset/polonius2.png" },
+	{ IMG_POLONIUS3,	"Characters/polonius3.imageset/polonius3.png" },
+	{ IMG_KENNY1,		"Characters/kenny1.imageset/kenny1.png" },
+	{ IMG_KENNY2,		"Characters/kenny2.imageset/kenny2.png" },
+	{ IMG_KENNY3,		"Characters/kenny3.imageset/kenny3.png" },
+	{ IMG_SPLINTER1,	"Characters/splinter1.imageset/splinter1.png" },
+	{ IMG_SPLINTER2,	"Characters/splinter2.imageset/splinter2.png" },
+	{ IMG_SPLINTER3,	"Characters/splinter3.imageset/splinter3.png" },
+	{ IMG_TEARDROPS,	"Props/teardrops.imageset/teardrops.png" },
+	{ IMG_STANKYLE,		"CutScenes/stankyle.imageset/stankyle.png" },
+	{ IMG_TURTLES,		"CutScenes/turtles.imageset/turtles.png" },
+};
+
+typedef struct _HostAtlas {
+	uint16		nAtlasID;
+	uint16		nFrameIDs[HOST_ATLAS_FRAMES];	// in the order they go into it, 0 past the last
+} HostAtlas;
+
+static const HostAtlas gAtlases[] =
+{
+	{ IMG_SWORD_ATLAS,		{ IMG_SWORD1, IMG_SWORD2, IMG_SWORD3 } },
+	{ IMG_POLONIUS_ATLAS,	{ IMG_POLONIUS1, IMG_POLONIUS2, IMG_POLONIUS3 } },
+	{ IMG_KENNY_ATLAS,		{ IMG_KENNY1, IMG_KENNY2, IMG_KENNY3 } },
+	{ IMG_SPLINTER_ATLAS,	{ IMG_SPLINTER1, IMG_SPLINTER2, IMG_SPLINTER3 } },
+};
+
+static const HostResource gStrings[] =
+{
+	{ STAT_TITLE,			"Hamlet" },
+	{ TEXT_LEVEL3,			"Queen Gertrude:  Hamlet, o, Hamlet.  Wherefore art thou staring at my curtain?^Hamlet:  For I've found a rat.  Die, rat, die!" },
+	{ TEXT_LEVEL5,			"Hamlet stabs the rat" },
+	{ TEXT_LEVEL6_POLONIUS,	"Polonius: Oy, I am slain, bleh.^*Polonius falls*" },
+	{ TEXT_LEVEL6_KENNY,	"Kenny: Mmmmmmmm.^*Kenny dies*" },
+	{ TEXT_LEVEL6_SPLINTER,	"Splinter: Why? Why me?^*Splinter falls*" },
+	{ TEXT_LEVEL7_POLONIUS,	"Queen Gertrude: *cries* Unbelievable!  Thou has wrecked my favorite curtain!  Consider thyself disowned!  ~THE END~" },
+	{ TEXT_LEVEL7_KENNY,	"Stan: Oh my god! They killed Kenny!^Kyle: You bastards!^~THE END~" },
+	{ TEXT_LEVEL7_SPLINTER,	"Splinter:  Turtles, you must avenge my death!^Da Vinci:  Aww.. Do we have to?^~THE END~" },
+	{ INSTRUCTION0,			"Instructions:" },
+	{ INSTRUCTION1,			"Press 1,2,3 to" },
+	{ INSTRUCTION2,			"change landscape" },
+	{ INSTRUCTION3,			"Press 4,5,6 to" },
+	{ INSTRUCTION4,			"change the wall" },
+	{ STR_MENUTITLE,		"Who does Hamlet Kill?" },
+	{ STR_POLONIUS,			"Polonius" },
+	{ STR_KENNY,			"Kenny" },
+	{ STR_SPLINTER,			"Splinter" },
+};
+
+static const char* HostRes_Find(const HostResource* pTable, int nCount, uint16 nResID)
+{
+	int i;
+
+	for(i = 0; i < nCount; i++)
+	{
+		if(pTable[i].nResID == nResID)
+		{	return pTable[i].psz;	}
+	}
+	return NULL;
+}
+
+//path relative to the asset directory, NULL for an unknown ID
+const char* HostRes_ImagePath(uint16 nResID)
+{
+	return HostRes_Find(gImages, (int)(sizeof(gImages)/sizeof(gImages[0])), nResID);
+}
+
+const char* HostRes_String(uint16 nResID)
+{
+	return HostRes_Find(gStrings, (int)(sizeof(gStrings)/sizeof(gStrings[0])), nResID);
+}
+
+//walks the images, then the strings, for tools that bundle them; FALSE past the last one
+boolean HostRes_Entry(int nIndex, uint16* pnResID, uint16* pnType, const char** ppsz)
+{
+	int nImages = (int)(sizeof(gImages)/sizeof(gImages[0]));
+	int nStrings = (int)(sizeof(gStrings)/sizeof(gStrings[0]));
+	const HostResource* pRes;
+
+	if(nIndex < 0 || nIndex >= nImages + nStrings)
+	{	return FALSE;	}
+
+	pRes = (nIndex < nImages) ? &gImages[nIndex] : &gStrings[nIndex - nImages];
+	*pnResID = pRes->nResID;
+	*pnType = (nIndex < nImages) ? RESTYPE_IMAGE : RESTYPE_STRING;
+	*ppsz = pRes->psz;
+	return TRUE;
+}
+
+//walks the atlases and the frames that go into each; FALSE past the last one
+boolean HostRes_Atlas(int nIndex, uint16* pnAtlasID, const uint16** ppnFrameIDs)
+{
+	if(nIndex < 0 || nIndex >= (int)(sizeof(gAtlases)/sizeof(gAtlases[0])))
+	{	return FALSE;	}
+
+	*pnAtlasID = gAtlases[nIndex].nAtlasID;
+	*ppnFrameIDs = gAtlases[nIndex].nFrameIDs;
+	return TRUE;
+}
@@ -0,0 +1,90 @@
+/*===========================================================================
+
+FILE: HostRuntime.h
+
+Driver-side API of the headless host runtime. A driver (the benchmark,
+a test harness) creates a host, starts the applet in it, feeds it
+events and runs its timers. Hamlet.c itself never sees this header.
+===========================================================================*/
+#ifndef HOSTRUNTIME_H
+#define HOSTRUNTIME_H
+
+#include <stdint.h>
+
+#include "AEEShell.h"
+
+#define HOST_SCREEN_CX	128		// same screen as BrewScreen.swift
+#define HOST_SCREEN_CY	146
+
+typedef struct _HostStats {
+	// heap, through MALLOC/FREE
+	uint32	nAllocs;
+	uint32	nFrees;
+	uint32	dwLiveBytes;
+	uint32	dwPeakBytes;
+
+	// interface objects currently alive
+	uint32	nLiveImages;
+	uint32	nLiveBitmaps;
+	uint32	nLiveStatics;
+	uint32	nLiveMenus;
+	uint32	nLiveMenuItems;	// across all live menus
+
+	// resource access
+	uint32	nImageDecodes;
+	uint32	dwDecodeUs;
+	uint32	nStringLoads;
+	uint32	nSharedDecodes;	// PNGs found already decoded in the Host_SharePNGs table
+	uint32	nDeadImageCalls;	// IIMAGE_* on an image already released, while Host_KeepDeadImages is on
+
+	// display
+	uint32	nClears;
+	uint32	nUpdates;
+	uint32	dwPixelsPushed;
+	uint32	dwPixelsDrawn;
+	uint32	nEmptyUpdates;	// IDISPLAY_Updates with nothing drawn since the last one
+
+	// time spent inside the applet, waits for timer deadlines excluded
+	uint32	dwDispatchUs;
+	uint32	nTimersFired;
+	uint32	nEvents;
+	uint32	dwFirstPixelUs;	// wall time from the latest start's AEEClsCreateInstance to its first IDISPLAY_Update with anything to push
+} HostStats;
+
+// where a host's timers and GETUPTIMEMS get their time; pfnWaitUntil
+// returns once pfnNow has reached qwUs
+typedef struct _HostClock {
+	uint64_t	(*pfnNow)(void* pCtx);
+	void		(*pfnWaitUntil)(void* pCtx, uint64_t qwUs);
+	void*		pCtx;
+} HostClock;
+
+IShell*		Host_Create(const char* pszAssetDir, int cxScreen, int cyScreen);
+void		Host_Destroy(IShell* pIShell);
+void		Host_SetAppDir(IShell* pIShell, const char* pszAppDir);	// "." unless set
+boolean		Host_SetColorDepth(IShell* pIShell, int nDepth);	// 16 unless set; 8 is RGB332, 32 is RGB888 in 32-bit words
+void		Host_MakeCurrent(IShell* pIShell);	// MALLOC and friends charge this host
+void		Host_SetQuiet(IShell* pIShell, boolean bQuiet);	// drops the applet's DBGPRINTFs
+void		Host_KeepDeadImages(IShell* pIShell, boolean bKeep);	// released IImages stay behind, so calls on them are counted
+
+void		Host_SetClock(IShell* pIShell, const HostClock* pClock);	// NULL is real time, the default
+void		Host_SetVirtualClock(IShell* pIShell);
+void		Host_SetUpdateCost(IShell* pIShell, uint32 dwUs);	// virtual clock only: each IDISPLAY_Update that pushes anything takes this long
+uint64_t	Host_ClockUs(IShell* pIShell);
+
+boolean		Host_StartApplet(IShell* pIShell, AEECLSID cls);
+void		Host_StopApplet(IShell* pIShell);
+void		Host_SuspendApplet(IShell* pIShell);	// and something else draws over the screen
+void		Host_ResumeApplet(IShell* pIShell);
+boolean		Host_SendEvent(IShell* pIShell, AEEEvent eCode, uint16 wParam, uint32 dwParam);
+boolean		Host_RunNextTimer(IShell* pIShell);	// FALSE when nothing is scheduled
+int			Host_PendingTimers(IShell* pIShell);	// set and not fired yet
+IMenuCtl*	Host_GetActiveMenu(IShell* pIShell);
+
+void		Host_SharePNGs(boolean bRecord);	// process-wide, see HostImage.c
+
+uint64_t	Host_NowUs(void);	// wall clock, for measuring
+HostStats*	Host_GetStats(IShell* pIShell);
+const byte*	Host_GetFramebuffer(IShell* pIShell, int* pcx, int* pcy, int* pnDepth);	// rows of cx pixels, no padding
+
+#endif // HOSTRUNTIME_H
@@ -0,0 +1,408 @@
+/*===========================================================================
+
+FILE: HostShell.c
+
+IShell on the host: one IShell is one simulated handset, with its own
+display, timers, event queue, applet and statistics.
+===========================================================================*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "HostInternal.h"
+
+static __thread IShell* gpCurrent;	// the host MALLOC and GETUPTIMEMS charge
+
+static void HostShell_DispatchEvents(IShell* pIShell);
+
+/*===============================================================================
+HOST CONTROL
+=============================================================================== */
+
+IShell* Host_Create(const char* pszAssetDir, int cxScreen, int cyScreen)
+{
+	IShell* pIShell = (IShell*)calloc(1, sizeof(IShell));
+
+	if(pIShell == NULL)
+	{	return NULL;	}
+
+	snprintf(pIShell->szAssetDir, sizeof(pIShell->szAssetDir), "%s", pszAssetDir);
+	Host_SetAppDir(pIShell, ".");
+	pIShell->di.cxScreen = (uint16)cxScreen;
+	pIShell->di.cyScreen = (uint16)cyScreen;
+	pIShell->di.nColorDepth = 16;
+	pIShell->di.dwRAM = 1024 * 1024;
+
+	Host_SetClock(pIShell, NULL);
+	Host_MakeCurrent(pIShell);
+	HostBlit_Init();
+	pIShell->pIDisplay = HostDisplay_New(pIShell, cxScreen, cyScreen, pIShell->di.nColorDepth);
+	if(pIShell->pIDisplay == NULL)
+	{
+		free(pIShell);
+		return NULL;
+	}
+	return pIShell;
+}
+
+void Host_Destroy(IShell* pIShell)
+{
+	if(pIShell->pApplet)
+	{	Host_StopApplet(pIShell);	}
+
+	HostImage_FreeDead(pIShell);
+	HostDisplay_Delete(pIShell->pIDisplay);
+	if(gpCurrent == pIShell)
+	{	gpCurrent = NULL;	}
+	free(pIShell);
+}
+
+//a new device bitmap of that depth; only while no applet is running, and only 8, 16 or 32 bits
+boolean Host_SetColorDepth(IShell* pIShell, int nDepth)
+{
+	IDisplay* pIDisplay;
+
+	if(pIShell->pApplet || HostBlit_Get(nDepth) == NULL)
+	{	return FALSE;	}
+	if(nDepth == pIShell->di.nColorDepth)
+	{	return TRUE;	}
+
+	Host_MakeCurrent(pIShell);
+	pIDisplay = HostDisplay_New(pIShell, pIShell->di.cxScreen, pIShell->di.cyScreen, nDepth);
+	if(pIDisplay == NULL)
+	{	return FALSE;	}
+
+	HostDisplay_Delete(pIShell->pIDisplay);
+	pIShell->pIDisplay = pIDisplay;
+	pIShell->di.nColorDepth = (uint16)nDepth;
+	return TRUE;
+}
+
+void Host_SetAppDir(IShell* pIShell, const char* pszAppDir)
+{
+	snprintf(pIShell->szAppDir, sizeof(pIShell->szAppDir), "%s", pszAppDir);
+}
+
+void Host_MakeCurrent(IShell* pIShell)
+{
+	gpCurrent = pIShell;
+}
+
+void Host_SetQuiet(IShell* pIShell, boolean bQuiet)
+{
+	pIShell->bQuiet = bQuiet;
+}
+
+void Host_KeepDeadImages(IShell* pIShell, boolean bKeep)
+{
+	pIShell->bKeepDeadImages = bKeep;
+}
+
+IShell* Host_Current(void)
+{
+	return gpCurrent;
+}
+
+//creates the applet the way the module loader would and sends it EVT_APP_START
+boolean Host_StartApplet(IShell* pIShell, AEECLSID cls)
+{
+	void* pObj = NULL;
+
+	Host_MakeCurrent(pIShell);
+	pIShell->stats.dwFirstPixelUs = 0;
+	pIShell->qwStartUs = Host_NowUs();
+	if(AEEClsCreateInstance(cls, pIShell, NULL, &pObj) != AEE_SUCCESS)
+	{
+		pIShell->qwStartUs = 0;
+		return FALSE;
+	}
+
+	pIShell->pApplet = (IApplet*)pObj;
+	return Host_SendEvent(pIShell, EVT_APP_START, 0, 0);
+}
+
+void Host_StopApplet(IShell* pIShell)
+{
+	if(pIShell->pApplet == NULL)
+	{	return;		}
+
+	Host_MakeCurrent(pIShell);
+	Host_SendEvent(pIShell, EVT_APP_STOP, 0, 0);
+	pIShell->nTimers = 0;
+	pIShell->nEvents = 0;
+	IAPPLET_Release(pIShell->pApplet);
+	pIShell->pApplet = NULL;
+	pIShell->pActiveMenu = NULL;
+	HostImage_FreeDead(pIShell);	//nothing is left to point at them
+}
+
+//EVT_APP_SUSPEND, then another applet has the screen; what the applet drew is gone
+void Host_SuspendApplet(IShell* pIShell)
+{
+	IBitmap* pDevice = pIShell->pIDisplay->pDevice;
+
+	Host_SendEvent(pIShell, EVT_APP_SUSPEND, 0, 0);
+	memset(pDevice->dib.pBmp, 0x5A, pDevice->dib.nPitch * pDevice->dib.cy);
+}
+
+void Host_ResumeApplet(IShell* pIShell)
+{
+	Host_SendEvent(pIShell, EVT_APP_RESUME, 0, 0);
+}
+
+//straight into the applet's handler, then whatever it posted
+boolean Host_SendEvent(IShell* pIShell, AEEEvent eCode, uint16 wParam, uint32 dwParam)
+{
+	uint64_t qwStart;
+	boolean bHandled;
+
+	if(pIShell->pApplet == NULL)
+	{	return FALSE;	}
+
+	Host_MakeCurrent(pIShell);
+	pIShell->stats.nEvents++;
+
+	qwStart = Host_NowUs();
+	bHandled = IAPPLET_HandleEvent(pIShell->pApplet, eCode, wParam, dwParam);
+	HostShell_DispatchEvents(pIShell);
+	pIShell->stats.dwDispatchUs += (uint32)(Host_NowUs() - qwStart);
+	return bHandled;
+}
+
+//waits on the host's clock for the earliest timer and fires it
+boolean Host_RunNextTimer(IShell* pIShell)
+{
+	HostTimer timer;
+	uint64_t qwStart;
+
+	Host_MakeCurrent(pIShell);
+	HostShell_DispatchEvents(pIShell);
+	if(!HostTimer_PopNext(pIShell, &timer))
+	{	return FALSE;	}
+
+	qwStart = Host_NowUs();
+	pIShell->stats.nTimersFired++;
+	timer.pfn(timer.pUser);
+	HostShell_DispatchEvents(pIShell);
+	pIShell->stats.dwDispatchUs += (uint32)(Host_NowUs() - qwStart);
+	return TRUE;
+}
+
+int Host_PendingTimers(IShell* pIShell)
+{
+	return pIShell->nTimers;
+}
+
+IMenuCtl* Host_GetActiveMenu(IShell* pIShell)
+{
+	return pIShell->pActiveMenu;
+}
+
+HostStats* Host_GetStats(IShell* pIShell)
+{
+	return &pIShell->stats;
+}
+
+static void HostShell_DispatchEvents(IShell* pIShell)
+{
+	HostEvent evt;
+
+	while(pIShell->nEvents > 0 && pIShell->pApplet)
+	{
+		evt = pIShell->events[0];
+		pIShell->nEvents--;
+		memmove(&pIShell->events[0], &pIShell->events[1], pIShell->nEvents * sizeof(HostEvent));
+		pIShell->stats.nEvents++;
+		IAPPLET_HandleEvent(pIShell->pApplet, evt.eCode, evt.wParam, evt.dwParam);
+	}
+}
+
+/*===============================================================================
+ISHELL
+=============================================================================== */
+
+void ISHELL_GetDeviceInfo(IShell* po, AEEDeviceInfo* pi)
+{
+	uint16 wSize = pi->wStructSize;
+
+	*pi = po->di;
+	pi->wStructSize = wSize;
+}
+
+int ISHELL_CreateInstance(IShell* po, AEECLSID cls, void** ppobj)
+{
+	*ppobj = NULL;
+	switch(cls)
+	{
+		case AEECLSID_STATIC:
+			*ppobj = HostStatic_New(po);
+			break;
+		case AEECLSID_MENUCTL:
+			*ppobj = HostMenu_New(po);
+			break;
+		case AEECLSID_FILEMGR:
+			*ppobj = HostFileMgr_New(po);
+			break;
+		case AEECLSID_MEMASTREAM:
+			*ppobj = HostMemAStream_New(po);
+			break;
+		case AEECLSID_PNG:
+			*ppobj = HostImage_New(po);
+			break;
+		default:
+			return ECLASSNOTSUPPORT;
+	}
+	return *ppobj ? SUCCESS : ENOMEMORY;
+}
+
+//decodes the PNG behind nResID every time, like the handset decodes the resource
+IImage* ISHELL_LoadResImage(IShell* po, const char* pszResFile, uint16 nResID)
+{
+	char szPath[512];
+	const char* pszImage = HostRes_ImagePath(nResID);
+
+	(void)pszResFile;
+	if(pszImage == NULL)
+	{	return NULL;	}
+
+	snprintf(szPath, sizeof(szPath), "%s/%s", po->szAssetDir, pszImage);
+	return HostImage_LoadPNG(po, szPath);
+}
+
+//nSize is the buffer size in bytes; returns the number of characters copied
+int ISHELL_LoadResString(IShell* po, const char* pszResFile, uint16 nResID, AECHAR* pBuff, int nSize)
+{
+	const char* psz = HostRes_String(nResID);
+
+	(void)pszResFile;
+	po->stats.nStringLoads++;
+	if(psz == NULL || nSize < (int)sizeof(AECHAR))
+	{	return 0;	}
+
+	STRTOWSTR(psz, pBuff, nSize);
+	return WSTRLEN(pBuff);
+}
+
+//raw resource bytes: the PNG file for images, a zero-terminated AECHAR string for strings
+void* ISHELL_LoadResData(IShell* po, const char* pszResFile, uint16 nResID, uint16 nType)
+{
+	char szPath[512];
+	const char* psz;
+	FILE* pFile;
+	long nLen;
+	byte* pData = NULL;
+
+	(void)pszResFile;
+	if(nType == RESTYPE_STRING)
+	{
+		psz = HostRes_String(nResID);
+		if(psz == NULL)
+		{	return NULL;	}
+
+		po->stats.nStringLoads++;
+		nLen = (long)((strlen(psz) + 1) * sizeof(AECHAR));
+		pData = (byte*)MALLOC((uint32)nLen);
+		if(pData)
+		{	STRTOWSTR(psz, (AECHAR*)pData, (int)nLen);	}
+		return pData;
+	}
+
+	psz = HostRes_ImagePath(nResID);
+	if(psz == NULL)
+	{	return NULL;	}
+
+	snprintf(szPath, sizeof(szPath), "%s/%s", po->szAssetDir, psz);
+	pFile = fopen(szPath, "rb");
+	if(pFile == NULL)
+	{	return NULL;	}
+
+	fseek(pFile, 0, SEEK_END);
+	nLen = ftell(pFile);
+	fseek(pFile, 0, SEEK_SET);
+	pData = (byte*)MALLOC((uint32)nLen);
+	if(pData && fread(pData, 1, (size_t)nLen, pFile) != (size_t)nLen)
+	{
+		FREE(pData);
+		pData = NULL;
+	}
+	fclose(pFile);
+	return pData;
+}
+
+void ISHELL_FreeResData(IShell* po, void* pData)
+{
+	(void)po;
+	FREE(pData);
+}
+
+//there is only ever one applet on the host, so the class ID is not checked
+boolean ISHELL_SendEvent(IShell* po, AEECLSID cls, AEEEvent eCode, uint16 wParam, uint32 dwParam)
+{
+	(void)cls;
+	return Host_SendEvent(po, eCode, wParam, dwParam);
+}
+
+boolean ISHELL_PostEvent(IShell* po, AEECLSID cls, AEEEvent eCode, uint16 wParam, uint32 dwParam)
+{
+	(void)cls;
+	if(po->nEvents == HOST_MAX_EVENTS)
+	{	return FALSE;	}
+
+	po->events[po->nEvents].eCode = eCode;
+	po->events[po->nEvents].wParam = wParam;
+	po->events[po->nEvents].dwParam = dwParam;
+	po->nEvents++;
+	return TRUE;
+}
+
+/*===============================================================================
+AEEAPPGEN
+=============================================================================== */
+
+boolean AEEApplet_New(int16 nIn, AEECLSID clsID, IShell* pIShell, IModule* pIModule,
+					  IApplet** ppobj, AEEHANDLER pAppHandleEvent, PFNFREEAPPDATA pFreeAppData)
+{
+	AEEApplet* pApplet;
+
+	if(nIn < (int16)sizeof(AEEApplet))
+	{	nIn = (int16)sizeof(AEEApplet);	}
+
+	pApplet = (AEEApplet*)MALLOC((uint32)(uint16)nIn);
+	if(pApplet == NULL)
+	{
+		*ppobj = NULL;
+		return FALSE;
+	}
+
+	pApplet->pvt = (IApplet*)pApplet;
+	pApplet->clsID = clsID;
+	pApplet->m_nRefs = 1;
+	pApplet->m_pIShell = pIShell;
+	pApplet->m_pIModule = pIModule;
+	pApplet->m_pIDisplay = pIShell->pIDisplay;
+	pApplet->pAppHandleEvent = pAppHandleEvent;
+	pApplet->pFreeAppData = pFreeAppData;
+
+	*ppobj = (IApplet*)pApplet;
+	return TRUE;
+}
+
+uint32 IAPPLET_Release(IApplet* po)
+{
+	AEEApplet* pApplet = (AEEApplet*)po;
+
+	if(--pApplet->m_nRefs)
+	{	return pApplet->m_nRefs;	}
+
+	if(pApplet->pFreeAppData)
+	{	pApplet->pFreeAppData(pApplet);	}
+	FREE(pApplet);
+	return 0;
+}
+
+boolean IAPPLET_HandleEvent(IApplet* po, AEEEvent evt, uint16 wParam, uint32 dwParam)
+{
+	AEEApplet* pApplet = (AEEApplet*)po;
+
+	return pApplet->pAppHandleEvent(pApplet, evt, wParam, dwParam);
+}
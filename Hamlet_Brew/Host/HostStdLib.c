@@ -0,0 +1,184 @@
+/*===========================================================================
+
+FILE: HostStdLib.c
+
+MALLOC/FREE and the small wide-string helpers. Every block carries its
+size in front so the current host can keep live and peak byte counts.
+===========================================================================*/
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "HostInternal.h"
+
+typedef union _HostBlock {
+	uint32	dwSize;
+	double	dAlign;		// keeps the payload aligned like malloc's
+} HostBlock;
+
+static void HostStdLib_Charge(int32 nDelta)
+{
+	IShell* pIShell = Host_Current();
+	HostStats* pStats;
+
+	if(pIShell == NULL)
+	{	return;		}
+
+	pStats = &pIShell->stats;
+	if(nDelta > 0)
+	{
+		pStats->nAllocs++;
+		pStats->dwLiveBytes += (uint32)nDelta;
+		if(pStats->dwLiveBytes > pStats->dwPeakBytes)
+		{	pStats->dwPeakBytes = pStats->dwLiveBytes;	}
+	}
+	else
+	{
+		pStats->nFrees++;
+		pStats->dwLiveBytes -= (uint32)-nDelta;
+	}
+}
+
+//zero-filled, like the handset's MALLOC
+void* MALLOC(uint32 dwSize)
+{
+	HostBlock* pBlock = (HostBlock*)calloc(1, sizeof(HostBlock) + dwSize);
+
+	if(pBlock == NULL)
+	{	return NULL;	}
+
+	pBlock->dwSize = dwSize;
+	HostStdLib_Charge((int32)dwSize);
+	return pBlock + 1;
+}
+
+void* REALLOC(void* p, uint32 dwSize)
+{
+	HostBlock* pBlock;
+	uint32 dwOld;
+
+	if(p == NULL)
+	{	return MALLOC(dwSize);	}
+
+	pBlock = (HostBlock*)p - 1;
+	dwOld = pBlock->dwSize;
+	pBlock = (HostBlock*)realloc(pBlock, sizeof(HostBlock) + dwSize);
+	if(pBlock == NULL)
+	{	return NULL;	}
+
+	if(dwSize > dwOld)
+	{	memset((byte*)(pBlock + 1) + dwOld, 0, dwSize - dwOld);	}
+	pBlock->dwSize = dwSize;
+	HostStdLib_Charge(-(int32)dwOld);
+	HostStdLib_Charge((int32)dwSize);
+	return pBlock + 1;
+}
+
+void FREE(void* p)
+{
+	HostBlock* pBlock;
+
+	if(p == NULL)
+	{	return;		}
+
+	pBlock = (HostBlock*)p - 1;
+	HostStdLib_Charge(-(int32)pBlock->dwSize);
+	free(pBlock);
+}
+
+//for objects the host keeps past the applet's FREE; they are no part of its heap any more
+void HostStdLib_Disown(void* p)
+{
+	HostStdLib_Charge(-(int32)((HostBlock*)p - 1)->dwSize);
+}
+
+void HostStdLib_FreeDisowned(void* p)
+{
+	free((HostBlock*)p - 1);
+}
+
+//the device's dwRAM less the live blocks; the host heap does not fragment, so all of it is one block
+uint32 GETRAMFREE(uint32* pdwTotal, uint32* pdwMax)
+{
+	IShell* pIShell = Host_Current();
+	uint32 dwFree = 0;
+
+	if(pIShell && pIShell->stats.dwLiveBytes < pIShell->di.dwRAM)
+	{	dwFree = pIShell->di.dwRAM - pIShell->stats.dwLiveBytes;	}
+
+	if(pdwTotal)
+	{	*pdwTotal = pIShell ? pIShell->di.dwRAM : 0;	}
+	if(pdwMax)
+	{	*pdwMax = dwFree;	}
+	return dwFree;
+}
+
+int WSTRLEN(const AECHAR* pws)
+{
+	int n = 0;
+
+	while(pws[n])
+	{	n++;	}
+	return n;
+}
+
+AECHAR* WSTRCPY(AECHAR* pDest, const AECHAR* pSrc)
+{
+	AECHAR* p = pDest;
+
+	while((*p++ = *pSrc++) != 0)
+	{	}
+	return pDest;
+}
+
+//nSize is in bytes, as on the handset
+AECHAR* STRTOWSTR(const char* psz, AECHAR* pDest, int nSize)
+{
+	int nMax = nSize / (int)sizeof(AECHAR) - 1;
+	int i;
+
+	for(i = 0; i < nMax && psz[i]; i++)
+	{
+		pDest[i] = (AECHAR)(byte)psz[i];
+	}
+	if(nMax >= 0)
+	{	pDest[i] = 0;	}
+	return pDest;
+}
+
+uint64_t Host_NowUs(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u;
+}
+
+//the current host's clock, so virtual runs see virtual time
+uint32 GETUPTIMEMS(void)
+{
+	IShell* pIShell = Host_Current();
+
+	return (uint32)((pIShell ? Host_ClockUs(pIShell) : Host_NowUs()) / 1000);
+}
+
+uint32 GETTIMEMS(void)
+{
+	return GETUPTIMEMS();
+}
+
+void Host_DbgPrintf(const char* pszFormat, ...)
+{
+	IShell* pIShell = Host_Current();
+	va_list args;
+
+	if(pIShell && pIShell->bQuiet)
+	{	return;		}
+
+	va_start(args, pszFormat);
+	vfprintf(stderr, pszFormat, args);
+	va_end(args);
+	fputc('\n', stderr);
+}
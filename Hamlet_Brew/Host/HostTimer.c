@@ -0,0 +1,182 @@
+/*===========================================================================
+
+FILE: HostTimer.c
+
+The host's timer service. Timers are kept against a pluggable clock:
+the real clock sleeps until each deadline, the virtual clock jumps
+straight to it, so a whole story runs back to back in deadline order.
+Timers due at the same time fire in the order they were set, which
+keeps virtual runs identical from one run to the next.
+===========================================================================*/
+#include <time.h>
+
+#include "HostInternal.h"
+
+static uint64_t	HostClock_RealNow(void* pCtx);
+static void		HostClock_RealWaitUntil(void* pCtx, uint64_t qwUs);
+static uint64_t	HostClock_VirtualNow(void* pCtx);
+static void		HostClock_VirtualWaitUntil(void* pCtx, uint64_t qwUs);
+
+/*===============================================================================
+CLOCKS
+=============================================================================== */
+
+//NULL puts the host back on the wall clock; set it before the applet starts
+void Host_SetClock(IShell* pIShell, const HostClock* pClock)
+{
+	if(pClock)
+	{
+		pIShell->clock = *pClock;
+		return;
+	}
+	pIShell->clock.pfnNow = HostClock_RealNow;
+	pIShell->clock.pfnWaitUntil = HostClock_RealWaitUntil;
+	pIShell->clock.pCtx = NULL;
+}
+
+//virtual time starts at 0 and only moves when a timer comes due
+void Host_SetVirtualClock(IShell* pIShell)
+{
+	HostClock clock;
+
+	pIShell->qwVirtualUs = 0;
+	clock.pfnNow = HostClock_VirtualNow;
+	clock.pfnWaitUntil = HostClock_VirtualWaitUntil;
+	clock.pCtx = &pIShell->qwVirtualUs;
+	Host_SetClock(pIShell, &clock);
+}
+
+//a slow handset on virtual time: drawing takes time the applet sees before it sets its next timer
+void Host_SetUpdateCost(IShell* pIShell, uint32 dwUs)
+{
+	pIShell->dwUpdateCostUs = dwUs;
+}
+
+//called by IDISPLAY_Update; the real clock moves on by itself
+void HostClock_ChargeUpdate(IShell* pIShell)
+{
+	if(pIShell->clock.pfnNow == HostClock_VirtualNow)
+	{	pIShell->qwVirtualUs += pIShell->dwUpdateCostUs;	}
+}
+
+uint64_t Host_ClockUs(IShell* pIShell)
+{
+	return pIShell->clock.pfnNow(pIShell->clock.pCtx);
+}
+
+static uint64_t HostClock_RealNow(void* pCtx)
+{
+	(void)pCtx;
+	return Host_NowUs();
+}
+
+static void HostClock_RealWaitUntil(void* pCtx, uint64_t qwUs)
+{
+	uint64_t qwNow = Host_NowUs();
+	struct timespec ts;
+
+	(void)pCtx;
+	if(qwUs <= qwNow)
+	{	return;		}
+
+	ts.tv_sec = (time_t)((qwUs - qwNow) / 1000000u);
+	ts.tv_nsec = (long)((qwUs - qwNow) % 1000000u) * 1000;
+	nanosleep(&ts, NULL);
+}
+
+static uint64_t HostClock_VirtualNow(void* pCtx)
+{
+	return *(uint64_t*)pCtx;
+}
+
+static void HostClock_VirtualWaitUntil(void* pCtx, uint64_t qwUs)
+{
+	uint64_t* pqwNow = (uint64_t*)pCtx;
+
+	if(qwUs > *pqwNow)
+	{	*pqwNow = qwUs;	}
+}
+
+/*===============================================================================
+TIMERS
+=============================================================================== */
+
+//takes the earliest timer off the list once the clock reaches its deadline
+boolean HostTimer_PopNext(IShell* pIShell, HostTimer* pTimer)
+{
+	HostTimer* pNext;
+	int nNext = 0;
+	int i;
+
+	if(pIShell->nTimers == 0)
+	{	return FALSE;	}
+
+	for(i = 1; i < pIShell->nTimers; i++)
+	{
+		pNext = &pIShell->timers[nNext];
+		if(pIShell->timers[i].qwDeadlineUs < pNext->qwDeadlineUs
+			|| (pIShell->timers[i].qwDeadlineUs == pNext->qwDeadlineUs && pIShell->timers[i].dwSeq < pNext->dwSeq))
+		{	nNext = i;	}
+	}
+	*pTimer = pIShell->timers[nNext];
+	pIShell->timers[nNext] = pIShell->timers[--pIShell->nTimers];
+
+	pIShell->clock.pfnWaitUntil(pIShell->clock.pCtx, pTimer->qwDeadlineUs);
+	return TRUE;
+}
+
+//one timer per (pfn, pUser); setting it again moves the deadline
+int ISHELL_SetTimer(IShell* po, int32 dwMSecs, PFNNOTIFY pfn, void* pUser)
+{
+	int i;
+
+	for(i = 0; i < po->nTimers; i++)
+	{
+		if(po->timers[i].pfn == pfn && po->timers[i].pUser == pUser)
+		{	break;	}
+	}
+	if(i == po->nTimers)
+	{
+		if(po->nTimers == HOST_MAX_TIMERS)
+		{	return ENOMEMORY;	}
+		po->nTimers++;
+	}
+
+	po->timers[i].pfn = pfn;
+	po->timers[i].pUser = pUser;
+	po->timers[i].qwDeadlineUs = Host_ClockUs(po) + (uint64_t)(dwMSecs < 0 ? 0 : dwMSecs) * 1000u;
+	po->timers[i].dwSeq = po->dwTimerSeq++;
+	return SUCCESS;
+}
+
+//a NULL pfn cancels every timer of pUser
+int ISHELL_CancelTimer(IShell* po, PFNNOTIFY pfn, void* pUser)
+{
+	int i = 0;
+
+	while(i < po->nTimers)
+	{
+		if(po->timers[i].pUser == pUser && (pfn == NULL || po->timers[i].pfn == pfn))
+		{	po->timers[i] = po->timers[--po->nTimers];	}
+		else
+		{	i++;	}
+	}
+	return SUCCESS;
+}
+
+boolean ISHELL_GetTimerExpiration(IShell* po, PFNNOTIFY pfn, void* pUser, uint32* pdwMSecs)
+{
+	uint64_t qwNow = Host_ClockUs(po);
+	int i;
+
+	for(i = 0; i < po->nTimers; i++)
+	{
+		if(po->timers[i].pfn == pfn && po->timers[i].pUser == pUser)
+		{
+			if(pdwMSecs)
+			{	*pdwMSecs = po->timers[i].qwDeadlineUs > qwNow ? (uint32)((po->timers[i].qwDeadlineUs - qwNow) / 1000u) : 0;	}
+			return TRUE;
+		}
+	}
+	return FALSE;
+}
@@ -0,0 +1,138 @@
+/*===========================================================================
+
+FILE: AEE.h
+
+Host stand-in for the BREW SDK header of the same name. Only the types,
+events and key codes that Hamlet.c and its modules use are declared.
+===========================================================================*/
+#ifndef AEE_H
+#define AEE_H
+
+#include <stddef.h>
+
+typedef unsigned char		uint8;
+typedef unsigned short		uint16;
+typedef unsigned int		uint32;
+typedef signed char			int8;
+typedef signed short		int16;
+typedef signed int			int32;
+typedef unsigned char		byte;
+typedef unsigned char		boolean;
+typedef unsigned short		AECHAR;
+typedef uint32				AEECLSID;
+typedef uint16				AEEEvent;
+typedef uint32				NativeColor;
+typedef uint32				RGBVAL;
+
+#ifndef TRUE
+#define TRUE	1
+#define FALSE	0
+#endif
+
+#ifndef MAX
+#define MAX(a,b)	(((a) > (b)) ? (a) : (b))
+#define MIN(a,b)	(((a) < (b)) ? (a) : (b))
+#endif
+
+#define MAKE_RGB(r,g,b)	((RGBVAL)(((uint32)(b) << 24) | ((uint32)(g) << 16) | ((uint32)(r) << 8)))
+
+// error codes
+#define SUCCESS				0
+#define AEE_SUCCESS			0
+#define EFAILED				1
+#define ENOMEMORY			2
+#define ECLASSNOTSUPPORT	3
+#define EBADPARM			14
+#define EUNSUPPORTED		20
+
+// class ids the applet asks the shell for
+#define AEECLSID_MENUCTL	0x01001007
+#define AEECLSID_STATIC		0x01001009
+#define AEECLSID_FILEMGR	0x01001011
+#define AEECLSID_DIB		0x01013E1A
+#define AEECLSID_MEMASTREAM	0x01010010
+#define AEECLSID_PNG		0x01011C3E
+
+// events
+#define EVT_APP_START		0x0000
+#define EVT_APP_STOP		0x0001
+#define EVT_APP_SUSPEND		0x0002
+#define EVT_APP_RESUME		0x0003
+#define EVT_APP_CONFIG		0x0004
+#define EVT_APP_HIDDEN_CONFIG	0x0005
+#define EVT_APP_BROWSE_URL	0x0006
+#define EVT_APP_BROWSE_FILE	0x0007
+#define EVT_APP_MESSAGE		0x0008
+#define EVT_KEY				0x0100
+#define EVT_KEY_PRESS		0x0101
+#define EVT_KEY_RELEASE		0x0102
+#define EVT_COMMAND			0x0200
+#define EVT_USER			0x7000	// first event an applet may define for itself
+
+// virtual key codes, AEEVCodes.h
+#define AVK_FIRST			0xE020
+#define AVK_0				0xE021
+#define AVK_1				0xE022
+#define AVK_2				0xE023
+#define AVK_3				0xE024
+#define AVK_4				0xE025
+#define AVK_5				0xE026
+#define AVK_6				0xE027
+#define AVK_7				0xE028
+#define AVK_8				0xE029
+#define AVK_9				0xE02A
+#define AVK_STAR			0xE02B
+#define AVK_POUND			0xE02C
+#define AVK_POWER			0xE02D
+#define AVK_END				0xE02E
+#define AVK_SEND			0xE02F
+#define AVK_CLR				0xE030
+#define AVK_UP				0xE031
+#define AVK_DOWN			0xE032
+#define AVK_LEFT			0xE033
+#define AVK_RIGHT			0xE034
+#define AVK_SELECT			0xE035
+
+typedef struct _AEERect {
+	int16	x;
+	int16	y;
+	int16	dx;
+	int16	dy;
+} AEERect;
+
+typedef enum {
+	AEE_FONT_NORMAL = 0x8000,
+	AEE_FONT_BOLD,
+	AEE_FONT_LARGE
+} AEEFont;
+
+typedef struct _AEEDeviceInfo {
+	uint16	cxScreen;
+	uint16	cyScreen;
+	uint16	cxAltScreen;
+	uint16	cyAltScreen;
+	uint16	cxScrollBar;
+	uint16	wEncoding;
+	uint16	wMenuTextScroll;
+	uint16	nColorDepth;
+	uint16	wMenuImageDelay;
+	uint32	dwRAM;
+	uint16	wStructSize;
+} AEEDeviceInfo;
+
+typedef void (*PFNNOTIFY)(void * pData);
+
+typedef struct IShell		IShell;
+typedef struct IModule		IModule;
+typedef struct IApplet		IApplet;
+typedef struct IDisplay		IDisplay;
+typedef struct IImage		IImage;
+typedef struct IBitmap		IBitmap;
+typedef struct IMenuCtl		IMenuCtl;
+typedef struct IStatic		IStatic;
+typedef struct IFileMgr		IFileMgr;
+typedef struct IFile		IFile;
+typedef struct IAStream		IAStream;
+typedef struct IMemAStream	IMemAStream;
+
+#endif // AEE_H
@@ -0,0 +1,31 @@
+/*===========================================================================
+
+FILE: AEEAppGen.h
+
+Host stand-in for the generic applet base that AEEApplet_New builds.
+===========================================================================*/
+#ifndef AEEAPPGEN_H
+#define AEEAPPGEN_H
+
+#include "AEEShell.h"
+
+typedef boolean (*AEEHANDLER)(void* pData, AEEEvent evt, uint16 wParam, uint32 dwParam);
+typedef void (*PFNFREEAPPDATA)(void* pData);
+
+typedef struct _AEEApplet {
+	IApplet*		pvt;			// the applet handle the shell knows
+	AEECLSID		clsID;
+	uint32			m_nRefs;
+	IShell*			m_pIShell;
+	IModule*		m_pIModule;
+	IDisplay*		m_pIDisplay;
+	AEEHANDLER		pAppHandleEvent;
+	PFNFREEAPPDATA	pFreeAppData;
+} AEEApplet;
+
+boolean	AEEApplet_New(int16 nIn, AEECLSID clsID, IShell* pIShell, IModule* pIModule,
+					  IApplet** ppobj, AEEHANDLER pAppHandleEvent, PFNFREEAPPDATA pFreeAppData);
+uint32	IAPPLET_Release(IApplet* po);
+boolean	IAPPLET_HandleEvent(IApplet* po, AEEEvent evt, uint16 wParam, uint32 dwParam);
+
+#endif // AEEAPPGEN_H
@@ -0,0 +1,45 @@
+/*===========================================================================
+
+FILE: AEEBitmap.h
+
+Host stand-in for IBitmap and the IDIB view of a bitmap's pixels.
+Every host bitmap is a DIB, so IBITMAP_QueryInterface(AEECLSID_DIB)
+always succeeds.
+===========================================================================*/
+#ifndef AEEBITMAP_H
+#define AEEBITMAP_H
+
+#include "AEE.h"
+#include "AEEImage.h"
+
+#define IDIB_COLORSCHEME_NONE	0
+#define IDIB_COLORSCHEME_332	8
+#define IDIB_COLORSCHEME_565	16
+#define IDIB_COLORSCHEME_888	24
+
+typedef struct IDIB {
+	void*		pvt;			// unused on the host, keeps the SDK layout
+	void*		pPaletteMap;
+	byte*		pBmp;			// top row first
+	uint32*		pRGB;			// palette for indexed formats
+	NativeColor	ncTransparent;
+	uint16		cx;
+	uint16		cy;
+	int16		nPitch;			// bytes per row
+	uint16		cntRGB;
+	uint8		nDepth;			// bits per pixel
+	uint8		nColorScheme;	// IDIB_COLORSCHEME_*
+} IDIB;
+
+uint32		IBITMAP_AddRef(IBitmap* po);
+uint32		IBITMAP_Release(IBitmap* po);
+int			IBITMAP_QueryInterface(IBitmap* po, AEECLSID cls, void** ppo);
+int			IBITMAP_CreateCompatibleBitmap(IBitmap* po, IBitmap** ppIBitmap, uint16 w, uint16 h);
+int			IBITMAP_BltIn(IBitmap* po, int xDst, int yDst, int dx, int dy, IBitmap* pSrc, int xSrc, int ySrc, AEERasterOp rop);
+NativeColor	IBITMAP_RGBToNative(IBitmap* po, RGBVAL rgb);
+int			IBITMAP_Invalidate(IBitmap* po, const AEERect* prc);
+
+#define IDIB_Release(p)		IBITMAP_Release((IBitmap*)(p))
+#define IDIB_TO_IBITMAP(p)	((IBitmap*)(p))
+
+#endif // AEEBITMAP_H
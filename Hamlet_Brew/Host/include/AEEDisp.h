@@ -0,0 +1,37 @@
+/*===========================================================================
+
+FILE: AEEDisp.h
+
+Host stand-in for the IDisplay interface.
+===========================================================================*/
+#ifndef AEEDISP_H
+#define AEEDISP_H
+
+#include "AEE.h"
+#include "AEEImage.h"
+
+#define IDF_ALIGN_NONE		0x00000000
+#define IDF_RECT_FILL		0x00000040
+#define IDF_TEXT_TRANSPARENT	0x00008000	// the host never fills behind text anyway
+
+void	IDISPLAY_ClearScreen(IDisplay* po);
+void	IDISPLAY_Update(IDisplay* po);
+void	IDISPLAY_UpdateEx(IDisplay* po, boolean bDefer);
+void	IDISPLAY_FillRect(IDisplay* po, const AEERect* prc, RGBVAL clr);
+void	IDISPLAY_EraseRect(IDisplay* po, const AEERect* prc);
+void	IDISPLAY_SetClipRect(IDisplay* po, const AEERect* prc);
+void	IDISPLAY_GetClipRect(IDisplay* po, AEERect* prc);
+int		IDISPLAY_DrawText(IDisplay* po, AEEFont nFont, const AECHAR* pcText, int nChars,
+						  int x, int y, const AEERect* prcBackground, uint32 dwFlags);
+int		IDISPLAY_MeasureTextEx(IDisplay* po, AEEFont nFont, const AECHAR* pcText, int nChars,
+							   int nMaxWidth, int* pnFits);
+int		IDISPLAY_GetFontMetrics(IDisplay* po, AEEFont nFont, int* pnAscent, int* pnDescent);
+void	IDISPLAY_BitBlt(IDisplay* po, int xDest, int yDest, int cxDest, int cyDest,
+						const void* pbmSource, int xSrc, int ySrc, AEERasterOp dwRopCode);
+int		IDISPLAY_GetDeviceBitmap(IDisplay* po, IBitmap** ppIBitmap);
+int		IDISPLAY_SetDestination(IDisplay* po, IBitmap* pDest);
+int		IDISPLAY_GetDestination(IDisplay* po, IBitmap** ppDest);
+
+#define IDISPLAY_MeasureText(p, f, s)	IDISPLAY_MeasureTextEx((p), (f), (s), -1, -1, NULL)
+
+#endif // AEEDISP_H
@@ -0,0 +1,49 @@
+/*===========================================================================
+
+FILE: AEEFile.h
+
+Host stand-in for IFileMgr and IFile, backed by the host file system
+under the applet's working directory.
+===========================================================================*/
+#ifndef AEEFILE_H
+#define AEEFILE_H
+
+#include "AEEShell.h"
+
+typedef enum {
+	_OFM_READ		= 0x0001,
+	_OFM_READWRITE	= 0x0002,
+	_OFM_CREATE		= 0x0004,
+	_OFM_APPEND		= 0x0008
+} OpenFileMode;
+
+typedef enum {
+	_SEEK_START,
+	_SEEK_END,
+	_SEEK_CURRENT
+} FileSeekType;
+
+#define AEE_FMAP_PROT_READ	0x0001
+#define AEE_FMAP_SHARED		0x0001
+
+typedef struct _FileInfo {
+	char	attrib;
+	uint32	dwCreationDate;
+	uint32	dwSize;
+	char	szName[64];
+} FileInfo;
+
+uint32	IFILEMGR_Release(IFileMgr* po);
+IFile*	IFILEMGR_OpenFile(IFileMgr* po, const char* pszFile, OpenFileMode mode);
+int		IFILEMGR_Remove(IFileMgr* po, const char* pszName);
+int		IFILEMGR_Test(IFileMgr* po, const char* pszName);
+
+uint32	IFILE_Release(IFile* po);
+int32	IFILE_Read(IFile* po, void* pDest, uint32 nWant);
+uint32	IFILE_Write(IFile* po, const void* pBuffer, uint32 dwCount);
+int		IFILE_Seek(IFile* po, FileSeekType seek, int32 position);
+int		IFILE_Truncate(IFile* po, uint32 truncate_pos);
+int		IFILE_GetInfo(IFile* po, FileInfo* pInfo);
+void*	IFILE_Map(IFile* po, void* pStart, uint32 dwSize, int protections, int flags, uint32 dwOffset);
+
+#endif // AEEFILE_H
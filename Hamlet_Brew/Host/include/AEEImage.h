@@ -0,0 +1,59 @@
+/*===========================================================================
+
+FILE: AEEImage.h
+
+Host stand-in for the IImage interface.
+
+IIMAGE_SetStream decodes the whole stream before it returns, unless
+IIMAGE_Notify was called first. Then it returns at once and the image
+decodes in the background, the way a handset's decoder does, and the
+callback runs once the last row is in.
+===========================================================================*/
+#ifndef AEEIMAGE_H
+#define AEEIMAGE_H
+
+#include "AEE.h"
+
+typedef enum {
+	AEE_RO_OR,
+	AEE_RO_XOR,
+	AEE_RO_COPY,
+	AEE_RO_NOT,
+	AEE_RO_TRANSPARENT,
+	AEE_RO_MASK,
+	AEE_RO_TOTAL
+} AEERasterOp;
+
+#define IPARM_SIZE		1
+#define IPARM_OFFSET	2
+#define IPARM_CXFRAME	3
+#define IPARM_NFRAMES	4
+#define IPARM_RATE		5
+#define IPARM_ROP		6
+#define IPARM_SCALE		8
+
+typedef struct _AEEImageInfo {
+	uint16	cx;
+	uint16	cy;
+	uint16	nColors;
+	boolean	bAnimated;
+	uint16	cxFrame;
+} AEEImageInfo;
+
+typedef void (*PFNIMAGEINFO)(void* pUser, IImage* pImage, AEEImageInfo* pi, int nErr);
+
+uint32	IIMAGE_AddRef(IImage* po);
+uint32	IIMAGE_Release(IImage* po);
+void	IIMAGE_GetInfo(IImage* po, AEEImageInfo* pi);
+void	IIMAGE_SetParm(IImage* po, int nParm, int n1, int n2);
+void	IIMAGE_Draw(IImage* po, int x, int y);
+void	IIMAGE_DrawFrame(IImage* po, int nFrame, int x, int y);
+void	IIMAGE_SetStream(IImage* po, IAStream* pStream);	// decodes before it returns on the host, see above
+void	IIMAGE_Notify(IImage* po, PFNIMAGEINFO pfn, void* pUser);
+
+#define IIMAGE_SetFrameCount(p, n)		IIMAGE_SetParm((p), IPARM_NFRAMES, (n), 0)
+#define IIMAGE_SetFrameSize(p, cx)		IIMAGE_SetParm((p), IPARM_CXFRAME, (cx), 0)
+#define IIMAGE_SetOffset(p, x, y)		IIMAGE_SetParm((p), IPARM_OFFSET, (x), (y))
+#define IIMAGE_SetDrawSize(p, cx, cy)	IIMAGE_SetParm((p), IPARM_SIZE, (cx), (cy))
+
+#endif // AEEIMAGE_H
@@ -0,0 +1,20 @@
+/*===========================================================================
+
+FILE: AEEMemAStream.h
+
+Host stand-in for IMemAStream, a read stream over a block of memory.
+With IMEMASTREAM_SetEx the caller keeps ownership of the block and
+pfnFree (which may be NULL) runs when the stream lets go of it.
+===========================================================================*/
+#ifndef AEEMEMASTREAM_H
+#define AEEMEMASTREAM_H
+
+#include "AEE.h"
+
+uint32	IMEMASTREAM_AddRef(IMemAStream* po);
+uint32	IMEMASTREAM_Release(IMemAStream* po);
+void	IMEMASTREAM_Set(IMemAStream* po, byte* pBuff, uint32 dwSize, uint32 dwOffset, boolean bSysMem);
+void	IMEMASTREAM_SetEx(IMemAStream* po, byte* pBuff, uint32 dwSize, uint32 dwOffset,
+						  PFNNOTIFY pfnFree, void* pUser);
+
+#endif // AEEMEMASTREAM_H
@@ -0,0 +1,27 @@
+/*===========================================================================
+
+FILE: AEEMenu.h
+
+Host stand-in for the IMenuCtl interface.
+===========================================================================*/
+#ifndef AEEMENU_H
+#define AEEMENU_H
+
+#include "AEEShell.h"
+
+uint32	IMENUCTL_Release(IMenuCtl* po);
+boolean	IMENUCTL_HandleEvent(IMenuCtl* po, AEEEvent evt, uint16 wParam, uint32 dwParam);
+boolean	IMENUCTL_Redraw(IMenuCtl* po);
+void	IMENUCTL_SetActive(IMenuCtl* po, boolean bActive);
+boolean	IMENUCTL_IsActive(IMenuCtl* po);
+void	IMENUCTL_SetRect(IMenuCtl* po, const AEERect* prc);
+void	IMENUCTL_GetRect(IMenuCtl* po, AEERect* prc);
+boolean	IMENUCTL_SetTitle(IMenuCtl* po, const char* pszResFile, uint16 wResID, AECHAR* pText);
+boolean	IMENUCTL_AddItem(IMenuCtl* po, const char* pszResFile, uint16 wResID, uint16 nItemID,
+						 AECHAR* pText, uint32 lData);
+boolean	IMENUCTL_DeleteAll(IMenuCtl* po);
+uint16	IMENUCTL_GetSel(IMenuCtl* po);
+void	IMENUCTL_SetSel(IMenuCtl* po, uint16 nItemID);
+int		IMENUCTL_GetItemCount(IMenuCtl* po);
+
+#endif // AEEMENU_H
@@ -0,0 +1,15 @@
+/*===========================================================================
+
+FILE: AEEModGen.h
+
+Host stand-in for the generic module. The host calls AEEClsCreateInstance
+directly instead of going through a module table.
+===========================================================================*/
+#ifndef AEEMODGEN_H
+#define AEEMODGEN_H
+
+#include "AEEShell.h"
+
+int AEEClsCreateInstance(AEECLSID ClsId, IShell* pIShell, IModule* po, void** ppObj);
+
+#endif // AEEMODGEN_H
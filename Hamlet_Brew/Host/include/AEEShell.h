@@ -0,0 +1,31 @@
+/*===========================================================================
+
+FILE: AEEShell.h
+
+Host stand-in for the IShell interface: timers, resources, device info
+and class creation.
+===========================================================================*/
+#ifndef AEESHELL_H
+#define AEESHELL_H
+
+#include "AEE.h"
+#include "AEEImage.h"
+#include "AEEDisp.h"
+#include "AEEBitmap.h"
+
+#define RESTYPE_STRING	0x5001
+#define RESTYPE_IMAGE	0x5006
+
+int		ISHELL_SetTimer(IShell* po, int32 dwMSecs, PFNNOTIFY pfn, void* pUser);
+int		ISHELL_CancelTimer(IShell* po, PFNNOTIFY pfn, void* pUser);
+boolean	ISHELL_GetTimerExpiration(IShell* po, PFNNOTIFY pfn, void* pUser, uint32* pdwMSecs);
+void	ISHELL_GetDeviceInfo(IShell* po, AEEDeviceInfo* pi);
+int		ISHELL_CreateInstance(IShell* po, AEECLSID cls, void** ppobj);
+IImage*	ISHELL_LoadResImage(IShell* po, const char* pszResFile, uint16 nResID);
+int		ISHELL_LoadResString(IShell* po, const char* pszResFile, uint16 nResID, AECHAR* pBuff, int nSize);
+void*	ISHELL_LoadResData(IShell* po, const char* pszResFile, uint16 nResID, uint16 nType);
+void	ISHELL_FreeResData(IShell* po, void* pData);
+boolean	ISHELL_SendEvent(IShell* po, AEECLSID cls, AEEEvent eCode, uint16 wParam, uint32 dwParam);
+boolean	ISHELL_PostEvent(IShell* po, AEECLSID cls, AEEEvent eCode, uint16 wParam, uint32 dwParam);
+
+#endif // AEESHELL_H
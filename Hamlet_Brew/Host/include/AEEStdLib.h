@@ -0,0 +1,37 @@
+/*===========================================================================
+
+FILE: AEEStdLib.h
+
+Host stand-in: the helper-function subset used by the applet. MALLOC and
+FREE go through the host heap so allocations can be counted.
+===========================================================================*/
+#ifndef AEESTDLIB_H
+#define AEESTDLIB_H
+
+#include <string.h>
+#include "AEE.h"
+
+void*	MALLOC(uint32 dwSize);
+void*	REALLOC(void* p, uint32 dwSize);
+void	FREE(void* p);
+uint32	GETRAMFREE(uint32* pdwTotal, uint32* pdwMax);
+
+#define MEMSET(p, c, n)		memset((p), (c), (n))
+#define MEMCPY(d, s, n)		memcpy((d), (s), (n))
+#define MEMMOVE(d, s, n)	memmove((d), (s), (n))
+#define MEMCMP(a, b, n)		memcmp((a), (b), (n))
+#define STRLEN(s)			strlen(s)
+#define STRCPY(d, s)		strcpy((d), (s))
+#define STRCMP(a, b)		strcmp((a), (b))
+
+int		WSTRLEN(const AECHAR* pws);
+AECHAR*	WSTRCPY(AECHAR* pDest, const AECHAR* pSrc);
+AECHAR*	STRTOWSTR(const char* psz, AECHAR* pDest, int nSize);
+
+uint32	GETUPTIMEMS(void);
+uint32	GETTIMEMS(void);
+
+#define DBGPRINTF	Host_DbgPrintf
+void	Host_DbgPrintf(const char* pszFormat, ...);
+
+#endif // AEESTDLIB_H
@@ -0,0 +1,18 @@
+/*===========================================================================
+
+FILE: AEEText.h
+
+Host stand-in for the IStatic text control.
+===========================================================================*/
+#ifndef AEETEXT_H
+#define AEETEXT_H
+
+#include "AEEShell.h"
+
+uint32	ISTATIC_Release(IStatic* po);
+boolean	ISTATIC_Redraw(IStatic* po);
+void	ISTATIC_SetRect(IStatic* po, const AEERect* prc);
+void	ISTATIC_GetRect(IStatic* po, AEERect* prc);
+boolean	ISTATIC_SetText(IStatic* po, AECHAR* pTitle, AECHAR* pText, AEEFont fntTitle, AEEFont fntText);
+
+#endif // AEETEXT_H